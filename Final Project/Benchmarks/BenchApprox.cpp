@@ -0,0 +1,148 @@
+/*
+* BenchApprox.cpp
+*
+* Benchmarks of the fast approximations in MathMisc (SinCosApprox, ExpApprox,
+*   Atan2Approx and SinCosSequence) against the C library functions.
+*   The errors are measured against the double precision functions.
+*/
+
+#include "Benchmarks.h"
+#include "MathMisc.h"
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    const int NumValues = 1 << 22;
+
+    void SetRandom(std::vector<float>* values, float scale)
+    {
+        for (float& x : *values) {
+            x = scale * (float)BenchRandom();
+        }
+    }
+
+    double SinCosError(const std::vector<float>& x, const std::vector<float>& sinx, const std::vector<float>& cosx)
+    {
+        double maxError = 0.0;
+        for (size_t i = 0; i < x.size(); i++) {
+            maxError = std::max(maxError, std::max(fabs(sinx[i] - sin((double)x[i])), fabs(cosx[i] - cos((double)x[i]))));
+        }
+        return maxError;
+    }
+
+    double ExpError(const std::vector<float>& x, const std::vector<float>& y)     // Relative error
+    {
+        double maxError = 0.0;
+        for (size_t i = 0; i < x.size(); i++) {
+            double exact = exp((double)x[i]);
+            maxError = std::max(maxError, fabs(y[i] - exact) / exact);
+        }
+        return maxError;
+    }
+
+    double Atan2Error(const std::vector<float>& y, const std::vector<float>& x, const std::vector<float>& angles)
+    {
+        double maxError = 0.0;
+        for (size_t i = 0; i < x.size(); i++) {
+            maxError = std::max(maxError, fabs(angles[i] - atan2((double)y[i], (double)x[i])));
+        }
+        return maxError;
+    }
+
+    void PrintResult(const char* name, double ms, double msLibrary, const char* errorName, double maxError)
+    {
+        printf("%-32s %7.2f ms  (libm %7.2f ms, %5.2fx)  %s %.1e\n",
+               name, ms, msLibrary, msLibrary / ms, errorName, maxError);
+    }
+}
+
+void BenchApprox()
+{
+    std::vector<float> x(NumValues), y(NumValues), sinx(NumValues), cosx(NumValues);
+    printf("%d values", NumValues);
+#ifdef USE_SSE2
+    printf(", with SSE2\n");
+#else
+    printf(", without SSE2\n");
+#endif
+
+    // sin and cos, for |x| <= 100
+    SetRandom(&x, 100.0f);
+    double msLibrary = BenchTimeMs([&]() {
+        for (int i = 0; i < NumValues; i++) {
+            sinx[i] = sinf(x[i]);
+            cosx[i] = cosf(x[i]);
+        }
+    });
+    double ms = BenchTimeMs([&]() { SinCosApprox(x.data(), sinx.data(), cosx.data(), NumValues); });
+    PrintResult("SinCosApprox (array)", ms, msLibrary, "max abs error", SinCosError(x, sinx, cosx));
+    ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumValues; i++) {
+            SinCosApprox(x[i], &sinx[i], &cosx[i]);
+        }
+    });
+    PrintResult("SinCosApprox (scalar)", ms, msLibrary, "max abs error", SinCosError(x, sinx, cosx));
+
+    // exp, for |x| <= 80
+    SetRandom(&x, 80.0f);
+    msLibrary = BenchTimeMs([&]() {
+        for (int i = 0; i < NumValues; i++) {
+            y[i] = expf(x[i]);
+        }
+    });
+    ms = BenchTimeMs([&]() { ExpApprox(x.data(), y.data(), NumValues); });
+    PrintResult("ExpApprox (array)", ms, msLibrary, "max rel error", ExpError(x, y));
+    ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumValues; i++) {
+            y[i] = ExpApprox(x[i]);
+        }
+    });
+    PrintResult("ExpApprox (scalar)", ms, msLibrary, "max rel error", ExpError(x, y));
+
+    // atan2, for x and y in [-1,1]
+    SetRandom(&x, 1.0f);
+    SetRandom(&y, 1.0f);
+    std::vector<float> angles(NumValues);
+    msLibrary = BenchTimeMs([&]() {
+        for (int i = 0; i < NumValues; i++) {
+            angles[i] = atan2f(y[i], x[i]);
+        }
+    });
+    ms = BenchTimeMs([&]() { Atan2Approx(y.data(), x.data(), angles.data(), NumValues); });
+    PrintResult("Atan2Approx (array)", ms, msLibrary, "max abs error", Atan2Error(y, x, angles));
+    ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumValues; i++) {
+            angles[i] = Atan2Approx(y[i], x[i]);
+        }
+    });
+    PrintResult("Atan2Approx (scalar)", ms, msLibrary, "max abs error", Atan2Error(y, x, angles));
+
+    // Evenly spaced angles, as in the mesh generators' tables.  The baseline calls the
+    //    double precision sin and cos, as the mesh generators did before.
+    const double start = 0.1;
+    const double delta = 2.0 * PI / 1000.0;
+    msLibrary = BenchTimeMs([&]() {
+        for (int i = 0; i < NumValues; i++) {
+            sinx[i] = (float)sin(start + i * delta);
+            cosx[i] = (float)cos(start + i * delta);
+        }
+    });
+    ms = BenchTimeMs([&]() { SinCosSequence(start, delta, NumValues, sinx.data(), cosx.data()); });
+    double maxError = 0.0;
+    for (int i = 0; i < NumValues; i++) {
+        double theta = start + i * delta;
+        maxError = std::max(maxError, std::max(fabs(sinx[i] - sin(theta)), fabs(cosx[i] - cos(theta))));
+    }
+    PrintResult("SinCosSequence (float)", ms, msLibrary, "max abs error", maxError);
+    std::vector<double> sinxDouble(NumValues), cosxDouble(NumValues);
+    ms = BenchTimeMs([&]() { SinCosSequence(start, delta, NumValues, sinxDouble.data(), cosxDouble.data()); });
+    maxError = 0.0;
+    for (int i = 0; i < NumValues; i++) {
+        double theta = start + i * delta;
+        maxError = std::max(maxError, std::max(fabs(sinxDouble[i] - sin(theta)), fabs(cosxDouble[i] - cos(theta))));
+    }
+    PrintResult("SinCosSequence (double)", ms, msLibrary, "max abs error", maxError);
+    BenchSink += sinx[0] + cosx[0] + y[0] + angles[0] + sinxDouble[0];
+}
@@ -0,0 +1,211 @@
+/*
+* BenchBmp.cpp
+*
+* Benchmarks of reading and writing BMP files: RgbImage::LoadBmpFile and
+*   WriteBmpFile, which read and write whole rows, against the earlier versions
+*   that read and wrote one byte at a time with fgetc and fputc (kept here as the
+*   baseline), and BmpFileView, which maps the file.  The file is written to the
+*   current directory and removed afterwards; the reads are from the file cache.
+*/
+
+// This tells the Visual C++ compiler to allow use of fopen, etc.  (As in RgbImage.cpp.)
+#define _CRT_SECURE_NO_DEPRECATE 1
+
+#include "Benchmarks.h"
+#include "BmpFileView.h"
+#include "RgbImage.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+    const int NumRows = 4096;
+    const int NumCols = 4096;
+    const char* const TempFilename = "BenchmarksTemp.bmp";
+    const char* const TempFilenameBaseline = "BenchmarksTempBaseline.bmp";
+
+    long BytesPerRow(long numCols) { return ((3 * numCols + 3) >> 2) << 2; }
+
+    long ReadLong(FILE* infile)
+    {
+        long ret = 0;
+        for (int i = 0; i < 4; i++) {
+            ret |= (long)(unsigned char)fgetc(infile) << (8 * i);
+        }
+        return ret;
+    }
+
+    void WriteLong(long data, FILE* outfile)
+    {
+        for (int i = 0; i < 4; i++) {
+            fputc((data >> (8 * i)) & 0xff, outfile);
+        }
+    }
+
+    void WriteShort(short data, FILE* outfile)
+    {
+        fputc(data & 0xff, outfile);
+        fputc((data >> 8) & 0xff, outfile);
+    }
+
+    // The baseline loader: the earlier RgbImage::LoadBmpFile, which reads with fgetc.
+    //    Only the checks needed for the benchmark's own file are kept.
+    bool LoadBmpFileBaseline(const char* filename, std::vector<unsigned char>* pixels, long* numRows, long* numCols)
+    {
+        FILE* infile = fopen(filename, "rb");
+        if (!infile) {
+            return false;
+        }
+        bool fileFormatOK = false;
+        if (fgetc(infile) == 'B' && fgetc(infile) == 'M') {
+            for (int i = 0; i < 8; i++) {
+                fgetc(infile);                      // File size and two reserved fields
+            }
+            long offset = ReadLong(infile);
+            ReadLong(infile);                       // Header size
+            *numCols = ReadLong(infile);
+            *numRows = ReadLong(infile);
+            fgetc(infile);                          // Number of color planes
+            fgetc(infile);
+            int bitsPerPixel = fgetc(infile);
+            bitsPerPixel |= fgetc(infile) << 8;
+            for (long i = 30; i < offset; i++) {
+                fgetc(infile);
+            }
+            fileFormatOK = *numRows > 0 && *numCols > 0 && bitsPerPixel == 24 && !feof(infile);
+        }
+        if (!fileFormatOK) {
+            fclose(infile);
+            return false;
+        }
+        long rowLength = BytesPerRow(*numCols);
+        pixels->resize((size_t)*numRows * rowLength);
+        unsigned char* cPtr = pixels->data();
+        for (long i = 0; i < *numRows; i++) {
+            for (long j = 0; j < *numCols; j++) {
+                *(cPtr + 2) = (unsigned char)fgetc(infile);     // Blue color value
+                *(cPtr + 1) = (unsigned char)fgetc(infile);     // Green color value
+                *cPtr = (unsigned char)fgetc(infile);           // Red color value
+                cPtr += 3;
+            }
+            for (long k = 3 * *numCols; k < rowLength; k++) {
+                fgetc(infile);                      // Read and ignore padding
+                *(cPtr++) = 0;
+            }
+        }
+        bool readOK = !feof(infile);
+        fclose(infile);
+        return readOK;
+    }
+
+    // The baseline writer: the earlier RgbImage::WriteBmpFile, which writes with fputc.
+    bool WriteBmpFileBaseline(const char* filename, const unsigned char* pixels, long numRows, long numCols)
+    {
+        FILE* outfile = fopen(filename, "wb");
+        if (!outfile) {
+            return false;
+        }
+        long rowLength = BytesPerRow(numCols);
+        fputc('B', outfile);
+        fputc('M', outfile);
+        WriteLong(40 + 14 + numRows * rowLength, outfile);     // Length of file
+        WriteShort(0, outfile);                     // Reserved
+        WriteShort(0, outfile);
+        WriteLong(40 + 14, outfile);                // Offset to pixel data
+        WriteLong(40, outfile);                     // Header length
+        WriteLong(numCols, outfile);
+        WriteLong(numRows, outfile);
+        WriteShort(1, outfile);                     // Number of planes
+        WriteShort(24, outfile);                    // Bits per pixel
+        for (int i = 0; i < 6; i++) {
+            WriteLong(0, outfile);                  // No compression, and unused fields
+        }
+        const unsigned char* cPtr = pixels;
+        for (long i = 0; i < numRows; i++) {
+            for (long j = 0; j < numCols; j++) {
+                fputc(*(cPtr + 2), outfile);        // Blue color value
+                fputc(*(cPtr + 1), outfile);        // Green color value
+                fputc(*cPtr, outfile);              // Red color value
+                cPtr += 3;
+            }
+            for (long k = 3 * numCols; k < rowLength; k++) {
+                fputc(0, outfile);                  // Padding
+                cPtr++;
+            }
+        }
+        return fclose(outfile) == 0;
+    }
+
+    bool SameFileContents(const char* filename1, const char* filename2)
+    {
+        FILE* file1 = fopen(filename1, "rb");
+        FILE* file2 = fopen(filename2, "rb");
+        bool same = (file1 != 0 && file2 != 0);
+        int c1 = 0, c2 = 0;
+        while (same && c1 != EOF) {
+            c1 = fgetc(file1);
+            c2 = fgetc(file2);
+            same = (c1 == c2);
+        }
+        if (file1) {
+            fclose(file1);
+        }
+        if (file2) {
+            fclose(file2);
+        }
+        return same;
+    }
+}
+
+void BenchBmp()
+{
+    RgbImage image(NumRows, NumCols);
+    for (long i = 0; i < NumRows; i++) {
+        unsigned char* row = image.GetRgbPixel(i, 0);
+        for (long j = 0; j < 3 * NumCols; j++) {
+            row[j] = (unsigned char)(256.0 * (0.5 + 0.5 * BenchRandom()));
+        }
+    }
+    const unsigned char* pixels = (const unsigned char*)image.ImageData();
+    size_t imageSize = (size_t)NumRows * image.GetNumBytesPerRow();
+    printf("%d x %d image, %.1f MB\n", NumRows, NumCols, imageSize / 1.0e6);
+
+    bool writeOK = true;
+    double msBaseline = BenchTimeMs([&]() {
+        writeOK = WriteBmpFileBaseline(TempFilenameBaseline, pixels, NumRows, NumCols) && writeOK;
+    }, 3);
+    double ms = BenchTimeMs([&]() { writeOK = image.WriteBmpFile(TempFilename) && writeOK; }, 3);
+    if (!writeOK) {
+        fprintf(stderr, "Unable to write %s in the current directory.\n", TempFilename);
+        remove(TempFilename);
+        remove(TempFilenameBaseline);
+        return;
+    }
+    printf("RgbImage::WriteBmpFile   %8.2f ms  (baseline %8.2f ms, %5.2fx)  files identical: %s\n",
+           ms, msBaseline, msBaseline / ms, SameFileContents(TempFilename, TempFilenameBaseline) ? "yes" : "NO");
+
+    std::vector<unsigned char> baselinePixels;
+    long baselineRows = 0, baselineCols = 0;
+    bool readOK = true;
+    msBaseline = BenchTimeMs([&]() {
+        readOK = LoadBmpFileBaseline(TempFilename, &baselinePixels, &baselineRows, &baselineCols) && readOK;
+    }, 3);
+    RgbImage loaded;
+    ms = BenchTimeMs([&]() { readOK = loaded.LoadBmpFile(TempFilename) && readOK; }, 3);
+    bool same = readOK && loaded.GetNumRows() == NumRows && loaded.GetNumCols() == NumCols
+        && memcmp(loaded.ImageData(), pixels, imageSize) == 0
+        && baselinePixels.size() == imageSize && memcmp(baselinePixels.data(), pixels, imageSize) == 0;
+    printf("RgbImage::LoadBmpFile    %8.2f ms  (baseline %8.2f ms, %5.2fx)  pixels match: %s\n",
+           ms, msBaseline, msBaseline / ms, same ? "yes" : "NO");
+
+    // Mapping the file, and touching each page: the pixels stay BGR, for glTexImage2D with GL_BGR.
+    ms = BenchTimeMs([&]() {
+        BmpFileView view(TempFilename);
+        view.Prefault();
+        BenchSink += view.IsOpen() ? view.PixelData()[0] : 0;
+    }, 3);
+    printf("BmpFileView (mapped)     %8.2f ms  (baseline %8.2f ms, %5.2fx)\n", ms, msBaseline, msBaseline / ms);
+
+    remove(TempFilename);
+    remove(TempFilenameBaseline);
+}
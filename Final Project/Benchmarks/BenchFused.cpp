@@ -0,0 +1,129 @@
+/*
+* BenchFused.cpp
+*
+* Benchmarks of the fused VectorR3 operations (SetTriangleNormal,
+*   SetLinearCombination, AddScaled, ...) against the same expressions
+*   written with the VectorR3 operators, which create temporaries.
+*   An optimizing compiler removes most of the temporaries, so the
+*   difference is largest in the Debug configuration.
+*/
+
+#include "Benchmarks.h"
+#include "LinearR3.h"
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    const int NumVectors = 1 << 22;
+
+    void SetRandom(std::vector<VectorR3>* v)
+    {
+        for (VectorR3& u : *v) {
+            u.Set(BenchRandom(), BenchRandom(), BenchRandom());
+        }
+    }
+
+    // The largest difference between the two arrays: the fused and operator results should agree.
+    double MaxDifference(const std::vector<VectorR3>& u, const std::vector<VectorR3>& v)
+    {
+        double maxDiff = 0.0;
+        for (size_t i = 0; i < u.size(); i++) {
+            maxDiff = std::max(maxDiff, fabs(u[i].x - v[i].x) + fabs(u[i].y - v[i].y) + fabs(u[i].z - v[i].z));
+        }
+        return maxDiff;
+    }
+
+    void PrintResult(const char* name, double ms, double msOperators, double maxDiff)
+    {
+        printf("%-38s %7.2f ms  (operators %7.2f ms, %4.2fx)  max difference %.1e\n",
+               name, ms, msOperators, msOperators / ms, maxDiff);
+    }
+}
+
+void BenchFused()
+{
+    std::vector<VectorR3> p0(NumVectors), p1(NumVectors), p2(NumVectors);
+    SetRandom(&p0);
+    SetRandom(&p1);
+    SetRandom(&p2);
+    std::vector<VectorR3> result(NumVectors), resultOperators(NumVectors);
+    printf("%d vectors\n", NumVectors);
+
+    // Triangle normals
+    double msOperators = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            resultOperators[i] = (p1[i] - p0[i]) * (p2[i] - p0[i]);
+        }
+    });
+    double ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            result[i].SetTriangleNormal(p0[i], p1[i], p2[i]);
+        }
+    });
+    PrintResult("VectorR3::SetTriangleNormal", ms, msOperators, MaxDifference(result, resultOperators));
+
+    // Cross products
+    msOperators = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            resultOperators[i] = p0[i] * p1[i];
+        }
+    });
+    ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            result[i].SetCrossProduct(p0[i], p1[i]);
+        }
+    });
+    PrintResult("VectorR3::SetCrossProduct", ms, msOperators, MaxDifference(result, resultOperators));
+
+    // Linear combinations, one at a time and as arrays
+    msOperators = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            resultOperators[i] = 0.3 * p0[i] + 0.7 * p1[i];
+        }
+    });
+    ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            result[i].SetLinearCombination(0.3, p0[i], 0.7, p1[i]);
+        }
+    });
+    PrintResult("VectorR3::SetLinearCombination", ms, msOperators, MaxDifference(result, resultOperators));
+    ms = BenchTimeMs([&]() { LinearCombination(result.data(), 0.3, p0.data(), 0.7, p1.data(), NumVectors); });
+    PrintResult("LinearCombination (array)", ms, msOperators, MaxDifference(result, resultOperators));
+
+    msOperators = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            resultOperators[i] = 0.2 * p0[i] + 0.3 * p1[i] + 0.5 * p2[i];
+        }
+    });
+    ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            result[i].SetLinearCombination(0.2, p0[i], 0.3, p1[i], 0.5, p2[i]);
+        }
+    });
+    PrintResult("SetLinearCombination (three terms)", ms, msOperators, MaxDifference(result, resultOperators));
+
+    // u + s*v
+    msOperators = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            resultOperators[i] = p0[i] + 0.25 * p1[i];
+        }
+    });
+    ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            result[i].SetAddScaled(p0[i], p1[i], 0.25);
+        }
+    });
+    PrintResult("VectorR3::SetAddScaled", ms, msOperators, MaxDifference(result, resultOperators));
+
+    // dest += s*u, in place.  Each timed run adds to the array again, so the results are not compared.
+    msOperators = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVectors; i++) {
+            resultOperators[i] += 1.0e-3 * p1[i];
+        }
+    });
+    ms = BenchTimeMs([&]() { AddScaled(result.data(), p1.data(), 1.0e-3, NumVectors); });
+    BenchSink += result[0].x + resultOperators[0].x;
+    printf("%-38s %7.2f ms  (operators %7.2f ms, %4.2fx)\n", "AddScaled (array)", ms, msOperators, msOperators / ms);
+}
@@ -0,0 +1,393 @@
+/*
+* BenchLinear.cpp
+*
+* Benchmarks of LinearR3 and LinearR4: time per call, and the error against
+*   the same calculation done in long double.  The inputs are random, with
+*   entries in [-1,1], so some of the 4x4 matrices are ill-conditioned.
+*/
+
+#include "Benchmarks.h"
+#include "LinearR3.h"
+#include "LinearR4.h"
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    const int NumInputs = 1000;
+    const long NumCalls = 2000000;
+
+    typedef long double Real;
+
+    // The entries of A, with a[i][j] in row i and column j.
+    void GetEntries(const Matrix4x4& A, Real a[4][4])
+    {
+        const double* column = &A.m11;          // Column-major order
+        for (int j = 0; j < 4; j++) {
+            for (int i = 0; i < 4; i++) {
+                a[i][j] = column[4 * j + i];
+            }
+        }
+    }
+
+    void GetEntries(const Matrix3x3& A, Real a[3][3])
+    {
+        const double* column = &A.m11;
+        for (int j = 0; j < 3; j++) {
+            for (int i = 0; i < 3; i++) {
+                a[i][j] = column[3 * j + i];
+            }
+        }
+    }
+
+    Real Determinant3(Real a[3][3])
+    {
+        return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+            - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+            + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    }
+
+    // Expansion along the first row
+    Real Determinant4(Real a[4][4])
+    {
+        Real det = 0;
+        for (int j = 0; j < 4; j++) {
+            Real minor[3][3];
+            for (int i = 1; i < 4; i++) {
+                for (int k = 0, col = 0; k < 4; k++) {
+                    if (k != j) {
+                        minor[i - 1][col++] = a[i][k];
+                    }
+                }
+            }
+            det += ((j & 1) ? -a[0][j] : a[0][j]) * Determinant3(minor);
+        }
+        return det;
+    }
+
+    // The largest entry of |A*B - C|
+    Real MaxProductError(const Matrix4x4& A, const Matrix4x4& B, const Matrix4x4& C)
+    {
+        Real a[4][4], b[4][4], c[4][4];
+        GetEntries(A, a);
+        GetEntries(B, b);
+        GetEntries(C, c);
+        Real maxError = 0;
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++) {
+                Real sum = 0;
+                for (int k = 0; k < 4; k++) {
+                    sum += a[i][k] * b[k][j];
+                }
+                maxError = std::max(maxError, fabsl(sum - c[i][j]));
+            }
+        }
+        return maxError;
+    }
+
+    // The largest entry of |Q^T*Q - I|: how far Q is from orthonormal.
+    Real OrthonormalError(const Matrix3x3& Q)
+    {
+        Real q[3][3];
+        GetEntries(Q, q);
+        Real maxError = 0;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                Real dot = q[0][i] * q[0][j] + q[1][i] * q[1][j] + q[2][i] * q[2][j];
+                maxError = std::max(maxError, fabsl(dot - (i == j ? 1 : 0)));
+            }
+        }
+        return maxError;
+    }
+
+    // The largest entry of |A*B - I|, for 3x3 matrices
+    Real InverseError(const LinearMapR3& A, const LinearMapR3& B)
+    {
+        Real a[3][3], b[3][3];
+        GetEntries(A, a);
+        GetEntries(B, b);
+        Real maxError = 0;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                Real sum = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+                maxError = std::max(maxError, fabsl(sum - (i == j ? 1 : 0)));
+            }
+        }
+        return maxError;
+    }
+
+    // The baseline for operator*=: the version before B was copied to locals.
+    //    It reads B after storing into A, so it is only correct when B is not A.
+    void TimesEqualsBaseline(Matrix4x4& A, const Matrix4x4& B)
+    {
+        double t1, t2, t3;
+        t1 = A.m11*B.m11 + A.m12*B.m21 + A.m13*B.m31 + A.m14*B.m41;
+        t2 = A.m11*B.m12 + A.m12*B.m22 + A.m13*B.m32 + A.m14*B.m42;
+        t3 = A.m11*B.m13 + A.m12*B.m23 + A.m13*B.m33 + A.m14*B.m43;
+        A.m14 = A.m11*B.m14 + A.m12*B.m24 + A.m13*B.m34 + A.m14*B.m44;
+        A.m11 = t1;
+        A.m12 = t2;
+        A.m13 = t3;
+
+        t1 = A.m21*B.m11 + A.m22*B.m21 + A.m23*B.m31 + A.m24*B.m41;
+        t2 = A.m21*B.m12 + A.m22*B.m22 + A.m23*B.m32 + A.m24*B.m42;
+        t3 = A.m21*B.m13 + A.m22*B.m23 + A.m23*B.m33 + A.m24*B.m43;
+        A.m24 = A.m21*B.m14 + A.m22*B.m24 + A.m23*B.m34 + A.m24*B.m44;
+        A.m21 = t1;
+        A.m22 = t2;
+        A.m23 = t3;
+
+        t1 = A.m31*B.m11 + A.m32*B.m21 + A.m33*B.m31 + A.m34*B.m41;
+        t2 = A.m31*B.m12 + A.m32*B.m22 + A.m33*B.m32 + A.m34*B.m42;
+        t3 = A.m31*B.m13 + A.m32*B.m23 + A.m33*B.m33 + A.m34*B.m43;
+        A.m34 = A.m31*B.m14 + A.m32*B.m24 + A.m33*B.m34 + A.m34*B.m44;
+        A.m31 = t1;
+        A.m32 = t2;
+        A.m33 = t3;
+
+        t1 = A.m41*B.m11 + A.m42*B.m21 + A.m43*B.m31 + A.m44*B.m41;
+        t2 = A.m41*B.m12 + A.m42*B.m22 + A.m43*B.m32 + A.m44*B.m42;
+        t3 = A.m41*B.m13 + A.m42*B.m23 + A.m43*B.m33 + A.m44*B.m43;
+        A.m44 = A.m41*B.m14 + A.m42*B.m24 + A.m43*B.m34 + A.m44*B.m44;
+        A.m41 = t1;
+        A.m42 = t2;
+        A.m43 = t3;
+    }
+
+    // The baseline for Set_gluLookAt: the version before the fused VectorR3 operations,
+    //    which copies and updates VectorR3's in place.
+    void SetLookAtBaseline(LinearMapR4* M, const VectorR3& eyePos, const VectorR3& lookAtPos, const VectorR3& upDir)
+    {
+        VectorR3 toDir(eyePos);
+        toDir -= lookAtPos;
+        toDir.Normalize();
+        VectorR3 upDirOrtho(upDir);
+        upDirOrtho.AddScaled(toDir, -(upDir^toDir));
+        upDirOrtho.Normalize();
+        VectorR3 rightDir(upDirOrtho);
+        rightDir *= toDir;
+        rightDir.ReNormalize();
+        M->Set(rightDir.x, upDirOrtho.x, toDir.x, 0.0,
+               rightDir.y, upDirOrtho.y, toDir.y, 0.0,
+               rightDir.z, upDirOrtho.z, toDir.z, 0.0,
+               -(eyePos^rightDir), -(eyePos^upDirOrtho), -(eyePos^toDir), 1.0);
+    }
+
+    // The largest entry of |M - LookAt|, with the LookAt matrix calculated in long double
+    Real LookAtError(const LinearMapR4& M, const VectorR3& eyePos, const VectorR3& lookAtPos, const VectorR3& upDir)
+    {
+        Real eye[3] = { eyePos.x, eyePos.y, eyePos.z };
+        Real to[3] = { eye[0] - lookAtPos.x, eye[1] - lookAtPos.y, eye[2] - lookAtPos.z };
+        Real norm = sqrtl(to[0] * to[0] + to[1] * to[1] + to[2] * to[2]);
+        Real up[3] = { upDir.x, upDir.y, upDir.z };
+        Real dot = (up[0] * to[0] + up[1] * to[1] + up[2] * to[2]) / (norm * norm);
+        for (int k = 0; k < 3; k++) {
+            to[k] /= norm;
+            up[k] -= dot * norm * to[k];
+        }
+        norm = sqrtl(up[0] * up[0] + up[1] * up[1] + up[2] * up[2]);
+        for (int k = 0; k < 3; k++) {
+            up[k] /= norm;
+        }
+        Real right[3] = { up[1] * to[2] - up[2] * to[1], up[2] * to[0] - up[0] * to[2], up[0] * to[1] - up[1] * to[0] };
+        const Real* rows[3] = { right, up, to };
+        Real m[4][4];
+        GetEntries(M, m);
+        Real maxError = 0;
+        for (int i = 0; i < 3; i++) {
+            Real translation = -(eye[0] * rows[i][0] + eye[1] * rows[i][1] + eye[2] * rows[i][2]);
+            maxError = std::max(maxError, fabsl(m[i][3] - translation));
+            for (int j = 0; j < 3; j++) {
+                maxError = std::max(maxError, fabsl(m[i][j] - rows[i][j]));
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            maxError = std::max(maxError, fabsl(m[3][j] - (j == 3 ? 1 : 0)));
+        }
+        return maxError;
+    }
+
+    void SetRandom(Matrix4x4* A)
+    {
+        double e[16];
+        for (int k = 0; k < 16; k++) {
+            e[k] = BenchRandom();
+        }
+        A->Set(e[0], e[1], e[2], e[3], e[4], e[5], e[6], e[7],
+               e[8], e[9], e[10], e[11], e[12], e[13], e[14], e[15]);
+    }
+}
+
+void BenchLinear()
+{
+    std::vector<LinearMapR4> A(NumInputs), B(NumInputs);
+    for (int i = 0; i < NumInputs; i++) {
+        SetRandom(&A[i]);
+        SetRandom(&B[i]);
+    }
+
+    // Matrix4x4::operator*=
+    double ns = BenchTimeNs([&](long i) {
+        LinearMapR4 C = A[i % NumInputs];
+        C *= B[(i + 1) % NumInputs];
+        BenchSink += C.m11;
+    }, NumCalls);
+    double nsBaseline = BenchTimeNs([&](long i) {
+        LinearMapR4 C = A[i % NumInputs];
+        TimesEqualsBaseline(C, B[(i + 1) % NumInputs]);
+        BenchSink += C.m11;
+    }, NumCalls);
+    Real err = 0, errSquare = 0, errSquareBaseline = 0;
+    for (int i = 0; i < NumInputs; i++) {
+        LinearMapR4 C = A[i];
+        C *= B[(i + 1) % NumInputs];
+        err = std::max(err, MaxProductError(A[i], B[(i + 1) % NumInputs], C));
+        C = A[i];
+        C *= C;
+        errSquare = std::max(errSquare, MaxProductError(A[i], A[i], C));
+        C = A[i];
+        TimesEqualsBaseline(C, C);
+        errSquareBaseline = std::max(errSquareBaseline, MaxProductError(A[i], A[i], C));
+    }
+    printf("Matrix4x4::operator*=       %6.1f ns  (baseline %5.1f ns)  max abs error %.1Le\n", ns, nsBaseline, err);
+    printf("    A *= A                  max abs error %.1Le  (baseline %.1Le)\n", errSquare, errSquareBaseline);
+
+    // LinearMapR4::Determinant and Inverse
+    ns = BenchTimeNs([&](long i) { BenchSink += A[i % NumInputs].Determinant(); }, NumCalls);
+    err = 0;
+    for (int i = 0; i < NumInputs; i++) {
+        Real a[4][4];
+        GetEntries(A[i], a);
+        Real det = Determinant4(a);
+        err = std::max(err, fabsl(det - A[i].Determinant()) / std::max((Real)1, fabsl(det)));
+    }
+    printf("LinearMapR4::Determinant    %6.1f ns  max rel error %.1Le\n", ns, err);
+
+    ns = BenchTimeNs([&](long i) {
+        LinearMapR4 inverse = A[i % NumInputs].Inverse();
+        BenchSink += inverse.m11;
+    }, NumCalls);
+    err = 0;
+    LinearMapR4 identity;
+    identity.SetIdentity();
+    for (int i = 0; i < NumInputs; i++) {
+        err = std::max(err, MaxProductError(A[i], A[i].Inverse(), identity));
+    }
+    printf("LinearMapR4::Inverse        %6.1f ns  max |A*inv(A)-I| %.1Le\n", ns, err);
+
+    // LinearMapR4::Set_gluPerspective
+    ns = BenchTimeNs([&](long i) {
+        LinearMapR4 P;
+        P.Set_gluPerspective(0.5 + 0.001 * (i % NumInputs), 1.5, 0.1, 100.0);
+        BenchSink += P.m11;
+    }, NumCalls);
+    LinearMapR4 P;
+    P.Set_gluPerspective(0.8, 1.5, 0.1, 100.0);
+    Real f = 1 / tanl(0.4L);
+    err = std::max(fabsl(P.m22 - f) / f, fabsl(P.m33 - (-100.1L / 99.9L)));
+    printf("Set_gluPerspective          %6.1f ns  max rel error %.1Le\n", ns, err);
+
+    std::vector<VectorR3> v(NumInputs), axis(NumInputs);
+    for (int i = 0; i < NumInputs; i++) {
+        v[i].Set(BenchRandom(), BenchRandom(), BenchRandom());
+        axis[i].Set(BenchRandom(), BenchRandom(), BenchRandom());
+        axis[i].Normalize();
+    }
+
+    // LinearMapR4::Set_gluLookAt: eye positions v[i]*10, looking at v[i+1], with up directions axis[i]
+    ns = BenchTimeNs([&](long i) {
+        LinearMapR4 M;
+        M.Set_gluLookAt(10.0 * v[i % NumInputs], v[(i + 1) % NumInputs], axis[i % NumInputs]);
+        BenchSink += M.m11;
+    }, NumCalls);
+    nsBaseline = BenchTimeNs([&](long i) {
+        LinearMapR4 M;
+        SetLookAtBaseline(&M, 10.0 * v[i % NumInputs], v[(i + 1) % NumInputs], axis[i % NumInputs]);
+        BenchSink += M.m11;
+    }, NumCalls);
+    err = 0;
+    Real errBaseline = 0;
+    for (int i = 0; i < NumInputs; i++) {
+        VectorR3 eyePos = 10.0 * v[i];
+        LinearMapR4 M;
+        M.Set_gluLookAt(eyePos, v[(i + 1) % NumInputs], axis[i]);
+        err = std::max(err, LookAtError(M, eyePos, v[(i + 1) % NumInputs], axis[i]));
+        SetLookAtBaseline(&M, eyePos, v[(i + 1) % NumInputs], axis[i]);
+        errBaseline = std::max(errBaseline, LookAtError(M, eyePos, v[(i + 1) % NumInputs], axis[i]));
+    }
+    printf("Set_gluLookAt               %6.1f ns  (baseline %5.1f ns)  max abs error %.1Le  (baseline %.1Le)\n",
+           ns, nsBaseline, err, errBaseline);
+
+    // VectorR3::Rotate
+    ns = BenchTimeNs([&](long i) {
+        VectorR3 u = v[i % NumInputs];
+        u.Rotate(0.3, axis[i % NumInputs]);
+        BenchSink += u.x;
+    }, NumCalls);
+    err = 0;
+    Real c = cosl(0.3L), s = sinl(0.3L);
+    for (int i = 0; i < NumInputs; i++) {
+        VectorR3 u = v[i];
+        u.Rotate(0.3, axis[i]);
+        // Rodrigues' formula
+        Real vx = v[i].x, vy = v[i].y, vz = v[i].z;
+        Real wx = axis[i].x, wy = axis[i].y, wz = axis[i].z;
+        Real dot = vx * wx + vy * wy + vz * wz;
+        Real rx = vx * c + (wy * vz - wz * vy) * s + wx * dot * (1 - c);
+        Real ry = vy * c + (wz * vx - wx * vz) * s + wy * dot * (1 - c);
+        Real rz = vz * c + (wx * vy - wy * vx) * s + wz * dot * (1 - c);
+        err = std::max(err, fabsl(rx - u.x) + fabsl(ry - u.y) + fabsl(rz - u.z));
+    }
+    printf("VectorR3::Rotate            %6.1f ns  max abs error %.1Le\n", ns, err);
+
+    // Matrix3x3::ReNormalize, on rotations perturbed by about 1.0e-4
+    std::vector<Matrix3x3> Q(NumInputs);
+    for (int i = 0; i < NumInputs; i++) {
+        LinearMapR4 R;
+        R.Set_glRotate(3.0 * BenchRandom(), axis[i]);
+        Q[i].Set(R.m11 + 1.0e-4 * BenchRandom(), R.m21 + 1.0e-4 * BenchRandom(), R.m31 + 1.0e-4 * BenchRandom(),
+                 R.m12 + 1.0e-4 * BenchRandom(), R.m22 + 1.0e-4 * BenchRandom(), R.m32 + 1.0e-4 * BenchRandom(),
+                 R.m13 + 1.0e-4 * BenchRandom(), R.m23 + 1.0e-4 * BenchRandom(), R.m33 + 1.0e-4 * BenchRandom());
+    }
+    ns = BenchTimeNs([&](long i) {
+        Matrix3x3 X = Q[i % NumInputs];
+        X.ReNormalize();
+        BenchSink += X.m11;
+    }, NumCalls);
+    Real errBefore = 0;
+    err = 0;
+    for (int i = 0; i < NumInputs; i++) {
+        Matrix3x3 X = Q[i];
+        errBefore = std::max(errBefore, OrthonormalError(X));
+        X.ReNormalize();
+        err = std::max(err, OrthonormalError(X));
+    }
+    printf("Matrix3x3::ReNormalize      %6.1f ns  max |Q^T*Q-I| from %.1Le to %.1Le\n", ns, errBefore, err);
+
+    // LinearMapR3::InversePosDef, against the general Inverse
+    std::vector<LinearMapR3> S(NumInputs);
+    for (int i = 0; i < NumInputs; i++) {
+        LinearMapR3 G(BenchRandom(), BenchRandom(), BenchRandom(), BenchRandom(), BenchRandom(),
+                      BenchRandom(), BenchRandom(), BenchRandom(), BenchRandom());
+        LinearMapR3 Gt = G;
+        Gt.MakeTranspose();
+        S[i] = Gt * G;              // Symmetric positive definite, after adding 0.1*I
+        S[i].m11 += 0.1;
+        S[i].m22 += 0.1;
+        S[i].m33 += 0.1;
+    }
+    ns = BenchTimeNs([&](long i) {
+        LinearMapR3 inverse = S[i % NumInputs].InversePosDef();
+        BenchSink += inverse.m11;
+    }, NumCalls);
+    nsBaseline = BenchTimeNs([&](long i) {
+        LinearMapR3 inverse = S[i % NumInputs].Inverse();
+        BenchSink += inverse.m11;
+    }, NumCalls);
+    err = 0;
+    for (int i = 0; i < NumInputs; i++) {
+        err = std::max(err, InverseError(S[i], S[i].InversePosDef()));
+    }
+    printf("LinearMapR3::InversePosDef  %6.1f ns  (Inverse %5.1f ns)  max |A*inv(A)-I| %.1Le\n", ns, nsBaseline, err);
+}
@@ -0,0 +1,66 @@
+/*
+* BenchMain.cpp
+*
+* The main program of the benchmarks.  See Benchmarks.h.
+*/
+
+#include "Benchmarks.h"
+#include <random>
+#include <stdio.h>
+#include <string.h>
+
+volatile double BenchSink = 0.0;
+
+double BenchRandom()
+{
+    static std::mt19937_64 generator(7);
+    static std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    return distribution(generator);
+}
+
+namespace {
+    struct BenchSection {
+        const char* name;
+        void (*run)();
+    };
+
+    const BenchSection Sections[] = {
+        { "linear", BenchLinear },
+        { "mesh", BenchMesh },
+        { "transforms", BenchTransforms },
+        { "fused", BenchFused },
+        { "approx", BenchApprox },
+        { "bmp", BenchBmp },
+    };
+    const int NumSections = sizeof(Sections) / sizeof(Sections[0]);
+}
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        bool found = false;
+        for (int j = 0; j < NumSections; j++) {
+            found = found || strcmp(argv[i], Sections[j].name) == 0;
+        }
+        if (!found) {
+            fprintf(stderr, "Unknown section \"%s\".  The sections are:", argv[i]);
+            for (int j = 0; j < NumSections; j++) {
+                fprintf(stderr, " %s", Sections[j].name);
+            }
+            fprintf(stderr, "\n");
+            return 1;
+        }
+    }
+    for (int j = 0; j < NumSections; j++) {
+        bool selected = (argc == 1);
+        for (int i = 1; i < argc; i++) {
+            selected = selected || strcmp(argv[i], Sections[j].name) == 0;
+        }
+        if (selected) {
+            printf("== %s\n", Sections[j].name);
+            Sections[j].run();
+            printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+* BenchMesh.cpp
+*
+* Benchmarks of mesh generation with GlGeomMeshBuilder: vertices per second
+*   for each shape, mesh resolution and VBO/EBO layout.  Only Build() is timed
+*   (the builder and the output buffers are set up first), so the times are
+*   those of filling a mapped VBO and EBO.  The shapes are the mesh generators
+*   (GlGeomSphereMesh, etc.), so OpenGL is not used or linked.
+*/
+
+#include "Benchmarks.h"
+#include "GlGeomMeshBuilder.h"
+#include "GlGeomSphereMesh.h"
+#include "GlGeomCylinderMesh.h"
+#include "GlGeomTorusMesh.h"
+#include <stdio.h>
+#include <vector>
+
+namespace {
+    struct MeshLayout {
+        const char* name;
+        GlGeomMeshOptions options;
+    };
+
+    std::vector<MeshLayout> MakeLayouts()
+    {
+        std::vector<MeshLayout> layouts;
+        MeshLayout layout;
+        layout.name = "float";
+        layouts.push_back(layout);
+        layout.name = "float, no texcoords";
+        layout.options.useTexCoords = false;
+        layouts.push_back(layout);
+        layout = MeshLayout();
+        layout.name = "compact";
+        layout.options.format = GlGeomVertexFormat::Compact();
+        layouts.push_back(layout);
+        layout.name = "compact, half positions";
+        layout.options.format = GlGeomVertexFormat::Compact(true);
+        layouts.push_back(layout);
+        layout = MeshLayout();
+        layout.name = "float, vertex cache";
+        layout.options.optimizeVertexCache = true;
+        layouts.push_back(layout);
+        layout = MeshLayout();
+        layout.name = "float, strips";
+        layout.options.triangleStrips = true;
+        layouts.push_back(layout);
+        layout = MeshLayout();
+        layout.name = "float, 3 LOD levels";
+        layout.options.numLodLevels = GlGeomMaxLodLevels;
+        layouts.push_back(layout);
+        return layouts;
+    }
+
+    void BenchShape(const char* shapeName, int resolution, const GlGeomMeshGenerator* shape,
+                    const std::vector<MeshLayout>& layouts)
+    {
+        for (const MeshLayout& layout : layouts) {
+            GlGeomMeshBuilder builder(shape, layout.options);
+            std::vector<unsigned char> VBOdata(builder.GetVBOSize());
+            std::vector<unsigned char> EBOdata(builder.GetEBOSize());
+            double ms = BenchTimeMs([&]() { builder.Build(VBOdata.data(), EBOdata.data()); });
+            BenchSink += VBOdata[0];
+            double verticesPerSec = builder.GetNumVertices() / (ms * 1.0e-3);
+            printf("%-8s %4d  %-24s %8d vertices  %8.3f ms  %7.1f M vertices/s\n", shapeName, resolution,
+                   layout.name, builder.GetNumVertices(), ms, verticesPerSec * 1.0e-6);
+        }
+    }
+}
+
+void BenchMesh()
+{
+    const int Resolutions[] = { 32, 128, 512 };
+    std::vector<MeshLayout> layouts = MakeLayouts();
+    for (int n : Resolutions) {
+        GlGeomSphereMesh sphere(n, n / 2);
+        BenchShape("Sphere", n, &sphere, layouts);
+    }
+    for (int n : Resolutions) {
+        GlGeomTorusMesh torus(n, n / 2, 0.3f);
+        BenchShape("Torus", n, &torus, layouts);
+    }
+    for (int n : Resolutions) {
+        GlGeomCylinderMesh cylinder(n, n / 4, n / 8);
+        BenchShape("Cylinder", n, &cylinder, layouts);
+    }
+}
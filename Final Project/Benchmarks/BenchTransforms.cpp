@@ -0,0 +1,118 @@
+/*
+* BenchTransforms.cpp
+*
+* Benchmarks of the batch transformations of vertex arrays (LinearMapR4f and
+*   AffineMapR3), against transforming one vector at a time with
+*   LinearMapR4::AffineTransformPosition.  The positions are in an array laid
+*   out as VBO data, with 8 floats per vertex.  The errors are measured against
+*   the double precision transformation.
+*/
+
+#include "Benchmarks.h"
+#include "LinearR3.h"
+#include "LinearR3bis.h"
+#include "LinearR4.h"
+#include "LinearR4f.h"
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    const int NumVertices = 1000000;
+    const int Stride = 8;               // Floats per vertex: position, normal, texture coordinates
+
+    // The largest difference between the transformed positions and the double precision results.
+    double MaxError(const float* positions, int stride, const std::vector<VectorR3>& exact)
+    {
+        double maxError = 0.0;
+        for (int i = 0; i < NumVertices; i++) {
+            const float* p = positions + (size_t)i * stride;
+            maxError = std::max(maxError, fabs(p[0] - exact[i].x) + fabs(p[1] - exact[i].y) + fabs(p[2] - exact[i].z));
+        }
+        return maxError;
+    }
+}
+
+void BenchTransforms()
+{
+    std::vector<float> vertexData((size_t)NumVertices * Stride);
+    for (float& f : vertexData) {
+        f = (float)BenchRandom();
+    }
+    LinearMapR4 M;
+    M.Set_glTranslate(0.5, -1.0, 2.0);
+    M.Mult_glRotate(0.7, VectorR3(1.0, 2.0, 3.0).Normalize());
+    M.Mult_glScale(1.5);
+    LinearMapR4f Mf(M);
+    AffineMapR3 A(M);
+
+    std::vector<VectorR3> exact(NumVertices);
+    for (int i = 0; i < NumVertices; i++) {
+        const float* p = &vertexData[(size_t)i * Stride];
+        exact[i].Set(p[0], p[1], p[2]);
+        M.AffineTransformPosition(exact[i]);
+    }
+
+    std::vector<float> dest(vertexData.size());
+    double msBaseline = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVertices; i++) {
+            const float* p = &vertexData[(size_t)i * Stride];
+            VectorR3 v(p[0], p[1], p[2]);
+            M.AffineTransformPosition(v);
+            float* q = &dest[(size_t)i * Stride];
+            q[0] = (float)v.x;
+            q[1] = (float)v.y;
+            q[2] = (float)v.z;
+        }
+    });
+    printf("%d positions, stride %d floats\n", NumVertices, Stride);
+    printf("LinearMapR4::AffineTransformPosition loop   %7.2f ms  (baseline)   max error %.1e\n",
+           msBaseline, MaxError(dest.data(), Stride, exact));
+
+    double ms = BenchTimeMs([&]() { Mf.TransformPositions(vertexData.data(), dest.data(), NumVertices, Stride, Stride); });
+    printf("LinearMapR4f::TransformPositions            %7.2f ms  (%4.1fx)      max error %.1e\n",
+           ms, msBaseline / ms, MaxError(dest.data(), Stride, exact));
+    ms = BenchTimeMs([&]() { Mf.TransformPositions(vertexData.data(), dest.data(), NumVertices, Stride, Stride, true); });
+    printf("    with threads                            %7.2f ms  (%4.1fx)      max error %.1e\n",
+           ms, msBaseline / ms, MaxError(dest.data(), Stride, exact));
+    ms = BenchTimeMs([&]() { Mf.TransformDirections(vertexData.data(), dest.data(), NumVertices, Stride, Stride); });
+    printf("LinearMapR4f::TransformDirections           %7.2f ms  (%4.1fx)\n", ms, msBaseline / ms);
+
+    // Structure of arrays, and packed (x,y,z,w) vectors
+    std::vector<float> x(NumVertices), y(NumVertices), z(NumVertices);
+    std::vector<float> vectors4((size_t)4 * NumVertices);
+    for (int i = 0; i < NumVertices; i++) {
+        const float* p = &vertexData[(size_t)i * Stride];
+        x[i] = vectors4[4 * i] = p[0];
+        y[i] = vectors4[4 * i + 1] = p[1];
+        z[i] = vectors4[4 * i + 2] = p[2];
+        vectors4[4 * i + 3] = 1.0f;
+    }
+    std::vector<float> destX(NumVertices), destY(NumVertices), destZ(NumVertices);
+    ms = BenchTimeMs([&]() {
+        Mf.TransformPositionsSoA(x.data(), y.data(), z.data(), destX.data(), destY.data(), destZ.data(), NumVertices);
+    });
+    double err = 0.0;
+    for (int i = 0; i < NumVertices; i++) {
+        err = std::max(err, fabs(destX[i] - exact[i].x) + fabs(destY[i] - exact[i].y) + fabs(destZ[i] - exact[i].z));
+    }
+    printf("LinearMapR4f::TransformPositionsSoA         %7.2f ms  (%4.1fx)      max error %.1e\n", ms, msBaseline / ms, err);
+    std::vector<float> dest4(vectors4.size());
+    ms = BenchTimeMs([&]() { Mf.TransformVectors(vectors4.data(), dest4.data(), NumVertices); });
+    printf("LinearMapR4f::TransformVectors              %7.2f ms  (%4.1fx)      max error %.1e\n",
+           ms, msBaseline / ms, MaxError(dest4.data(), 4, exact));
+
+    // Double precision, in place
+    std::vector<VectorR3> positions(NumVertices);
+    ms = BenchTimeMs([&]() {
+        for (int i = 0; i < NumVertices; i++) {
+            const float* p = &vertexData[(size_t)i * Stride];
+            positions[i].Set(p[0], p[1], p[2]);
+        }
+        A.AffineTransformPositions(positions.data(), NumVertices);
+    });
+    BenchSink += positions[0].x;
+    printf("AffineMapR3::AffineTransformPositions       %7.2f ms  (%4.1fx)      (double, including the copy in)\n",
+           ms, msBaseline / ms);
+}
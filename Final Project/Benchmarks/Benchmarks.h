@@ -0,0 +1,62 @@
+/*
+* Benchmarks.h
+*
+* Timing and accuracy benchmarks for the Final Project's libraries, as a
+*   console program (Benchmarks.vcxproj).  It does not use or link OpenGL.
+*   Each section times the library code against a baseline (the obvious or
+*   C library version), and where it makes sense measures the error against a
+*   more precise reference (long double, or double for float code).
+*
+*   Usage:  Benchmarks [section ...]
+*      With no arguments, all the sections are run.  Build in the Release
+*      configuration: Debug build times are not meaningful.
+*/
+
+#pragma once
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <chrono>
+
+// Runs func(i) for 0 <= i < count.  Returns the average time per call, in nanoseconds.
+template<class F> double BenchTimeNs(F func, long count)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 0; i < count; i++) {
+        func(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+}
+
+// Runs func() numRuns times.  Returns the fastest run, in milliseconds.
+//    For timing whole arrays: the first run also warms the caches.
+template<class F> double BenchTimeMs(F func, int numRuns = 5)
+{
+    double best = 0.0;
+    for (int run = 0; run < numRuns; run++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        func();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+// Results are added to BenchSink, so the compiler cannot remove the timed code.
+extern volatile double BenchSink;
+
+// A pseudo-random number in [-1, 1].  The sequence is the same on every run.
+double BenchRandom();
+
+// The sections (in BenchMain.cpp's table)
+void BenchLinear();         // LinearR3 and LinearR4 (BenchLinear.cpp)
+void BenchMesh();           // Mesh generation with GlGeomMeshBuilder (BenchMesh.cpp)
+void BenchTransforms();     // Batch transformations of vertex arrays (BenchTransforms.cpp)
+void BenchFused();          // Fused VectorR3 operations (BenchFused.cpp)
+void BenchApprox();         // Fast sin, cos, exp and atan2 (BenchApprox.cpp)
+void BenchBmp();            // Reading and writing BMP files (BenchBmp.cpp)
+
+#endif  // BENCHMARKS_H
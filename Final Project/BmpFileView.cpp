@@ -0,0 +1,104 @@
+/*
+* BmpFileView.cpp
+*
+* Zero-copy views of 24 bit BMP files.  See BmpFileView.h.
+*/
+
+#include "BmpFileView.h"
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+#if defined(_WIN32)         // If on windows, need this for gl.h
+#include <windows.h>
+#endif  // defined(_WIN32)
+#include "GL/gl.h"
+#endif
+#ifndef GL_BGR
+#define GL_BGR 0x80E0       // Not in the OpenGL 1.1 gl.h of Windows
+#endif
+#ifndef BI_RGB
+#define BI_RGB 0
+#endif
+
+namespace {
+    long GetLittleEndian(const unsigned char* bytes, int numBytes)
+    {
+        unsigned long ret = 0;
+        for (int i = numBytes - 1; i >= 0; i--) {
+            ret = (ret << 8) | bytes[i];
+        }
+        return (long)ret;
+    }
+}
+
+// The header is checked as in RgbImage::LoadBmpFile.  See RgbImage.cpp for the file format.
+bool BmpFileView::Open(const char* filename)
+{
+    Close();
+    if (!file.Open(filename)) {
+        fprintf(stderr, "Unable to open file: %s\n", filename);
+        errorCode = RgbImage::OpenError;
+        return false;
+    }
+
+    const unsigned char* bytes = file.Data();
+    size_t size = file.Size();
+    bool fileFormatOK = false;
+    long offset = 0;
+    if (size >= 34 && bytes[0] == 'B' && bytes[1] == 'M') {
+        offset = GetLittleEndian(bytes + 10, 4);            // Offset to the bitmap table
+        long headerSize = GetLittleEndian(bytes + 14, 4);
+        numCols = GetLittleEndian(bytes + 18, 4);
+        numRows = GetLittleEndian(bytes + 22, 4);
+        int bitsPerPixel = (int)GetLittleEndian(bytes + 28, 2);
+        long compressionMethod = (headerSize >= 40) ? GetLittleEndian(bytes + 30, 4) : BI_RGB;
+        if (numCols > 0 && numCols <= 100000 && numRows > 0 && numRows <= 100000
+            && bitsPerPixel == 24 && compressionMethod == BI_RGB && offset >= 30 && (size_t)offset <= size) {
+            fileFormatOK = true;
+        }
+    }
+    if (!fileFormatOK) {
+        fprintf(stderr, "Not a valid 24-bit, BI_RGB, bitmap file: %s.\n", filename);
+        Close();
+        errorCode = RgbImage::FileFormatError;
+        return false;
+    }
+    if ((size_t)offset + (size_t)numRows * (size_t)GetNumBytesPerRow() > size) {
+        fprintf(stderr, "Premature end of file: %s.\n", filename);
+        Close();
+        errorCode = RgbImage::ReadError;
+        return false;
+    }
+    pixelData = bytes + offset;
+    errorCode = RgbImage::NoError;
+    return true;
+}
+
+void BmpFileView::Close()
+{
+    file.Close();
+    numRows = 0;
+    numCols = 0;
+    pixelData = 0;
+    errorCode = RgbImage::NoError;
+}
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+
+bool BmpFileView::TexImage2D(unsigned int target, int level, int internalFormat) const
+{
+    if (!IsOpen()) {
+        return false;
+    }
+    GLint oldAlignment, oldRowLength;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &oldRowLength);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, GetRowAlignment());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)numCols);
+    glTexImage2D((GLenum)target, level, internalFormat, (GLsizei)numCols, (GLsizei)numRows, 0,
+                 GL_BGR, GL_UNSIGNED_BYTE, pixelData);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, oldRowLength);
+    return true;
+}
+
+#endif  // RGBIMAGE_DONT_USE_OPENGL
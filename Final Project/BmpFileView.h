@@ -0,0 +1,76 @@
+/*
+* BmpFileView.h
+*
+* A zero-copy view of the pixels of an uncompressed 24 bit BMP file.
+*   The file is memory mapped (see MappedFile.h), and the pixel data is used in
+*   place: there is no allocation and no copy, as there is with RgbImage.
+*   The pixels are as stored in the file:
+*     - rows go from bottom to top (the same as OpenGL textures),
+*     - each pixel is three bytes, in the order blue, green, red, and
+*     - each row is padded to a multiple of four bytes.
+*   So the data can be given directly to glTexImage2D with format GL_BGR,
+*   GL_UNPACK_ALIGNMENT equal to 4 and GL_UNPACK_ROW_LENGTH equal to GetNumCols().
+*   TexImage2D() does that.
+*
+* How to use:
+*     BmpFileView texMap;
+*     if (texMap.Open("floor.bmp")) {
+*         glBindTexture(GL_TEXTURE_2D, textureName);
+*         texMap.TexImage2D(GL_TEXTURE_2D);
+*     }
+*   Error codes are those of RgbImage.
+*/
+
+#pragma once
+#ifndef BMP_FILE_VIEW_H
+#define BMP_FILE_VIEW_H
+
+#include "MappedFile.h"
+#include "RgbImage.h"
+
+class BmpFileView {
+public:
+    BmpFileView() : numRows(0), numCols(0), pixelData(0), errorCode(RgbImage::NoError) {}
+    BmpFileView(const char* filename) : BmpFileView() { Open(filename); }
+
+    // Returns true for success.  Errors also print a message to stderr.
+    bool Open(const char* filename);
+    void Close();
+    bool IsOpen() const { return pixelData != 0; }
+
+    long GetNumRows() const { return numRows; }
+    long GetNumCols() const { return numCols; }
+    long GetNumBytesPerRow() const { return ((3 * numCols + 3) >> 2) << 2; }
+    static int GetRowAlignment() { return 4; }          // For GL_UNPACK_ALIGNMENT
+
+    // The pixel data, BGR order, bottom row first. Valid until Close().
+    const unsigned char* PixelData() const { return pixelData; }
+    const unsigned char* GetBgrPixel(long row, long col) const;
+
+    // Makes the mapped pages resident now. See MappedFile::Prefault().
+    void Prefault() const { file.Prefault(); }
+
+    int GetErrorCode() const { return errorCode; }
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+    // glTexImage2D from the mapped file, to the currently bound texture.
+    //    The unpack alignment and row length are set for the call, and then restored.
+    //    internalFormat is typically GL_RGB (or GL_SRGB8).
+    bool TexImage2D(unsigned int target, int level = 0, int internalFormat = 0x1907 /*GL_RGB*/) const;
+#endif
+
+private:
+    MappedFile file;
+    long numRows;
+    long numCols;
+    const unsigned char* pixelData;
+    int errorCode;
+};
+
+inline const unsigned char* BmpFileView::GetBgrPixel(long row, long col) const
+{
+    assert(row < numRows && col < numCols);
+    return pixelData + row * GetNumBytesPerRow() + 3 * col;
+}
+
+#endif  // BMP_FILE_VIEW_H
@@ -59,6 +59,9 @@ unsigned int phGetProjMatLoc(unsigned int programID) {
 unsigned int phGetModelviewMatLoc(unsigned int programID) {
     return glGetUniformLocation(programID, phModelviewMatName);
 }
+unsigned int phGetNormalMatLoc(unsigned int programID) {
+    return glGetUniformLocation(programID, phNormalMatName);
+}
 unsigned int phGetApplyTextureLoc(unsigned int programID) {
     return glGetUniformLocation(programID, phApplyTextureName);
 }
@@ -130,10 +130,12 @@ bool phRegisterShaderProgram(unsigned int programID);
 
 unsigned int phGetProjMatLoc(unsigned int programID);
 unsigned int phGetModelviewMatLoc(unsigned int programID);
+unsigned int phGetNormalMatLoc(unsigned int programID);
 unsigned int phGetApplyTextureLoc(unsigned int programID);
 
 constexpr const char* phProjMatName = "projectionMatrix";		// Name of the uniform variable projectionMatrix
 constexpr const char* phModelviewMatName = "modelviewMatrix";	// Name of the uniform variable modelviewMatrix
+constexpr const char* phNormalMatName = "normalMatrix";		// Name of the uniform variable normalMatrix
 constexpr const char* phApplyTextureName = "applyTexture";	    // Name of the uniform variable applyTexture
 
 // *************************************
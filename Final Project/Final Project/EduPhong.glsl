@@ -74,13 +74,65 @@ out float useFresnel;
 
 uniform mat4 projectionMatrix;        // The projection matrix
 uniform mat4 modelviewMatrix;         // The modelview matrix
+uniform mat3 normalMatrix;            // Inverse transpose of the modelview matrix's 3x3 part (computed on the CPU)
 
 void main()
 {
     vec4 mvPos4 = modelviewMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0); 
     gl_Position = projectionMatrix * mvPos4; 
     mvPos = vec3(mvPos4.x,mvPos4.y,mvPos4.z)/mvPos4.w; 
-    mvNormalFront = normalize(inverse(transpose(mat3(modelviewMatrix)))*vertNormal); // Unit normal from the surface 
+    mvNormalFront = normalize(normalMatrix*vertNormal); // Unit normal from the surface 
+    matEmissive = EmissiveColor;
+    matAmbient = AmbientColor;
+    matDiffuse = DiffuseColor;
+    matSpecular = SpecularColor;
+    matSpecExponent = SpecularExponent;
+    theTexCoords = vertTexCoords;
+    useFresnel = UseFresnel;
+}
+#endglsl
+
+// **************
+// The instanced version of the vertex shader for Phong lighting with Phong shading.
+//   Each instance supplies its own matrix (in locations 9-12) which is applied
+//   before the modelview matrix, and the matrix's normal matrix (in locations 13-15).
+//   Used with GlGeomBase::RenderInstanced().
+// **************
+#beginglsl vertexshader vertexShader_PhongPhongInstanced
+#version 330 core
+layout (location = 0) in vec3 vertPos;         // Position in attribute location 0
+layout (location = 1) in vec3 vertNormal;      // Surface normal in attribute location 1
+layout (location = 2) in vec2 vertTexCoords;   // Texture coordinates in attribute location 2
+layout (location = 3) in vec3 EmissiveColor;   // Surface material properties 
+layout (location = 4) in vec3 AmbientColor; 
+layout (location = 5) in vec3 DiffuseColor; 
+layout (location = 6) in vec3 SpecularColor; 
+layout (location = 7) in float SpecularExponent; 
+layout (location = 8) in float UseFresnel;		// Should be 1.0 (for Fresnel) or 0.0 (for no Fresnel)
+layout (location = 9) in mat4 instanceMatrix;  // Per-instance matrix (uses locations 9, 10, 11, 12)
+layout (location = 13) in mat3 instanceNormalMatrix;  // Its normal matrix (uses locations 13, 14, 15)
+
+out vec3 mvPos;         // Vertex position in modelview coordinates
+out vec3 mvNormalFront; // Normal vector to vertex in modelview coordinates
+out vec3 matEmissive;
+out vec3 matAmbient;
+out vec3 matDiffuse;
+out vec3 matSpecular;
+out float matSpecExponent;
+out vec2 theTexCoords;
+out float useFresnel;
+
+uniform mat4 projectionMatrix;        // The projection matrix
+uniform mat4 modelviewMatrix;         // The modelview matrix (shared by all instances)
+uniform mat3 normalMatrix;            // The normal matrix of modelviewMatrix
+
+void main()
+{
+    mat4 mvMatrix = modelviewMatrix * instanceMatrix;
+    vec4 mvPos4 = mvMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0); 
+    gl_Position = projectionMatrix * mvPos4; 
+    mvPos = vec3(mvPos4.x,mvPos4.y,mvPos4.z)/mvPos4.w; 
+    mvNormalFront = normalize(normalMatrix*(instanceNormalMatrix*vertNormal)); // Unit normal from the surface 
     matEmissive = EmissiveColor;
     matAmbient = AmbientColor;
     matDiffuse = DiffuseColor;
@@ -222,6 +274,7 @@ layout (std140) uniform phLightArray {
 
 uniform mat4 projectionMatrix;        // The projection matrix
 uniform mat4 modelviewMatrix;         // The modelview matrix
+uniform mat3 normalMatrix;            // Inverse transpose of the modelview matrix's 3x3 part (computed on the CPU)
 
 vec3 mvPos;   // Vertex position in modelview coordinates
 vec3 mvNormal; // Normal vector to vertex in modelview coordinates
@@ -238,7 +291,7 @@ void main()
     vec4 mvPos4 = modelviewMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0); 
     gl_Position = projectionMatrix * mvPos4; 
     mvPos = vec3(mvPos4.x,mvPos4.y,mvPos4.z)/mvPos4.w; 
-    mvNormal = normalize(inverse(transpose(mat3(modelviewMatrix)))*vertNormal); 
+    mvNormal = normalize(normalMatrix*vertNormal); 
     matEmissive = EmissiveColor;
     matAmbient = AmbientColor;
     matDiffuse = DiffuseColor;
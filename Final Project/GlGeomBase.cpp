@@ -26,68 +26,288 @@
 
 #include "GlGeomBase.h"
 #include "assert.h"
+#include <map>
+#include <vector>
+#include <future>
+#include <chrono>
+#include "MathMisc.h"
+#include "GlGeomMeshBuilder.h"
 
 // Use the static library (so glew32.dll is not needed):
 #define GLEW_STATIC
 #include <GL/glew.h> 
 #include <GLFW/glfw3.h>
 
+// **********************************************
+// The shared mesh registry.
+// Maps a mesh key to the VBO and EBO holding that mesh, with a count of
+//    how many GlGeomBase objects are using them.
+// **********************************************
+namespace {
+    struct GlGeomSharedMesh {
+        unsigned int VBO;
+        unsigned int EBO;
+        int refCount;
+    };
+    typedef std::map<GlGeomMeshKey, GlGeomSharedMesh> GlGeomMeshRegistry;
+
+    // The registry is allocated on first use and never freed, so that it
+    //   outlives any global or static GlGeomShape objects.
+    GlGeomMeshRegistry& TheMeshRegistry()
+    {
+        static GlGeomMeshRegistry* registry = new GlGeomMeshRegistry;
+        return *registry;
+    }
+
+    // The options for calculating the VBO and EBO data, as set for the shape
+    GlGeomMeshOptions GetMeshOptions(const GlGeomBase& shape)
+    {
+        GlGeomMeshOptions options;
+        options.useNormals = shape.UseNormals();
+        options.useTexCoords = shape.UseTexCoords();
+        options.format = shape.GetVertexFormat();
+        options.numLodLevels = shape.GetNumLodLevels();
+        options.optimizeVertexCache = shape.GetOptimizeVertexCache();
+        options.triangleStrips = shape.GetTriangleStrips();
+        return options;
+    }
+}
+
+float GlGeomBase::LodSwitchRadius = 64.0f;
+float GlGeomBase::lodProjScale = 0.0f;
+bool GlGeomBase::lodPerspective = true;
+
+// **********************************************
+// A background remesh: the VBO and EBO data are calculated by the
+//    generator object on a worker thread, into memory (not OpenGL buffers).
+// **********************************************
+struct GlGeomRemeshJob {
+    GlGeomMeshKey key;                  // The mesh being calculated
+    const GlGeomMeshGenerator* generator;   // The new mesh; owned by the job
+    GlGeomMeshBuilder* builder;         // Calculates the data for generator; owned by the job
+    std::vector<unsigned char> VBOdata;
+    std::vector<unsigned char> EBOdata;
+    std::future<void> done;             // Ready once the worker thread has finished
+
+    bool IsReady() const { return done.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+    ~GlGeomRemeshJob() {
+        if (done.valid()) {
+            done.wait();
+        }
+        delete builder;
+        delete generator;
+    }
+};
+
 void GlGeomBase::ReInitializeAttribLocations()
 {
-    InitializeAttribLocations(posLoc, normalLoc, texcoordsLoc);
+    InitializeAttribLocations(posLoc, normalLoc, texcoordsLoc, instanceMatLoc);
 }
 
 void GlGeomBase::InitializeAttribLocations(
-    unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
+    unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc,
+    unsigned int instanceMat_loc)
 {
     posLoc = pos_loc;
     normalLoc = normal_loc;
     texcoordsLoc = texcoords_loc;
+    if (instanceMat_loc != instanceMatLoc) {
+        instanceMatLoc = instanceMat_loc;
+        instanceVBO = 0;            // Force the instance attributes to be set up again
+    }
 
-    // Generate Vertex Array Object and Buffer Objects, not already done.
+    // Generate Vertex Array Object, if not already done.
     if (theVAO == 0) {
         glGenVertexArrays(1, &theVAO);
-        glGenBuffers(1, &theVBO);
-        glGenBuffers(1, &theEBO);
     }
 
+    // Get the VBO and EBO. These are shared with other objects with the identical mesh,
+    //    and if another object has already loaded them, there is nothing to calculate.
+    bool needsCalc = AcquireMeshBuffers();
+
+    // Lay out the levels of detail, and choose the index type.
+    GlGeomMeshBuilder builder(GetMeshGenerator(), GetMeshOptions(*this));
+    SetLoadedLayout(builder);
+
     // Link the VBO and EBO to the VAO, and request OpenGL to
-    //   allocate memory for them.
+    //   allocate memory for them (if they are new).
     glBindVertexArray(theVAO);
     glBindBuffer(GL_ARRAY_BUFFER, theVBO);
-    int numVertices = UseTexCoords() ? GetNumVerticesTexCoords() : GetNumVerticesNoTexCoords();
-    glBufferData(GL_ARRAY_BUFFER, StrideVal() * numVertices * sizeof(float), 0, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GetNumElementsMax() * sizeof(unsigned int), 0, GL_STATIC_DRAW);
-    glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, StrideVal() * sizeof(float), (void*)0);
+    if (needsCalc) {
+        glBufferData(GL_ARRAY_BUFFER, builder.GetVBOSize(), 0, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, builder.GetEBOSize(), 0, GL_STATIC_DRAW);
+    }
+    SetVertexAttribPointers();
+
+    if (needsCalc) {
+        CalcVBOandEBO_Base(builder);
+    }
+    else {
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
+
+// Record the levels of detail and index type of the VBO and EBO being loaded.
+void GlGeomBase::SetLoadedLayout(const GlGeomMeshBuilder& builder)
+{
+    numLodLevelsLoaded = builder.GetNumLodLevels();
+    for (int i = 0; i < numLodLevelsLoaded; i++) {
+        lodLevels[i] = builder.GetLodLevel(i);
+    }
+    shortIndices = builder.UseShortIndices();
+    stripsLoaded = builder.UseTriangleStrips();
+    reorderedLoaded = builder.GetOptions().optimizeVertexCache;
+}
+
+unsigned int GlGeomBase::GetIndexType() const
+{
+    return shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+// Set the attribute pointers into theVBO.
+//    The VAO and theVBO must already be bound.
+// The attribute formats follow the vertex format (see GlGeomVertexFormat.h)
+void GlGeomBase::SetVertexAttribPointers()
+{
+    int vertexSize = VertexSize();
+    size_t offset = 0;
+    if (vertexFormat.position == GlGeomPositionFloat) {
+        glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*)offset);
+    }
+    else {
+        glVertexAttribPointer(posLoc, 3, GL_HALF_FLOAT, GL_FALSE, vertexSize, (void*)offset);
+    }
     glEnableVertexAttribArray(posLoc);
+    offset += vertexFormat.PositionSize();
     if (UseNormals()) {
-        glVertexAttribPointer(normalLoc, 3, GL_FLOAT, GL_FALSE, StrideVal() * sizeof(float),
-            (void*)(NormalOffset() * sizeof(float)));
+        if (vertexFormat.normal == GlGeomNormalFloat) {
+            glVertexAttribPointer(normalLoc, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*)offset);
+        }
+        else {
+            glVertexAttribPointer(normalLoc, 4, GL_INT_2_10_10_10_REV, GL_TRUE, vertexSize, (void*)offset);
+        }
         glEnableVertexAttribArray(normalLoc);
+        offset += vertexFormat.NormalSize();
     }
     if (UseTexCoords()) {
-         glVertexAttribPointer(texcoordsLoc, 2, GL_FLOAT, GL_FALSE, StrideVal() * sizeof(float),
-            (void*)(TexOffset() * sizeof(float)));
+        switch (vertexFormat.texCoords) {
+        case GlGeomTexCoordFloat:
+            glVertexAttribPointer(texcoordsLoc, 2, GL_FLOAT, GL_FALSE, vertexSize, (void*)offset);
+            break;
+        case GlGeomTexCoordHalf:
+            glVertexAttribPointer(texcoordsLoc, 2, GL_HALF_FLOAT, GL_FALSE, vertexSize, (void*)offset);
+            break;
+        case GlGeomTexCoordUnorm16:
+            glVertexAttribPointer(texcoordsLoc, 2, GL_UNSIGNED_SHORT, GL_TRUE, vertexSize, (void*)offset);
+            break;
+        }
         glEnableVertexAttribArray(texcoordsLoc);
     }
+    if (UseInstancing()) {
+        // The per-instance matrix occupies four consecutive locations, one per column,
+        //    and its normal matrix the next three.
+        // The divisor is part of the VAO state, so it only needs to be set once.
+        for (unsigned int i = 0; i < 7; i++) {
+            glVertexAttribDivisor(instanceMatLoc + i, 1);
+        }
+    }
+}
+
+// Get the mesh key, including the VBO layout. Returns false if the mesh cannot be shared.
+bool GlGeomBase::GetFullMeshKey(GlGeomMeshKey* key) const
+{
+    *key = GlGeomMeshKey();
+    if (!GetMeshGenerator()->GetMeshKey(key)) {
+        return false;
+    }
+    key->stride = StrideVal();
+    key->normalOffset = UseNormals() ? NormalOffset() : -1;
+    key->texOffset = UseTexCoords() ? TexOffset() : -1;
+    key->vertexFormat = vertexFormat.Code();
+    key->numLodLevels = numLodLevels;
+    key->cacheOptimized = optimizeVertexCache ? 1 : 0;
+    key->triangleStrips = triangleStrips ? 1 : 0;
+    return true;
+}
+
+// Set theVBO and theEBO for the current mesh and layout.
+//    Returns true if the VBO and EBO still need to be allocated and calculated;
+//    returns false if they are shared and have already been loaded.
+bool GlGeomBase::AcquireMeshBuffers()
+{
+    GlGeomMeshKey key;
+    bool shareable = GetFullMeshKey(&key);
+    if (!shareable) {
+        if (sharedMesh) {
+            ReleaseMeshBuffers();
+        }
+        if (theVBO == 0) {
+            glGenBuffers(1, &theVBO);
+            glGenBuffers(1, &theEBO);
+        }
+        return true;
+    }
+    if (sharedMesh && key == meshKey) {
+        return false;           // Already holding this mesh
+    }
 
-    CalcVBOandEBO_Base();
+    ReleaseMeshBuffers();
+    GlGeomMeshRegistry& registry = TheMeshRegistry();
+    GlGeomMeshRegistry::iterator it = registry.find(key);
+    sharedMesh = true;
+    meshKey = key;
+    if (it != registry.end()) {
+        it->second.refCount++;
+        theVBO = it->second.VBO;
+        theEBO = it->second.EBO;
+        return false;
+    }
+    glGenBuffers(1, &theVBO);
+    glGenBuffers(1, &theEBO);
+    GlGeomSharedMesh newMesh = { theVBO, theEBO, 1 };
+    registry[key] = newMesh;
+    return true;
+}
+
+// Give up this object's use of theVBO and theEBO.
+//    They are deleted once no other object is using them.
+void GlGeomBase::ReleaseMeshBuffers()
+{
+    if (theVBO == 0) {
+        return;
+    }
+    if (sharedMesh) {
+        sharedMesh = false;
+        GlGeomMeshRegistry& registry = TheMeshRegistry();
+        GlGeomMeshRegistry::iterator it = registry.find(meshKey);
+        assert(it != registry.end());
+        if (--(it->second.refCount) > 0) {
+            theVBO = 0;
+            theEBO = 0;
+            return;             // Still in use by another object
+        }
+        registry.erase(it);
+    }
+    glDeleteBuffers(1, &theVBO);
+    glDeleteBuffers(1, &theEBO);
+    theVBO = 0;
+    theEBO = 0;
 }
 
 // Load the data into the VBO and EBO arrays.
-// This invokes the appropriate CalVBOandEBO method
-void GlGeomBase::CalcVBOandEBO_Base() {
+// This invokes the appropriate CalVBOandEBO method, for each level of detail.
+void GlGeomBase::CalcVBOandEBO_Base(GlGeomMeshBuilder& builder) {
 
 	// Calculate the buffer data - map and the unmap the two buffers.
     glBindVertexArray(theVAO);
     glBindBuffer(GL_ARRAY_BUFFER, theVBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
-    float* VBOdata = (float*)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-    unsigned int* EBOdata = (unsigned int*)glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
-    int normalOffset = UseNormals() ? NormalOffset() : -1;
-    int tcOffset = UseTexCoords() ? TexOffset() : -1;
-    CalcVboAndEbo(VBOdata, EBOdata, 0, normalOffset, tcOffset, StrideVal());
+    void* VBOdata = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+    void* EBOdata = glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
+    builder.Build(VBOdata, EBOdata);
     glUnmapBuffer(GL_ARRAY_BUFFER);
     glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
  
@@ -103,13 +323,111 @@ void GlGeomBase::PreRender() {
     }
  }
 
+// **********************************************
+// Bring the VBO and EBO up to date after the mesh has changed (by a Remesh).
+//   If wait is false, and the new mesh must be calculated, the calculation is
+//     done on a worker thread and this returns false. Until it returns true,
+//     Render() keeps rendering the previously loaded mesh.
+//   If wait is true, the mesh is brought up to date before returning true.
+// This must be called on the OpenGL thread.
+// **********************************************
+bool GlGeomBase::UpdateMesh(bool wait)
+{
+    GlGeomMeshKey key;
+    bool shareable = GetFullMeshKey(&key);
+    if (remeshJob != 0) {
+        if (!wait && !remeshJob->IsReady()) {
+            return false;
+        }
+        remeshJob->done.get();
+        if (shareable && remeshJob->key == key) {
+            LoadRemeshJob();
+            return true;
+        }
+        delete remeshJob;           // Out of date: Remesh was called again
+        remeshJob = 0;
+    }
+
+    GlGeomMeshGenerator* generator = (shareable && !wait) ? GetMeshGenerator()->NewMeshGenerator() : 0;
+    if (generator == 0 || TheMeshRegistry().count(key) != 0) {
+        // Synchronous remesh. (This is cheap if the mesh is already loaded in shared buffers.)
+        delete generator;
+        ReInitializeAttribLocations();
+        return true;
+    }
+    StartRemeshJob(generator, key);
+    return false;
+}
+
+// Start calculating the VBO and EBO data on a worker thread.
+//   The staging memory is allocated here, so the worker only writes into it.
+void GlGeomBase::StartRemeshJob(const GlGeomMeshGenerator* generator, const GlGeomMeshKey& key)
+{
+    assert(remeshJob == 0);
+    GlGeomRemeshJob* job = new GlGeomRemeshJob;
+    job->key = key;
+    job->generator = generator;
+    job->builder = new GlGeomMeshBuilder(generator, GetMeshOptions(*this));
+    job->VBOdata.resize(job->builder->GetVBOSize());
+    job->EBOdata.resize(job->builder->GetEBOSize());
+    job->done = std::async(std::launch::async, [job]() {
+        job->builder->Build(job->VBOdata.data(), job->EBOdata.data());
+    });
+    remeshJob = job;
+}
+
+// Load the finished background remesh into the VBO and EBO, and swap them in.
+//   The old VBO and EBO are released (and deleted unless shared).
+void GlGeomBase::LoadRemeshJob()
+{
+    bool needsLoad = AcquireMeshBuffers();
+    glBindVertexArray(theVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, theVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
+    if (needsLoad) {
+        glBufferData(GL_ARRAY_BUFFER, remeshJob->VBOdata.size(),
+            remeshJob->VBOdata.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, remeshJob->EBOdata.size(),
+            remeshJob->EBOdata.data(), GL_STATIC_DRAW);
+    }
+    SetVertexAttribPointers();
+    SetLoadedLayout(*remeshJob->builder);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    delete remeshJob;
+    remeshJob = 0;
+}
+
 // **********************************************
 // This routine does the rendering.
 //     The entire object is rendered (as loaded in the EBO).
 // **********************************************
 void GlGeomBase::Render()
 {
-    RenderEBO(GL_TRIANGLES, GetNumElementsRender(), 0);
+    RenderEBO(GetDrawMode(), lodLevels[0].numElements, 0);
+}
+
+unsigned int GlGeomBase::GetDrawMode() const
+{
+    return stripsLoaded ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+}
+
+// Triangle strips are separated by restart indices. Primitive restart is only
+//    enabled while drawing, so it does not affect other rendering.
+void GlGeomBase::EnablePrimitiveRestart(bool enable)
+{
+    if (!stripsLoaded) {
+        return;
+    }
+    if (enable) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(GlGeomMeshGenerator::GetRestartIndex(shortIndices));
+    }
+    else {
+        glDisable(GL_PRIMITIVE_RESTART);
+    }
 }
 
 // **********************************************
@@ -121,11 +439,192 @@ void GlGeomBase::RenderEBO(unsigned int drawMode, int numRenderElements, int EBO
     if (theVAO == 0) {
         assert(false && "InitializeAttribLocations must be called before rendering!");
     }
+    assert(!reorderedLoaded || IsWholeLevel(numRenderElements, EBOstart));
     glBindVertexArray(theVAO);
-    glDrawElements(drawMode, (GLsizei)numRenderElements, GL_UNSIGNED_INT, (void*)(EBOstart * sizeof(unsigned int)));
+    EnablePrimitiveRestart(true);
+    glDrawElements(drawMode, (GLsizei)numRenderElements, GetIndexType(), (void*)(EBOstart * (size_t)GetIndexSize()));
+    EnablePrimitiveRestart(false);
     glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
 }
 
+// Same, for elements numbered relative to baseVertex (e.g., a coarser level of detail)
+void GlGeomBase::RenderEBO(unsigned int drawMode, int numRenderElements, int EBOstart, int baseVertex)
+{
+    if (baseVertex == 0) {
+        RenderEBO(drawMode, numRenderElements, EBOstart);
+        return;
+    }
+    glBindVertexArray(theVAO);
+    EnablePrimitiveRestart(true);
+    glDrawElementsBaseVertex(drawMode, (GLsizei)numRenderElements, GetIndexType(),
+        (void*)(EBOstart * (size_t)GetIndexSize()), baseVertex);
+    EnablePrimitiveRestart(false);
+    glBindVertexArray(0);
+}
+
+// **********************************************
+// Render the entire object at the level of detail chosen by its size on the screen.
+//   modelviewMatrix is the modelview matrix used for rendering (16 floats, column order)
+// **********************************************
+void GlGeomBase::RenderLod(const float* modelviewMatrix)
+{
+    const GlGeomLodLevel& level = lodLevels[SelectLodLevel(modelviewMatrix)];
+    RenderEBO(GetDrawMode(), level.numElements, level.firstElement, level.firstVertex);
+}
+
+// Choose the level of detail from the projected radius of the bounding sphere, in pixels.
+int GlGeomBase::SelectLodLevel(const float* mv) const
+{
+    if (numLodLevelsLoaded <= 1 || lodProjScale <= 0.0f) {
+        return 0;
+    }
+    // Radius after the modelview transformation: use the largest scaling of the three axes.
+    float scaleSq = Max(mv[0] * mv[0] + mv[1] * mv[1] + mv[2] * mv[2],
+                    Max(mv[4] * mv[4] + mv[5] * mv[5] + mv[6] * mv[6],
+                        mv[8] * mv[8] + mv[9] * mv[9] + mv[10] * mv[10]));
+    float radius = GetMeshGenerator()->GetBoundingRadius() * sqrtf(scaleSq);
+    float pixelRadius = radius * lodProjScale;
+    if (lodPerspective) {
+        float distance = -mv[14];       // Distance along the negative z-axis
+        if (distance <= radius) {
+            return 0;                   // Very close to (or behind) the viewer
+        }
+        pixelRadius /= distance;
+    }
+    int level = 0;
+    for (float switchRadius = LodSwitchRadius; level < numLodLevelsLoaded - 1 && pixelRadius < switchRadius; switchRadius *= 0.5f) {
+        level++;
+    }
+    return level;
+}
+
+// projectionMatrix is 16 floats in column order. Only the y scaling factor is needed,
+//    and whether the projection is perspective.
+void GlGeomBase::SetLodProjection(const float* projectionMatrix, int viewportHeight)
+{
+    lodPerspective = (projectionMatrix[11] != 0.0f);
+    lodProjScale = 0.5f * (float)viewportHeight * fabsf(projectionMatrix[5]);
+}
+
+// Once the EBO triangles are reordered, only whole levels of detail can be rendered.
+bool GlGeomBase::IsWholeLevel(int numRenderElements, int EBOstart) const
+{
+    for (int i = 0; i < numLodLevelsLoaded; i++) {
+        if (lodLevels[i].firstElement == EBOstart && lodLevels[i].numElements == numRenderElements) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GlGeomBase::SetVertexFormat(const GlGeomVertexFormat& format)
+{
+    if (format.Code() == vertexFormat.Code()) {
+        return;
+    }
+    vertexFormat = format;
+    if (theVAO != 0) {
+        ReInitializeAttribLocations();      // Rebuild the VBO in the new format
+    }
+}
+
+void GlGeomBase::SetOptimizeVertexCache(bool optimize)
+{
+    if (optimize == optimizeVertexCache) {
+        return;
+    }
+    optimizeVertexCache = optimize;
+    if (theVAO != 0) {
+        ReInitializeAttribLocations();      // Rebuild the EBO
+    }
+}
+
+// The elements are calculated as for the loaded VBO layout, but into temporary arrays.
+void GlGeomBase::CalcVertexCacheAcmr(float* acmrBefore, float* acmrAfter, int cacheSize, GlGeomCacheModel model)
+{
+    const GlGeomMeshGenerator* mesh = GetMeshGenerator();
+    int numVertices = UseTexCoords() ? mesh->GetNumVerticesTexCoords() : mesh->GetNumVerticesNoTexCoords();
+    std::vector<float> VBOdata(StrideVal() * numVertices);
+    std::vector<unsigned int> elements(mesh->GetNumElementsMax());
+    mesh->CalcVboAndEbo(VBOdata.data(), elements.data(), 0, UseNormals() ? NormalOffset() : -1,
+        UseTexCoords() ? TexOffset() : -1, StrideVal());
+    int numElements = mesh->GetNumElementsRender();
+    *acmrBefore = GlGeomCalcAcmr(elements.data(), numElements, cacheSize, model);
+    GlGeomOptimizeVertexCache(elements.data(), numElements, numVertices, cacheSize);
+    *acmrAfter = GlGeomCalcAcmr(elements.data(), numElements, cacheSize, model);
+}
+
+void GlGeomBase::SetTriangleStrips(bool useStrips)
+{
+    if (useStrips == triangleStrips) {
+        return;
+    }
+    triangleStrips = useStrips;
+    if (theVAO != 0) {
+        ReInitializeAttribLocations();      // Rebuild the EBO
+    }
+}
+
+void GlGeomBase::SetNumLodLevels(int numLevels)
+{
+    numLevels = ClampRange(numLevels, 1, GlGeomMaxLodLevels);
+    if (numLevels == numLodLevels) {
+        return;
+    }
+    numLodLevels = numLevels;
+    if (theVAO != 0) {
+        ReInitializeAttribLocations();      // Rebuild the VBO and EBO with the levels of detail
+    }
+}
+
+// **********************************************
+// These routines do instanced rendering: one draw call for all the instances.
+//   The instance buffer holds one matrix (16 floats, column order) per instance.
+//   The attribute pointers are only re-specified when a different instance buffer is used.
+// **********************************************
+void GlGeomBase::RenderInstanced(int instanceCount, unsigned int instanceBuffer)
+{
+    RenderEBOInstanced(GetDrawMode(), lodLevels[0].numElements, 0, instanceCount, instanceBuffer);
+}
+
+void GlGeomBase::RenderEBOInstanced(unsigned int drawMode, int numRenderElements, int EBOstart,
+    int instanceCount, unsigned int instanceBuffer)
+{
+    if (theVAO == 0) {
+        assert(false && "InitializeAttribLocations must be called before rendering!");
+    }
+    assert(UseInstancing() && "InitializeAttribLocations must be given an instance matrix location!");
+    glBindVertexArray(theVAO);
+    AttachInstanceBuffer(instanceBuffer);
+    EnablePrimitiveRestart(true);
+    glDrawElementsInstanced(drawMode, (GLsizei)numRenderElements, GetIndexType(),
+        (void*)(EBOstart * (size_t)GetIndexSize()), (GLsizei)instanceCount);
+    EnablePrimitiveRestart(false);
+    glBindVertexArray(0);
+}
+
+// Link the instance buffer to the instance matrix locations. The VAO must already be bound.
+void GlGeomBase::AttachInstanceBuffer(unsigned int instanceBuffer)
+{
+    if (instanceBuffer == instanceVBO) {
+        return;         // Already attached (the VAO remembers this)
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    const int stride = InstanceFloats * sizeof(float);
+    for (unsigned int i = 0; i < 4; i++) {
+        glVertexAttribPointer(instanceMatLoc + i, 4, GL_FLOAT, GL_FALSE, stride,
+            (void*)(4 * i * sizeof(float)));
+        glEnableVertexAttribArray(instanceMatLoc + i);
+    }
+    for (unsigned int i = 0; i < 3; i++) {
+        glVertexAttribPointer(instanceMatLoc + 4 + i, 3, GL_FLOAT, GL_FALSE, stride,
+            (void*)((16 + 3 * i) * sizeof(float)));
+        glEnableVertexAttribArray(instanceMatLoc + 4 + i);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    instanceVBO = instanceBuffer;
+}
+
 // **********************************************
 // This routine does the rendering of the specified elements
 //    A temporary EBO is created for this purpose
@@ -149,7 +648,11 @@ void GlGeomBase::RenderElements(unsigned int drawMode, int numRenderElements, co
 
 GlGeomBase::~GlGeomBase()
 {
-    glDeleteBuffers(3, &theVAO);  // The three buffer id's are contigous in memory!
+    delete remeshJob;               // Waits for the worker thread, if still running
+    ReleaseMeshBuffers();
+    if (theVAO != 0) {
+        glDeleteVertexArrays(1, &theVAO);
+    }
 }
 
 
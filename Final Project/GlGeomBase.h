@@ -29,18 +29,40 @@
 
 #include <limits.h>
 #include <assert.h>
+#include "GlGeomMeshGenerator.h"
+#include "GlGeomVertexCache.h"
+#include "GlGeomVertexFormat.h"
 
 // GlGeomBase
 //     Handles all the OpenGL rendering for the GlGeomShape classes.
 // Supports the following:
 //    (1) Allocating a VAO, VBO, and EBO
 //    (2) Doing the rendering with OpenGL
+//    (3) Sharing one VBO and EBO among all objects with identical mesh data.
+//        The VBO and EBO are reference counted, and are only calculated once.
+//    (4) Remeshing in the background: after a Remesh(), the new VBO and EBO
+//        data are calculated on a worker thread while the old mesh is still
+//        rendered, and are then loaded into new buffers on the OpenGL thread.
+//    (5) Levels of detail (LOD): optionally, coarser versions of the mesh, with
+//        the resolution halved at each level, are packed into the same VBO and EBO.
+//        RenderLod() chooses the level from the size of the object on the screen.
+//    (6) 16-bit indices: the EBO holds unsigned shorts whenever the number of
+//        vertices allows, and unsigned ints otherwise.
+//    (7) Vertex cache optimization: optionally, the triangles in the EBO are
+//        reordered for better reuse of transformed vertices (see GlGeomVertexCache.h).
+//    (8) Compact vertex formats: normals and texture coordinates (and optionally
+//        positions) can be stored in packed formats (see GlGeomVertexFormat.h).
+//    (9) Triangle strips: optionally, the EBO holds triangle strips separated by
+//        primitive restart indices, and each level is still rendered with one draw call.
+
+struct GlGeomRemeshJob;     // Defined in GlGeomBase.cpp
+class GlGeomMeshBuilder;    // See GlGeomMeshBuilder.h
 
 class GlGeomBase
 {
 public:
     GlGeomBase() {}
-    ~GlGeomBase();
+    virtual ~GlGeomBase();
 
     // Disable all copy and assignment operators for a GlGeomBase object.
     //     If you need to pass it to/from a function, use references or pointers
@@ -50,51 +72,58 @@ public:
     GlGeomBase(GlGeomBase&&) = delete;
     GlGeomBase& operator=(GlGeomBase&&) = delete;
 
-    // These must be implemented in each GlGeomShape class.
-    //   GetNumElements() returns the number of elements in the EBO for rendering
-    //   Alternately, GetNumElementsMax() and GetNumElementsRender() can be defined.
-    //   GetNumElementsMax() returns an upper bound on the number of elements in the EBO (for allocation)
-    //   GetNumElementsRender() returns the actual number of elements in the EBO (for rendering)
-    //   GetNumVerticesTexCoords() returns the number of vertices when there are texture coordinates
-    //   GetNumVerticesNoTexCoords() returns the number of vertices when no texture coordinates
-    virtual int GetNumElements() const { assert(false); return -1; };
-    virtual int GetNumElementsMax() const { return GetNumElements(); }
-    virtual int GetNumElementsRender() const { return GetNumElements(); }
-    virtual int GetNumVerticesTexCoords() const = 0;
-    virtual int GetNumVerticesNoTexCoords() const = 0;
+    static const int InstanceFloats = 25;   // Floats per instance in an instance buffer (see RenderInstanced)
+
+    // GetMeshGenerator must be implemented in each GlGeomShape class. It returns the
+    //    object calculating the VBO and EBO data (see GlGeomMeshGenerator.h);
+    //    the GlGeomShape classes derive from their mesh generator, and return themselves.
+    virtual const GlGeomMeshGenerator* GetMeshGenerator() const = 0;
 
     unsigned int GetVAO() const { return theVAO; }
     unsigned int GetVBO() const { return theVBO; }
     unsigned int GetEBO() const { return theEBO; }
+    // The type of the indices in the EBO: GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    unsigned int GetIndexType() const;
+    int GetIndexSize() const { return shortIndices ? sizeof(unsigned short) : sizeof(unsigned int); }
+
+    // Levels of detail (LOD).
+    //   SetNumLodLevels sets the number of levels (1 to GlGeomMaxLodLevels) to build. The default is 1.
+    //       It is more efficient to call it before InitializeAttribLocations.
+    //   SelectLodLevel returns the level to use for the given modelview matrix (16 floats, column order):
+    //       Level 0 is used while the projected radius is at least LodSwitchRadius pixels.
+    //       Each further level is used when the projected radius is halved again.
+    //   SetLodProjection must be called whenever the projection matrix or viewport changes.
+    void SetNumLodLevels(int numLevels);
+    int GetNumLodLevels() const { return numLodLevels; }
+    int SelectLodLevel(const float* modelviewMatrix) const;
+    static void SetLodProjection(const float* projectionMatrix, int viewportHeight);
+    static float LodSwitchRadius;
+
+    // Post-transform vertex cache optimization.
+    //   SetOptimizeVertexCache(true) reorders the triangles of each level of detail once,
+    //       after they are generated. The default is false.
+    //       The partial render routines (RenderSlice, RenderRing, etc.) need the
+    //       original order, and cannot be used with the optimization.
+    //   CalcVertexCacheAcmr reports the average cache miss ratio of the mesh (level 0)
+    //       before and after the optimization, on a simulated FIFO or LRU cache.
+    //       It recalculates the mesh, and does not use OpenGL.
+    void SetOptimizeVertexCache(bool optimize);
+    bool GetOptimizeVertexCache() const { return optimizeVertexCache; }
+    void CalcVertexCacheAcmr(float* acmrBefore, float* acmrAfter,
+        int cacheSize = GlGeomDefaultCacheSize, GlGeomCacheModel model = GlGeomCacheFIFO);
 
-    // The routine CalcVboAndEbo must be implemented for all GlGeomShape classes, 
-    //    but is meant for internal use, and is not usually called by the user.
-    // It is called from the constructor or a ReMesh() or Render() method
-    //         via a call to InitializeAttribLocations. It takes as input:
-    //    * Pointers to the VBO buffer and EBO buffer. Typically these
-    //      are allocated earlier by InitializeAttribLocations
-    //    * Layout of data in the VBO:  offsets for the vertex position,
-    //          the normal and the texture coordinates (if used),
-    //          and the stride value.
-    // Inputs:
-    //   VBOdataBuffer - pointer to the VBO buffer (mapped to memory)
-    //   EBOdataBuffer - pointer to the EBO buffer (mapped to memory)
-    //       - The VBO and EBO buffersare filled with the vertex info and elements for GL_TRIANGLES drawing
-    //   vertPosOffset and stride control where the vertex positions are placed.
-    //   vertNormalOffset and stride control where the vertex normals are placed.
-    //   vertTexCoordsOffset and stride control where the texture coordinates are placed.
-    //   Offset and stride values are **integers** (not bytes), measuring offsets in terms of floats.
-    //   Use "-1" for the offset for any value which should be omitted.
-    //   For the (unit) sphere, the normals are always exactly equal to the positions.
-    // Output: 
-    //   Data VBO and EBO data is calculated and loaded into the two buffers VBOdataBuffer and EBOdataBuffer.
-    // Typical usages are:
-    //   CalcVboAndEbo( vboPtr, eboPtr, 0, -1, -1, 3); // positions only, tightly packed
-    //   CalcVboAndEbo( vboPtr, eboPtr, 0, -1, 3, 5); // positions, then (s,t) texture coords, tightly packed
-    //   CalcVboAndEbo( vboPtr, eboPtr, 0, 3, 6, 8); // positions, normals, then (s,t) texture coords, tightly packed
-    virtual void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
-            int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
-            unsigned int stride) = 0;
+    // The vertex format in the VBO. The default stores everything as floats.
+    //    E.g., SetVertexFormat(GlGeomVertexFormat::Compact()) packs the normals and
+    //    texture coordinates. The shaders need no changes.
+    void SetVertexFormat(const GlGeomVertexFormat& format);
+    const GlGeomVertexFormat& GetVertexFormat() const { return vertexFormat; }
+
+    // Triangle strips. SetTriangleStrips(true) builds the EBO as triangle strips joined by
+    //    primitive restart indices, if the shape supports it. This needs about 2.5 to 3 times
+    //    fewer indices than GL_TRIANGLES. The default is false.
+    //    The vertex cache optimization is not applied to triangle strips.
+    void SetTriangleStrips(bool useStrips);
+    bool GetTriangleStrips() const { return triangleStrips; }
 
 protected:
     // Allocate the VAO, VBO, and EBO.
@@ -104,15 +133,35 @@ protected:
     // Second parameter is the location for the vertex normal vector in the shader program.
     // Third parameter is the location for the vertex 2D texture coordinates in the shader program.
     // The second and third parameters are optional.
+    // The fourth (optional) parameter is the first of seven consecutive locations for a
+    //    per-instance mat4 and its normal matrix (a mat3) in the shader program.
+    //    It is only used by RenderInstanced().
     virtual void InitializeAttribLocations(
-        unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX);
+        unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX,
+        unsigned int instanceMat_loc = UINT_MAX);
     void ReInitializeAttribLocations();
-    void CalcVBOandEBO_Base();
+    void CalcVBOandEBO_Base(GlGeomMeshBuilder& builder);
 
     void PreRender();
+    bool UpdateMesh(bool wait);
     void Render(); 
     void RenderElements(unsigned int drawMode, int numRenderElements, const unsigned int *elementsData);
     void RenderEBO(unsigned int drawMode, int numRenderElements, int EBOstart);
+    void RenderEBO(unsigned int drawMode, int numRenderElements, int EBOstart, int baseVertex);
+    void RenderLod(const float* modelviewMatrix);
+    // The draw mode for the loaded EBO: GL_TRIANGLE_STRIP or GL_TRIANGLES.
+    //   Partial render routines (RenderSlice, etc.) must use the matching layout of the EBO.
+    unsigned int GetDrawMode() const;
+    bool TriangleStripsLoaded() const { return stripsLoaded; }
+
+    // Instanced rendering: draws instanceCount copies of the object with a single draw call.
+    //   instanceBuffer is a VBO holding InstanceFloats (25) floats per instance: a 4x4 matrix
+    //   as 16 floats in column order (as given by LinearMapR4::DumpByColumns), followed by
+    //   its normal matrix as 9 floats (as given by LinearMapR4f::NormalMatrices).
+    //   Requires that InitializeAttribLocations was given an instanceMat_loc.
+    void RenderInstanced(int instanceCount, unsigned int instanceBuffer);
+    void RenderEBOInstanced(unsigned int drawMode, int numRenderElements, int EBOstart,
+        int instanceCount, unsigned int instanceBuffer);
 
 private:
     unsigned int theVAO = 0;        // Vertex Array Object
@@ -122,17 +171,55 @@ private:
     unsigned int posLoc;            // location of vertex position x,y,z data in the shader program
     unsigned int normalLoc;         // location of vertex normal data in the shader program
     unsigned int texcoordsLoc;      // location of s,t texture coordinates in the shader program.
+    unsigned int instanceMatLoc = UINT_MAX;   // location of the per-instance matrix (uses 4 locations, then 3 for the normal matrix)
+    unsigned int instanceVBO = 0;   // The instance buffer currently attached to the VAO (0 if none)
+
+    void AttachInstanceBuffer(unsigned int instanceBuffer);
+
+    bool sharedMesh = false;        // true if theVBO and theEBO are in the shared mesh registry
+    GlGeomMeshKey meshKey;          // Key for theVBO and theEBO (valid only if sharedMesh is true)
+
+    bool GetFullMeshKey(GlGeomMeshKey* key) const;
+    bool AcquireMeshBuffers();
+    void ReleaseMeshBuffers();
+    void SetVertexAttribPointers();
+
+    GlGeomRemeshJob* remeshJob = 0; // Background remesh in progress (0 if none)
+
+    int numLodLevels = 1;           // Number of levels of detail to build
+    int numLodLevelsLoaded = 0;     // Number of levels of detail in the loaded VBO and EBO
+    GlGeomLodLevel lodLevels[GlGeomMaxLodLevels];   // The levels of detail in the loaded VBO and EBO
+    bool shortIndices = false;      // true if the loaded EBO has 16-bit indices
+    bool optimizeVertexCache = false;   // Reorder the EBO triangles for the vertex cache
+    GlGeomVertexFormat vertexFormat;    // How the vertices are stored in the VBO
+    bool triangleStrips = false;    // Build the EBO as triangle strips
+    bool stripsLoaded = false;      // true if the loaded EBO holds triangle strips
+    bool reorderedLoaded = false;   // true if the loaded EBO was reordered for the vertex cache
+    void EnablePrimitiveRestart(bool enable);
+    bool IsWholeLevel(int numRenderElements, int EBOstart) const;
+
+    static float lodProjScale;      // Converts radius/distance to pixels (0 until SetLodProjection is called)
+    static bool lodPerspective;     // true for a perspective projection, false for orthographic
+
+    void SetLoadedLayout(const GlGeomMeshBuilder& builder);
+
+    void StartRemeshJob(const GlGeomMeshGenerator* generator, const GlGeomMeshKey& key);
+    void LoadRemeshJob();
 
 public:
-    // Stride value, and offset values for the data in the VBO
+    // Stride value, and offset values for the float data calculated by CalcVboAndEbo
+    //    (this is also the VBO layout for the default vertex format).
     // These take into account whether normals and texture coordinates are used.
     bool UseNormals() const { return normalLoc != UINT_MAX; }
     bool UseTexCoords() const { return texcoordsLoc != UINT_MAX; }
+    bool UseInstancing() const { return instanceMatLoc != UINT_MAX; }
     int StrideVal() const {
         return 3 + (UseNormals() ? 3 : 0) + (UseTexCoords() ? 2 : 0);
     }
     int NormalOffset() const { return 3; }
     int TexOffset() const { return 3 + (UseNormals() ? 3 : 0); }
+    // Bytes per vertex in the VBO (equal to StrideVal()*sizeof(float) for the default vertex format)
+    int VertexSize() const { return vertexFormat.VertexSize(UseNormals(), UseTexCoords()); }
 };
 
 #endif  // GLGEOM_BASE_H
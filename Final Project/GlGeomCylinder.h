@@ -23,6 +23,7 @@
 #define GLGEOM_CYLINDER_H
 
 #include "GlGeomBase.h"
+#include "GlGeomCylinderMesh.h"
 #include <limits.h>
 
 // GlGeomCylinder
@@ -44,7 +45,7 @@
 //            commands for the cylinder using the VAO, VBO and EBO.
 
 
-class GlGeomCylinder : public GlGeomBase
+class GlGeomCylinder : public GlGeomBase, public GlGeomCylinderMesh
 {
 public:
     GlGeomCylinder() : GlGeomCylinder(3, 1, 1) {}
@@ -53,6 +54,8 @@ public:
 	// Remesh() - Re-mesh to change the number slices and stacks and rings.
     // Can be called either before or after InitializeAttribLocations(), but it is
     //    more efficient if Remesh() is called first, or if the constructor sets the mesh resolution.
+    // Once the VBO and EBO are loaded, the new mesh is calculated on a worker thread,
+    //    and Render() keeps rendering the old mesh until the new mesh is ready.
     void Remesh(int slices, int stacks, int rings);
 
 	// Allocate the VAO, VBO, and EBO.
@@ -62,41 +65,24 @@ public:
     // Second parameter is the location for the vertex normal vector in the shader program.
     // Third parameter is the location for the vertex 2D texture coordinates in the shader program.
     // The second and third parameters are optional.
+    // The optional fourth parameter is the location for a per-instance matrix (see RenderInstanced).
     void InitializeAttribLocations(
-		unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX);
+		unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX,
+        unsigned int instanceMat_loc = UINT_MAX);
 
     void Render();          // Render: renders entire cylinder
+    void RenderInstanced(int instanceCount, unsigned int instanceBuffer);  // See GlGeomBase.h
+    // Render the cylinder at the level of detail chosen by its size on the screen.
+    //   See SetNumLodLevels and SetLodProjection in GlGeomBase.h
+    void RenderLod(const float* modelviewMatrix);
     void RenderTop();
     void RenderBase();
     void RenderSide();
 
-    int GetNumSlices() const { return numSlices; }
-    int GetNumStacks() const { return numStacks; }
-    int GetNumRings() const { return numRings; }
-    
-    // Use GetNumElements() and GetNumVerticesTexCoords() and GetNumVerticesNoTexCoords()
-    //    to determine the amount of data that will returned by CalcVboAndEbo.
-    //    Numbers are different since texture coordinates must be assigned differently
-    //        to some vertices depending on which triangle they appear in.
-    int GetNumElements() const { return 2 * GetNumElementsDisk() + GetNumElementsSide(); }
-    int GetNumVerticesTexCoords() const { return 2 * GetNumVerticesDisk() + GetNumVerticesSideTexCoords(); }
-    int GetNumVerticesNoTexCoords() const { return 2 * GetNumVerticesDisk() + GetNumVerticesSideNoTexCoords(); }
-
-    // "Disk" methods are for the bottom or top circular face.  "Side" for the cylinder's side
-    int GetNumElementsDisk() const { return 3 * (2 * numRings - 1)*numSlices; }
-    int GetNumVerticesDisk() const { return 1 + numRings * numSlices; }
-    int GetNumElementsSide() const { return 6 * numStacks*numSlices; }
-    int GetNumVerticesSideTexCoords() const { return (numStacks + 1)*(numSlices + 1); }
-    int GetNumVerticesSideNoTexCoords() const { return (numStacks + 1)*numSlices; }
-
-    // CalcVboAndEbo- return all VBO vertex information, and EBO elements for GL_TRIANGLES drawing.
-    // See GlGeomBase.h for additional information
-    void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
-        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
-        unsigned int stride);
-
-private: 
+    // The VBO and EBO data are calculated by the GlGeomCylinderMesh base class.
+    const GlGeomMeshGenerator* GetMeshGenerator() const { return this; }
 
+private:
     // Disable all copy and assignment operators.
     // A GlGeomCylinder can be allocated as a global or static variable, or with new.
     //     If you need to pass it to/from a function, use references or pointers
@@ -107,27 +93,16 @@ private:
     GlGeomCylinder& operator=(GlGeomCylinder&&) = delete;
 
 
-private:
-    int numSlices;          // Number of radial slices (like cake slices
-    int numStacks;          // Number of stacks between the two end faces
-    int numRings;           // Number of concentric rings on two end faces
-
-
 private: 
     bool VboEboLoaded = false;
 
-    void PreRender();
-
-    void SetDiscVerts(float x, float z, int i, int j, float* VBOdataBuffer,
-        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, int stride);
+    void PreRender(bool waitForMesh = true);
  };
 
 // Constructor
 inline GlGeomCylinder::GlGeomCylinder(int slices, int stacks, int rings)
+    : GlGeomCylinderMesh(slices, stacks, rings)
 {
-	numSlices = slices;
-	numStacks = stacks;
-    numRings = rings;
 }
 
 #endif  // GLGEOM_CYLINDER_H
@@ -0,0 +1,248 @@
+/*
+* GlGeomCylinderMesh.cpp
+*
+* Calculates the VBO and EBO data for a cylinder, without OpenGL.
+*   See GlGeomCylinderMesh.h.
+*/
+
+#include "GlGeomCylinderMesh.h"
+#include "MathMisc.h"
+#include "assert.h"
+#include <vector>
+
+template<class IndexType>
+void GlGeomCylinderMesh::CalcVboAndEboT(float* VBOdataBuffer, IndexType* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    assert(vertPosOffset >= 0 && stride > 0);
+    bool calcNormals = (vertNormalOffset >= 0);       // Should normals be calculated?
+    bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
+
+    // VBO Data is laid out: top face vertices, then bottom face vertices, then side vertices
+
+    // Set top and bottom center vertices
+    SetDiscVerts(0.0, 0.0, 0, 0, VBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+    int stopSlices = calcTexCoords ? numSlices : numSlices - 1;
+    // theta measures from the negative z-axis, counterclockwise viewed from above.
+    //    The last slice is the seam, the same as the first.
+    std::vector<float> cosTheta(numSlices + 1);
+    std::vector<float> sinTheta(numSlices + 1);
+    SinCosSequence(0.0, PI2 / (double)numSlices, numSlices, sinTheta.data(), cosTheta.data());
+    cosTheta[numSlices] = cosTheta[0];
+    sinTheta[numSlices] = sinTheta[0];
+    // Each slice writes its own disc and side vertices, so the slices may be calculated in parallel.
+    ParallelFor(stopSlices + 1, (2 * numRings + numStacks + 1) * stride, [&](int sliceBegin, int sliceEnd) {
+        for (int i = sliceBegin; i < sliceEnd; i++) {
+            // Handle a slice of vertices.
+            float c = -cosTheta[i];      // Negated values (start at negative z-axis)
+            float s = -sinTheta[i];
+            if (i < numSlices) {
+                // Top & bottom face vertices, positions and normals and texture coordinates
+                for (int j = 1; j <= numRings; j++) {
+                    float radius = (float)j / (float)numRings;
+                    SetDiscVerts(s * radius, c * radius, i, j, VBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+                }
+            }
+            float* basePtr = VBOdataBuffer + (2*GetNumVerticesDisk()+ i*(numStacks + 1))*stride;
+            float sCoord = ((float)i) / (float)(numSlices);
+            // Side vertices, positions and normals and texture coordinates
+            for (int j = 0; j <= numStacks; j++, basePtr+=stride) {
+                float* vPtr = basePtr + vertPosOffset;
+                float tCoord = (float)j / (float)numStacks;
+                *(vPtr++) = s;
+                *(vPtr++) = -1.0f + 2.0f*tCoord;
+                *vPtr = c;
+                if (calcNormals) {
+                    float* nPtr = basePtr + vertNormalOffset;
+                    *(nPtr++) = s;
+                    *(nPtr++) = 0.0f;
+                    *nPtr = c;
+                }
+                if (calcTexCoords) {
+                    float* tcPtr = basePtr + vertTexCoordsOffset;
+                    *(tcPtr++) = sCoord;
+                    *tcPtr = tCoord;
+                }
+            }
+        }
+    });
+    if (EBOdataBuffer == 0) {
+        return;     // VBO only
+    }
+
+    // EBO data is also laid out as base, the top, then sides
+    IndexType* eboPtr = EBOdataBuffer;
+    // Bottom 
+    for (int i = 0; i < numSlices; i++) {
+        int r = i*numRings + 1;
+        int rightR = ((i+1)%numSlices)*numRings + 1;
+        *(eboPtr++) = 0;
+        *(eboPtr++) = rightR;
+        *(eboPtr++) = r;
+        for (int j = 0; j < numRings-1; j++) {
+            *(eboPtr++) = r + j;
+            *(eboPtr++) = rightR + j;
+            *(eboPtr++) = rightR + j + 1;
+ 
+            *(eboPtr++) = r + j;
+            *(eboPtr++) = rightR + j + 1;
+            *(eboPtr++) = r + j + 1;
+        }
+    }
+    // Top 
+    int delta = GetNumVerticesDisk();
+    for (int i = 0; i < numSlices; i++) {
+        int r = delta + i*numRings + 1;
+        int leftR = delta + ((i + 1) % numSlices)*numRings + 1;
+        *(eboPtr++) = delta;
+        *(eboPtr++) = r;
+        *(eboPtr++) = leftR;
+        for (int j = 0; j < numRings-1; j++) {
+            *(eboPtr++) = leftR + j;
+            *(eboPtr++) = r + j;
+            *(eboPtr++) = r + j + 1;
+
+            *(eboPtr++) = leftR + j;
+            *(eboPtr++) = r + j + 1;
+            *(eboPtr++) = leftR + j + 1;
+        }
+    }
+    // Side
+    for (int i = 0; i < numSlices; i++) {
+        int r = i*(numStacks + 1) + 2*delta;
+        int ii = calcTexCoords ? (i + 1) : (i + 1) % numSlices;
+        int rightR = ii*(numStacks + 1) + 2*delta;
+        for (int j = 0; j < numStacks; j++) {
+            *(eboPtr++) = rightR + j;
+            *(eboPtr++) = r + j + 1;
+            *(eboPtr++) = r + j;
+
+            *(eboPtr++) = rightR + j;
+            *(eboPtr++) = rightR + j + 1;
+            *(eboPtr++) = r + j + 1;
+        }
+    }
+}
+
+// EBO data for GL_TRIANGLE_STRIP, laid out as base, the top, then sides.
+//    Each slice of each part is one strip, followed by a restart index.
+//    The base and top strips start at the center, then zigzag outward.
+template<class IndexType>
+void GlGeomCylinderMesh::CalcEboStripsT(IndexType* EBOdataBuffer, bool calcTexCoords) const
+{
+    IndexType restartIdx = (IndexType)GetRestartIndex(sizeof(IndexType) == sizeof(unsigned short));
+    IndexType* eboPtr = EBOdataBuffer;
+    // Bottom 
+    for (int i = 0; i < numSlices; i++) {
+        int r = i*numRings + 1;
+        int rightR = ((i + 1) % numSlices)*numRings + 1;
+        *(eboPtr++) = 0;
+        for (int j = 0; j < numRings; j++) {
+            *(eboPtr++) = rightR + j;
+            *(eboPtr++) = r + j;
+        }
+        *(eboPtr++) = restartIdx;
+    }
+    // Top 
+    int delta = GetNumVerticesDisk();
+    for (int i = 0; i < numSlices; i++) {
+        int r = delta + i*numRings + 1;
+        int leftR = delta + ((i + 1) % numSlices)*numRings + 1;
+        *(eboPtr++) = delta;
+        for (int j = 0; j < numRings; j++) {
+            *(eboPtr++) = r + j;
+            *(eboPtr++) = leftR + j;
+        }
+        *(eboPtr++) = restartIdx;
+    }
+    // Side
+    for (int i = 0; i < numSlices; i++) {
+        int r = i*(numStacks + 1) + 2*delta;
+        int ii = calcTexCoords ? (i + 1) : (i + 1) % numSlices;
+        int rightR = ii*(numStacks + 1) + 2*delta;
+        for (int j = 0; j <= numStacks; j++) {
+            *(eboPtr++) = r + j;
+            *(eboPtr++) = rightR + j;
+        }
+        *(eboPtr++) = restartIdx;
+    }
+    assert(eboPtr - EBOdataBuffer == GetNumElementsStrips());
+}
+
+// The 32-bit and 16-bit index versions of CalcVboAndEbo and CalcEboStrips
+void GlGeomCylinderMesh::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    CalcVboAndEboT(VBOdataBuffer, EBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+}
+
+void GlGeomCylinderMesh::CalcVboAndEbo(float* VBOdataBuffer, unsigned short* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    CalcVboAndEboT(VBOdataBuffer, EBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+}
+
+void GlGeomCylinderMesh::CalcEboStrips(unsigned int* EBOdataBuffer, bool calcTexCoords) const
+{
+    CalcEboStripsT(EBOdataBuffer, calcTexCoords);
+}
+
+void GlGeomCylinderMesh::CalcEboStrips(unsigned short* EBOdataBuffer, bool calcTexCoords) const
+{
+    CalcEboStripsT(EBOdataBuffer, calcTexCoords);
+}
+
+void GlGeomCylinderMesh::SetDiscVerts(float x, float z, int i, int j, float* VBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, int stride) const
+{
+    // i is the slice number, j is the ring number.
+    // j==0 means the center point.  In this case, i must equal 0. (Not checked)
+    float* basePtrBottom = VBOdataBuffer + stride*(i*numRings + j);
+    int delta = GetNumVerticesDisk()*stride;
+    float* vPtrBottom = basePtrBottom + vertPosOffset;
+    float* vPtrTop = vPtrBottom + delta;
+    *(vPtrBottom++) = x;
+    *(vPtrBottom++) = -1.0;
+    *vPtrBottom = z;
+    *(vPtrTop++) = x;
+    *(vPtrTop++) = 1.0;
+    *vPtrTop = z;
+    if (vertNormalOffset>=0) {
+        float* nPtrBottom = basePtrBottom + vertNormalOffset;
+        float* nPtrTop = nPtrBottom + delta;
+        *(nPtrBottom++) = 0.0;
+        *(nPtrBottom++) = -1.0;
+        *nPtrBottom = 0.0;
+        *(nPtrTop++) = 0.0;
+        *(nPtrTop++) = 1.0;
+        *nPtrTop = 0.0;
+    }
+    if (vertTexCoordsOffset>=0) {
+        float sCoord = 0.5f*(x + 1.0f);
+        float tCoord = 0.5f*(-z + 1.0f);
+        float* tcPtrBottom = basePtrBottom + vertTexCoordsOffset;
+        float* tcPtrTop = tcPtrBottom + delta;
+        *(tcPtrBottom++) = 1.0f - sCoord;
+        *tcPtrBottom = tCoord;
+        *(tcPtrTop++) = sCoord;
+        *tcPtrTop = tCoord;
+    }
+}
+
+
+// Identify the mesh data for sharing the VBO and EBO. See GlGeomMeshGenerator.h.
+bool GlGeomCylinderMesh::GetMeshKey(GlGeomMeshKey* key) const
+{
+    key->shapeType = GlGeomShapeCylinder;
+    key->resolution[0] = numSlices;
+    key->resolution[1] = numStacks;
+    key->resolution[2] = numRings;
+    key->shapeParam = 0.0f;
+    return true;
+}
+
+// The same shape, with the resolution halved lodLevel times.
+GlGeomMeshGenerator* GlGeomCylinderMesh::NewMeshGenerator(int lodLevel) const
+{
+    return new GlGeomCylinderMesh(Max(numSlices >> lodLevel, 3), Max(numStacks >> lodLevel, 1), Max(numRings >> lodLevel, 1));
+}
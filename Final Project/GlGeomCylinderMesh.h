@@ -0,0 +1,85 @@
+/*
+* GlGeomCylinderMesh.h
+*
+* Mesh generator for a cylinder: calculates the VBO and EBO data for a
+*   GlGeomCylinder, without OpenGL.  See GlGeomMeshGenerator.h.
+*/
+
+#pragma once
+#ifndef GLGEOM_CYLINDER_MESH_H
+#define GLGEOM_CYLINDER_MESH_H
+
+#include "GlGeomMeshGenerator.h"
+
+// GlGeomCylinderMesh
+//     Generates vertices, normals, and texture coodinates for a cylinder.
+//     Cylinder formed of "slices" and "stacks" and "rings"
+//     Cylinder has radius 1, height 2 and is centered at the origin.
+//     The central axis is the y-axis. Texture coord (0.5,0.5) is on the z-axis.
+class GlGeomCylinderMesh : public GlGeomMeshGenerator
+{
+public:
+    GlGeomCylinderMesh(int slices, int stacks = 1, int rings = 1)
+        : numSlices(slices), numStacks(stacks), numRings(rings) {}
+
+    int GetNumSlices() const { return numSlices; }
+    int GetNumStacks() const { return numStacks; }
+    int GetNumRings() const { return numRings; }
+
+    // Use GetNumElements() and GetNumVerticesTexCoords() and GetNumVerticesNoTexCoords()
+    //    to determine the amount of data that will returned by CalcVboAndEbo.
+    //    Numbers are different since texture coordinates must be assigned differently
+    //        to some vertices depending on which triangle they appear in.
+    int GetNumElements() const { return 2 * GetNumElementsDisk() + GetNumElementsSide(); }
+    int GetNumVerticesTexCoords() const { return 2 * GetNumVerticesDisk() + GetNumVerticesSideTexCoords(); }
+    int GetNumVerticesNoTexCoords() const { return 2 * GetNumVerticesDisk() + GetNumVerticesSideNoTexCoords(); }
+
+    // "Disk" methods are for the bottom or top circular face.  "Side" for the cylinder's side
+    int GetNumElementsDisk() const { return 3 * (2 * numRings - 1)*numSlices; }
+    int GetNumVerticesDisk() const { return 1 + numRings * numSlices; }
+    int GetNumElementsSide() const { return 6 * numStacks*numSlices; }
+    int GetNumVerticesSideTexCoords() const { return (numStacks + 1)*(numSlices + 1); }
+    int GetNumVerticesSideNoTexCoords() const { return (numStacks + 1)*numSlices; }
+    // Numbers of elements for triangle strips, including the restart indices
+    int GetNumElementsStrips() const { return 2 * GetNumElementsDiskStrips() + GetNumElementsSideStrips(); }
+    int GetNumElementsDiskStrips() const { return (2 * numRings + 2)*numSlices; }
+    int GetNumElementsSideStrips() const { return (2 * numStacks + 3)*numSlices; }
+
+    // CalcVboAndEbo- return all VBO vertex information, and EBO elements for GL_TRIANGLES drawing.
+    //    The EBO elements are either 32-bit or 16-bit.
+    // See GlGeomMeshGenerator.h for additional information
+    void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+        unsigned int stride) const;
+    void CalcVboAndEbo(float* VBOdataBuffer, unsigned short* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+        unsigned int stride) const;
+    // CalcEboStrips - EBO elements for GL_TRIANGLE_STRIP drawing, one strip per slice
+    //    of the base, of the top and of the side.
+    void CalcEboStrips(unsigned int* EBOdataBuffer, bool calcTexCoords) const;
+    void CalcEboStrips(unsigned short* EBOdataBuffer, bool calcTexCoords) const;
+
+    // GetMeshKey - identifies the mesh, so identical meshes share one VBO and EBO.
+    // NewMeshGenerator - a copy of the mesh parameters, for remeshing on a worker thread
+    //      and for the coarser levels of detail.
+    bool GetMeshKey(GlGeomMeshKey* key) const;
+    GlGeomMeshGenerator* NewMeshGenerator(int lodLevel = 0) const;
+    float GetBoundingRadius() const { return 1.4142136f; }
+
+protected:
+    int numSlices;          // Number of radial slices (like cake slices
+    int numStacks;          // Number of stacks between the two end faces
+    int numRings;           // Number of concentric rings on two end faces
+
+private:
+    template<class IndexType>
+    void CalcVboAndEboT(float* VBOdataBuffer, IndexType* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const;
+    template<class IndexType>
+    void CalcEboStripsT(IndexType* EBOdataBuffer, bool calcTexCoords) const;
+
+    void SetDiscVerts(float x, float z, int i, int j, float* VBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, int stride) const;
+};
+
+#endif  // GLGEOM_CYLINDER_MESH_H
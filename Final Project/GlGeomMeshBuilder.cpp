@@ -0,0 +1,127 @@
+/*
+* GlGeomMeshBuilder.cpp
+*
+* Calculates the VBO and EBO data of a mesh generator into memory,
+*   without OpenGL.  See GlGeomMeshBuilder.h.
+*/
+
+#include "GlGeomMeshBuilder.h"
+#include "GlGeomVertexCache.h"
+#include <algorithm>
+#include "assert.h"
+
+// The shape itself is the first level of detail; the coarser levels come from generator objects.
+//    The levels are placed one after another in the VBO and in the EBO.
+GlGeomMeshBuilder::GlGeomMeshBuilder(const GlGeomMeshGenerator* shape, const GlGeomMeshOptions& meshOptions)
+    : options(meshOptions)
+{
+    generators[0] = shape;
+    options.numLodLevels = std::min(std::max(options.numLodLevels, 1), GlGeomMaxLodLevels);  // As in SetNumLodLevels
+    if (shape->GetNumElementsStrips() == 0) {
+        options.triangleStrips = false;
+    }
+    if (options.triangleStrips) {
+        options.optimizeVertexCache = false;    // Strips already follow the mesh's grid
+    }
+    numLevels = 1;
+    for (; numLevels < options.numLodLevels; numLevels++) {
+        generators[numLevels] = shape->NewMeshGenerator(numLevels);
+        if (generators[numLevels] == 0) {
+            break;      // Shape does not support levels of detail
+        }
+    }
+
+    totalVertices = 0;
+    totalElements = 0;
+    shortIndices = true;
+    for (int i = 0; i < numLevels; i++) {
+        levels[i].firstVertex = totalVertices;
+        levels[i].firstElement = totalElements;
+        levels[i].numElements = options.triangleStrips ? generators[i]->GetNumElementsStrips()
+                                                       : generators[i]->GetNumElementsRender();
+        levels[i].numVertices = options.useTexCoords ? generators[i]->GetNumVerticesTexCoords()
+                                                     : generators[i]->GetNumVerticesNoTexCoords();
+        totalVertices += levels[i].numVertices;
+        totalElements += options.triangleStrips ? levels[i].numElements : generators[i]->GetNumElementsMax();
+        // 16-bit indices can be used if every level has at most 65536 vertices.
+        //    (Indices are relative to the level's first vertex.)
+        //    With triangle strips, the index 65535 is reserved as the restart index.
+        int maxVertices = options.triangleStrips ? USHRT_MAX : USHRT_MAX + 1;
+        if (levels[i].numVertices > maxVertices) {
+            shortIndices = false;
+        }
+    }
+}
+
+GlGeomMeshBuilder::~GlGeomMeshBuilder()
+{
+    for (int i = 1; i < numLevels; i++) {
+        delete generators[i];
+    }
+}
+
+int GlGeomMeshBuilder::GetVertexSize() const
+{
+    return options.format.VertexSize(options.useNormals, options.useTexCoords);
+}
+
+void GlGeomMeshBuilder::Build(void* VBOdata, void* EBOdata)
+{
+    if (shortIndices) {
+        BuildLevels(VBOdata, (unsigned short*)EBOdata);
+    }
+    else {
+        BuildLevels(VBOdata, (unsigned int*)EBOdata);
+    }
+}
+
+void GlGeomMeshBuilder::Build(std::vector<unsigned char>* VBOdata, std::vector<unsigned char>* EBOdata)
+{
+    VBOdata->resize(GetVBOSize());
+    EBOdata->resize(GetEBOSize());
+    Build(VBOdata->data(), EBOdata->data());
+}
+
+// Calculate the data for all the levels of detail.
+//    Element indices for each level are relative to the level's first vertex.
+// Data that must be post-processed (packed into a compact vertex format, or
+//    reordered for the vertex cache) is generated in temporary arrays,
+//    since VBOdata and EBOdata may be write-only memory.
+template<class IndexType>
+void GlGeomMeshBuilder::BuildLevels(void* VBOdata, IndexType* EBOdata)
+{
+    int stride = StrideVal();
+    int normalOffset = NormalOffset();
+    int texOffset = TexOffset();
+    int vertexSize = GetVertexSize();
+    bool packVertices = !options.format.IsAllFloat();
+    std::vector<float> vertices;
+    std::vector<IndexType> elements;
+    for (int i = 0; i < numLevels; i++) {
+        void* levelVBO = (unsigned char*)VBOdata + (size_t)vertexSize * levels[i].firstVertex;
+        float* floatVBO = (float*)levelVBO;
+        if (packVertices) {
+            vertices.resize(stride * levels[i].numVertices);
+            floatVBO = vertices.data();
+        }
+        IndexType* levelEBO = EBOdata + levels[i].firstElement;
+        if (options.optimizeVertexCache) {
+            elements.resize(generators[i]->GetNumElementsMax());
+            levelEBO = elements.data();
+        }
+        if (options.triangleStrips) {
+            generators[i]->CalcVboAndEbo(floatVBO, (IndexType*)0, 0, normalOffset, texOffset, stride);
+            generators[i]->CalcEboStrips(levelEBO, options.useTexCoords);
+        }
+        else {
+            generators[i]->CalcVboAndEbo(floatVBO, levelEBO, 0, normalOffset, texOffset, stride);
+        }
+        if (packVertices) {
+            options.format.PackVertices(floatVBO, levels[i].numVertices, normalOffset, texOffset, stride, levelVBO);
+        }
+        if (options.optimizeVertexCache) {
+            GlGeomOptimizeVertexCache(elements.data(), levels[i].numElements, levels[i].numVertices);
+            std::copy(elements.begin(), elements.end(), EBOdata + levels[i].firstElement);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/*
+* GlGeomMeshBuilder.h
+*
+* Calculates the VBO and EBO data of a mesh generator into memory.
+*   This is the CPU side of loading a GlGeomShape: the levels of detail, the
+*   choice of 16-bit or 32-bit indices, packing into the vertex format, and the
+*   vertex cache optimization. It only depends on GlGeomMeshGenerator (not on
+*   GlGeomBase), makes no OpenGL calls and needs no OpenGL library or context,
+*   so it can be used for stand-alone mesh generation, and for timing mesh
+*   generation on a machine without a GPU.
+*
+*   GlGeomBase uses it to fill the (mapped) VBO and EBO, and for remeshing
+*   on a worker thread.
+*/
+
+#pragma once
+#ifndef GLGEOM_MESH_BUILDER_H
+#define GLGEOM_MESH_BUILDER_H
+
+#include "GlGeomMeshGenerator.h"
+#include "GlGeomVertexFormat.h"
+#include <stddef.h>
+#include <vector>
+
+// GlGeomMeshOptions - which vertex attributes are calculated, and how the data is stored.
+//    These correspond to the options set on a GlGeomBase object.
+struct GlGeomMeshOptions {
+    bool useNormals = true;
+    bool useTexCoords = true;
+    GlGeomVertexFormat format;
+    int numLodLevels = 1;
+    bool optimizeVertexCache = false;
+    bool triangleStrips = false;        // Ignored if the shape has no triangle strips
+};
+
+// GlGeomMeshBuilder
+//    The constructor lays out the data: use the Get... functions for the sizes.
+//    GetOptions() gives the options actually used: the number of levels of detail is
+//        clamped to 1..GlGeomMaxLodLevels, triangle strips are turned off if the shape
+//        does not support them, and they turn off the vertex cache optimization.
+//    Build() then calculates it, either into caller provided memory or into vectors.
+//    Build() may be called on a worker thread; it only uses the shape's
+//        CalcVboAndEbo method and the builder's own data.
+//    The shape may be a GlGeomShape object (e.g., a GlGeomTorus), or just its
+//        mesh generator (e.g., a GlGeomTorusMesh), which needs no OpenGL.
+// How to use:
+//     GlGeomTorusMesh torus(64, 64, 0.3f);
+//     GlGeomMeshBuilder builder(&torus, options);
+//     std::vector<unsigned char> vbo, ebo;
+//     builder.Build(&vbo, &ebo);
+class GlGeomMeshBuilder {
+public:
+    GlGeomMeshBuilder(const GlGeomMeshGenerator* shape, const GlGeomMeshOptions& options);
+    ~GlGeomMeshBuilder();
+
+    const GlGeomMeshOptions& GetOptions() const { return options; }
+    int GetNumLodLevels() const { return numLevels; }
+    const GlGeomLodLevel& GetLodLevel(int i) const { return levels[i]; }
+    int GetNumVertices() const { return totalVertices; }    // All levels of detail
+    int GetNumElements() const { return totalElements; }
+    bool UseShortIndices() const { return shortIndices; }   // true for unsigned short indices
+    bool UseTriangleStrips() const { return options.triangleStrips; }
+    int GetVertexSize() const;                              // In bytes
+    int GetIndexSize() const { return shortIndices ? sizeof(unsigned short) : sizeof(unsigned int); }
+    size_t GetVBOSize() const { return (size_t)GetVertexSize() * totalVertices; }   // In bytes
+    size_t GetEBOSize() const { return (size_t)GetIndexSize() * totalElements; }
+
+    // Layout of the float data from CalcVboAndEbo (offsets and stride measured in floats).
+    int StrideVal() const { return 3 + (options.useNormals ? 3 : 0) + (options.useTexCoords ? 2 : 0); }
+    int NormalOffset() const { return options.useNormals ? 3 : -1; }
+    int TexOffset() const { return options.useTexCoords ? 3 + (options.useNormals ? 3 : 0) : -1; }
+
+    // Calculate the data. VBOdata and EBOdata must have room for GetVBOSize() and
+    //    GetEBOSize() bytes. They may be write-only memory (e.g., mapped OpenGL buffers).
+    void Build(void* VBOdata, void* EBOdata);
+    // Calculate the data into vectors, which are resized as needed.
+    void Build(std::vector<unsigned char>* VBOdata, std::vector<unsigned char>* EBOdata);
+
+private:
+    GlGeomMeshOptions options;
+    int numLevels;
+    const GlGeomMeshGenerator* generators[GlGeomMaxLodLevels];     // generators[0] is the shape; the others are owned
+    GlGeomLodLevel levels[GlGeomMaxLodLevels];
+    int totalVertices;
+    int totalElements;
+    bool shortIndices;
+
+    template<class IndexType> void BuildLevels(void* VBOdata, IndexType* EBOdata);
+
+    // Disable all copy and assignment operators.
+    GlGeomMeshBuilder(const GlGeomMeshBuilder&) = delete;
+    GlGeomMeshBuilder& operator=(const GlGeomMeshBuilder&) = delete;
+};
+
+#endif  // GLGEOM_MESH_BUILDER_H
@@ -0,0 +1,86 @@
+/*
+* GlGeomMeshGenerator.cpp
+*
+* Base class for the mesh generators of the GlGeomShape classes.
+*   No OpenGL is used.  See GlGeomMeshGenerator.h.
+*/
+
+#include "GlGeomMeshGenerator.h"
+#include "assert.h"
+#include <tuple>
+#include <vector>
+#include <future>
+#include <thread>
+#include "MathMisc.h"
+
+int GlGeomMeshGenerator::MaxGenerationThreads = 8;
+
+bool GlGeomMeshKey::operator<(const GlGeomMeshKey& other) const
+{
+    return std::tie(shapeType, resolution[0], resolution[1], resolution[2], shapeParam,
+                    stride, normalOffset, texOffset, vertexFormat, numLodLevels, cacheOptimized, triangleStrips)
+        < std::tie(other.shapeType, other.resolution[0], other.resolution[1], other.resolution[2], other.shapeParam,
+                   other.stride, other.normalOffset, other.texOffset, other.vertexFormat,
+                   other.numLodLevels, other.cacheOptimized, other.triangleStrips);
+}
+
+bool GlGeomMeshKey::operator==(const GlGeomMeshKey& other) const
+{
+    return !(*this < other) && !(other < *this);
+}
+
+// **********************************************
+// Split mesh generation across threads.
+//   Each thread should get enough work to be worth starting (minWorkPerThread).
+// **********************************************
+void GlGeomMeshGenerator::ParallelFor(int count, int workPerItem, const std::function<void(int, int)>& rangeFunc)
+{
+    const int minWorkPerThread = 1 << 15;
+    int numThreads = Min((int)std::thread::hardware_concurrency(), MaxGenerationThreads);
+    numThreads = Min(numThreads, Min(count, (int)(((long long)count * workPerItem) / minWorkPerThread)));
+    if (numThreads <= 1) {
+        rangeFunc(0, count);
+        return;
+    }
+    std::vector<std::future<void>> parts;
+    for (int t = 1; t < numThreads; t++) {
+        parts.push_back(std::async(std::launch::async, rangeFunc,
+            (int)((long long)count * t / numThreads), (int)((long long)count * (t + 1) / numThreads)));
+    }
+    rangeFunc(0, count / numThreads);
+    for (size_t t = 0; t < parts.size(); t++) {
+        parts[t].get();
+    }
+}
+
+// Default 16-bit version of CalcVboAndEbo: calculate 32-bit indices and convert them.
+void GlGeomMeshGenerator::CalcVboAndEbo(float* VBOdataBuffer, unsigned short* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    if (EBOdataBuffer == 0) {
+        CalcVboAndEbo(VBOdataBuffer, (unsigned int*)0, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+        return;
+    }
+    std::vector<unsigned int> elements(GetNumElementsMax());
+    CalcVboAndEbo(VBOdataBuffer, elements.data(), vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+    for (size_t i = 0; i < elements.size(); i++) {
+        assert(elements[i] <= USHRT_MAX);
+        EBOdataBuffer[i] = (unsigned short)elements[i];
+    }
+}
+
+// Default 16-bit version of CalcEboStrips: the same, except the restart index must be converted too.
+void GlGeomMeshGenerator::CalcEboStrips(unsigned short* EBOdataBuffer, bool calcTexCoords) const
+{
+    std::vector<unsigned int> elements(GetNumElementsStrips());
+    CalcEboStrips(elements.data(), calcTexCoords);
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (elements[i] == GetRestartIndex(false)) {
+            EBOdataBuffer[i] = (unsigned short)GetRestartIndex(true);
+        }
+        else {
+            assert(elements[i] < USHRT_MAX);
+            EBOdataBuffer[i] = (unsigned short)elements[i];
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/*
+* GlGeomMeshGenerator.h
+*
+* Base class for the mesh generators of the GlGeomShape classes.
+*   A GlGeomMeshGenerator calculates the vertices (the VBO data) and the
+*   elements (the EBO data) of a shape, from the shape's mesh resolution and
+*   parameters. It makes no OpenGL calls and needs no OpenGL context.
+*   GlGeomSphereMesh, GlGeomCylinderMesh and GlGeomTorusMesh are the mesh
+*   generators for GlGeomSphere, GlGeomCylinder and GlGeomTorus: each
+*   GlGeomShape class derives from both GlGeomBase and its mesh generator.
+*
+*   GlGeomMeshBuilder only uses this interface, so meshes can be generated
+*   (e.g., for timing, or for writing to a file) without linking OpenGL.
+*/
+
+#pragma once
+#ifndef GLGEOM_MESH_GENERATOR_H
+#define GLGEOM_MESH_GENERATOR_H
+
+#include <limits.h>
+#include <assert.h>
+#include <functional>
+
+// GlGeomMeshKey
+//     Identifies the contents of a VBO and EBO: the shape, its mesh resolution
+//     and the layout of the VBO. GlGeomShape objects with equal keys share
+//     a single VBO and EBO (see GlGeomMeshGenerator::GetMeshKey).
+enum GlGeomShapeType {
+    GlGeomShapeNone = 0,
+    GlGeomShapeSphere,
+    GlGeomShapeCylinder,
+    GlGeomShapeTorus,
+};
+
+struct GlGeomMeshKey {
+    int shapeType;          // A GlGeomShapeType value
+    int resolution[3];      // Mesh resolution, e.g., slices, stacks and rings. Unused entries are zero.
+    float shapeParam;       // Shape parameter, e.g., the minor radius of a torus. Zero if unused.
+    int stride;             // VBO layout: stride and offsets, measured in floats (-1 if omitted)
+    int normalOffset;
+    int texOffset;
+    int vertexFormat;       // GlGeomVertexFormat::Code() for the data stored in the VBO
+    int numLodLevels;       // Number of levels of detail in the VBO and EBO
+    int cacheOptimized;     // 1 if the EBO triangles are reordered for the vertex cache
+    int triangleStrips;     // 1 if the EBO holds triangle strips (see SetTriangleStrips)
+
+    bool operator<(const GlGeomMeshKey& other) const;
+    bool operator==(const GlGeomMeshKey& other) const;
+};
+
+// GlGeomLodLevel - where one level of detail is placed in the VBO and EBO.
+const int GlGeomMaxLodLevels = 3;
+struct GlGeomLodLevel {
+    int firstVertex;        // Index of the level's first vertex in the VBO (its base vertex)
+    int firstElement;       // Index of the level's first element in the EBO
+    int numElements;        // Number of elements rendered for the level
+    int numVertices;        // Number of vertices in the level
+};
+
+class GlGeomMeshGenerator
+{
+public:
+    virtual ~GlGeomMeshGenerator() {}
+
+    // These must be implemented in each mesh generator class.
+    //   GetNumElements() returns the number of elements in the EBO for rendering
+    //   Alternately, GetNumElementsMax() and GetNumElementsRender() can be defined.
+    //   GetNumElementsMax() returns an upper bound on the number of elements in the EBO (for allocation)
+    //   GetNumElementsRender() returns the actual number of elements in the EBO (for rendering)
+    //   GetNumVerticesTexCoords() returns the number of vertices when there are texture coordinates
+    //   GetNumVerticesNoTexCoords() returns the number of vertices when no texture coordinates
+    virtual int GetNumElements() const { assert(false); return -1; };
+    virtual int GetNumElementsMax() const { return GetNumElements(); }
+    virtual int GetNumElementsRender() const { return GetNumElements(); }
+    virtual int GetNumVerticesTexCoords() const = 0;
+    virtual int GetNumVerticesNoTexCoords() const = 0;
+
+    // The routine CalcVboAndEbo must be implemented for all mesh generator classes,
+    //    but is meant for internal use, and is not usually called by the user.
+    // For a GlGeomShape, it is called from the constructor or a ReMesh() or Render() method
+    //         via a call to InitializeAttribLocations. It takes as input:
+    //    * Pointers to the VBO buffer and EBO buffer. Typically these
+    //      are allocated earlier by InitializeAttribLocations
+    //    * Layout of data in the VBO:  offsets for the vertex position,
+    //          the normal and the texture coordinates (if used),
+    //          and the stride value.
+    // Inputs:
+    //   VBOdataBuffer - pointer to the VBO buffer (mapped to memory)
+    //   EBOdataBuffer - pointer to the EBO buffer (mapped to memory)
+    //       - The VBO and EBO buffersare filled with the vertex info and elements for GL_TRIANGLES drawing
+    //   vertPosOffset and stride control where the vertex positions are placed.
+    //   vertNormalOffset and stride control where the vertex normals are placed.
+    //   vertTexCoordsOffset and stride control where the texture coordinates are placed.
+    //   Offset and stride values are **integers** (not bytes), measuring offsets in terms of floats.
+    //   Use "-1" for the offset for any value which should be omitted.
+    //   For the (unit) sphere, the normals are always exactly equal to the positions.
+    // Output:
+    //   Data VBO and EBO data is calculated and loaded into the two buffers VBOdataBuffer and EBOdataBuffer.
+    //   If EBOdataBuffer is null (0), only the VBO data is calculated.
+    // Typical usages are:
+    //   CalcVboAndEbo( vboPtr, eboPtr, 0, -1, -1, 3); // positions only, tightly packed
+    //   CalcVboAndEbo( vboPtr, eboPtr, 0, -1, 3, 5); // positions, then (s,t) texture coords, tightly packed
+    //   CalcVboAndEbo( vboPtr, eboPtr, 0, 3, 6, 8); // positions, normals, then (s,t) texture coords, tightly packed
+    virtual void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+            int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+            unsigned int stride) const = 0;
+    // The same, with 16-bit indices. Only used when there are at most 65536 vertices.
+    //    The default calculates 32-bit indices and converts them. Mesh generator classes
+    //    can override it (usually with a template shared with the 32-bit version).
+    virtual void CalcVboAndEbo(float* VBOdataBuffer, unsigned short* EBOdataBuffer,
+            int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+            unsigned int stride) const;
+
+    // Triangle strips are implemented by mesh generator classes whose mesh is made of strips.
+    //   GetNumElementsStrips() returns the number of elements in the EBO for triangle strips,
+    //       including the restart indices. The default returns 0: no triangle strips.
+    //   CalcEboStrips fills the EBO with the same triangles (with the same orientation)
+    //       as CalcVboAndEbo, as triangle strips. Every strip is followed by the restart
+    //       index GetRestartIndex(), so consecutive strips can be rendered together.
+    //       calcTexCoords must be the same as for the VBO, as it changes the vertex numbering.
+    virtual int GetNumElementsStrips() const { return 0; }
+    virtual void CalcEboStrips(unsigned int* /*EBOdataBuffer*/, bool /*calcTexCoords*/) const { assert(false); }
+    virtual void CalcEboStrips(unsigned short* EBOdataBuffer, bool calcTexCoords) const;
+    static unsigned int GetRestartIndex(bool shortIndices) { return shortIndices ? USHRT_MAX : UINT_MAX; }
+
+    // GetMeshKey is implemented by mesh generator classes whose VBO and EBO data depend only
+    //    on the mesh resolution and shape parameters. It fills in shapeType, resolution[]
+    //    and shapeParam; the layout fields are filled in by GlGeomBase.
+    // Shapes that return false never share their VBO and EBO.
+    virtual bool GetMeshKey(GlGeomMeshKey* /*key*/) const { return false; }
+
+    // NewMeshGenerator is implemented by mesh generator classes which support background remeshing
+    //    and levels of detail. It returns a new object (allocated with new) with the same shape
+    //    parameters, and the same mesh resolution halved lodLevel times (within the shape's minimums).
+    //    Its CalcVboAndEbo may be called on a worker thread, so it must not depend on
+    //    any other object. The default returns 0: remeshing is then done synchronously,
+    //    and there is only one level of detail.
+    virtual GlGeomMeshGenerator* NewMeshGenerator(int /*lodLevel*/ = 0) const { return 0; }
+
+    // GetBoundingRadius returns the radius of a sphere, centered at the origin, enclosing the shape.
+    //    It is used to choose a level of detail.
+    virtual float GetBoundingRadius() const { return 1.0f; }
+
+protected:
+    // Helper for CalcVboAndEbo: calls rangeFunc(begin, end) on consecutive subranges covering [0,count).
+    //    If count*workPerItem (e.g., the number of floats written) is large, the subranges
+    //    are run in parallel on worker threads. rangeFunc must only write data for its own subrange.
+    static void ParallelFor(int count, int workPerItem, const std::function<void(int, int)>& rangeFunc);
+    static int MaxGenerationThreads;    // Default 8. Set to 1 to never use worker threads.
+};
+
+#endif  // GLGEOM_MESH_GENERATOR_H
@@ -27,6 +27,7 @@
 #include "LinearR3.h"
 #include "MathMisc.h"
 #include "assert.h"
+#include <vector>
 
 #include "GlGeomSphere.h"
 
@@ -42,114 +43,21 @@ void GlGeomSphere::Remesh(int slices, int stacks)
     VboEboLoaded = false;
 }
 
-// Create the VBO and EBO data for the sphere.
-// See GlGeomBase.h for more information.
-// This routine could be adapted for stand-alone use, as is.
-void GlGeomSphere::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
-    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
-{
-    assert(vertPosOffset >= 0 && stride>0);
-    bool calcNormals = (vertNormalOffset >= 0);       // Should normals be calculated?
-    bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
-
-     for (int i = 0; i <= numSlices; i++) {
-        // Handle a slice of vertices.
-        // theta measures from the (negative-z)-axis, going counterclockwise viewed from above.
-        float theta = ((float)(i%numSlices))*(float)PI2 / (float)(numSlices);
-        float sTexCd = ((float)i) / (float)numSlices;     // s texture coordinate
-        float costheta = cos(theta);
-        float sintheta = sinf(theta);
-        for (int j = 0; j <= numStacks; j++) {
-            unsigned int vertNumber;
-            if (!GetVertexNumber(i, j, calcTexCoords, &vertNumber)) {
-                continue;       // North or South pole -- duplicate not needed
-            }
-            // phi measures from the (postive-y)-axis
-            float tTexCd = ((float)j) / (float)(numStacks); // t texture coordinate
-            float phi = tTexCd * (float)PI;
-            float cosphi = cosf(phi);
-            float sinphi = (j < numStacks) ? sinf(phi) : 0.0f;
-            float x = -sintheta*sinphi;       // Position, x coordinate            
-            float y = -cosphi;                // Position, y coordinate
-            float z = -costheta*sinphi;       // Position, z coordinate
-            float* basePtr = VBOdataBuffer + stride*vertNumber;
-            float* vPtr = basePtr + vertPosOffset;
-            *vPtr = x;
-            *(vPtr + 1) = y;
-            *(vPtr + 2) = z;
-            if (calcNormals) {
-                float* nPtr = basePtr + vertNormalOffset;
-                *nPtr = x;
-                *(nPtr + 1) = y;
-                *(nPtr + 2) = z;
-            }
-            if (calcTexCoords) {
-                float* tcPtr = basePtr + vertTexCoordsOffset;
-                *tcPtr = (j != 0 && j != numStacks) ? sTexCd : 0.5f;  // s=0.5 at the poles
-                *(tcPtr + 1) = tTexCd;
-            }
-        }
-     }
-     
-     // Calculate elements (vertex indices) suitable for putting into an EBO
-     //      in GL_TRIANGLES mode.
-     unsigned int* toEbo = EBOdataBuffer;
-     for (int i = 0; i < numSlices; i++) {
-         // Handle a slice of vertices.
-         unsigned int leftIdxOld, rightIdxOld;
-         GetVertexNumber(i, 0, calcTexCoords, &leftIdxOld);
-         GetVertexNumber(i + 1, 1, calcTexCoords, &rightIdxOld);
-         for (int j = 0; j < numStacks-1; j++) {
-             unsigned int leftIdxNew, rightIdxNew;
-             GetVertexNumber(i, j + 1, calcTexCoords, &leftIdxNew);
-             GetVertexNumber(i + 1, j + 2, calcTexCoords, &rightIdxNew);
-             *(toEbo++) = leftIdxOld;
-             *(toEbo++) = rightIdxOld;
-             *(toEbo++) = leftIdxNew;
-
-             *(toEbo++) = leftIdxNew;
-             *(toEbo++) = rightIdxOld;
-             *(toEbo++) = rightIdxNew;
-
-             leftIdxOld = leftIdxNew;
-             rightIdxOld = rightIdxNew;
-         }
-     }
-     assert(toEbo - EBOdataBuffer == GetNumElements());
-}
-
-// Calculate the vertex number for the vertex on slice i and stack j.
-// Returns false if this is a duplicate of the south or north pole.
-bool GlGeomSphere::GetVertexNumber(int i, int j, bool calcTexCoords, unsigned int* retVertNum)
-{
-    if (j == 0) {
-        *retVertNum = 0;    // South pole
-        return (i == 0);
-    }
-    if (j == numStacks) {
-        *retVertNum = 1;    // North pole
-        return (i == 0);
-    }
-    int ii = calcTexCoords ? i : (i%numSlices);
-    *retVertNum = (numStacks - 1)*ii + j + 1;
-    return true;
-}
-
-
 void GlGeomSphere::InitializeAttribLocations(
-	unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
+	unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc,
+	unsigned int instanceMat_loc)
 {
     // The call to GlGeomBase::InitializeAttribLocations will further call
-    //   GlGeomSphere::CalcVboAndEbo()
+    //   GlGeomSphereMesh::CalcVboAndEbo()
 
-    GlGeomBase::InitializeAttribLocations(pos_loc, normal_loc, texcoords_loc);
+    GlGeomBase::InitializeAttribLocations(pos_loc, normal_loc, texcoords_loc, instanceMat_loc);
     VboEboLoaded = true;
 }
 
-void GlGeomSphere::PreRender() {
+void GlGeomSphere::PreRender(bool waitForMesh) {
     GlGeomBase::PreRender();
     if (!VboEboLoaded) {
-        ReInitializeAttribLocations();
+        VboEboLoaded = UpdateMesh(waitForMesh);
     }
 }
 
@@ -159,10 +67,22 @@ void GlGeomSphere::PreRender() {
 // **********************************************
 void GlGeomSphere::Render()
 {
-    PreRender();
+    PreRender(false);     // The previous mesh is rendered until a remesh is loaded
     GlGeomBase::Render();
 }
 
+void GlGeomSphere::RenderInstanced(int instanceCount, unsigned int instanceBuffer)
+{
+    PreRender(false);     // The previous mesh is rendered until a remesh is loaded
+    GlGeomBase::RenderInstanced(instanceCount, instanceBuffer);
+}
+
+void GlGeomSphere::RenderLod(const float* modelviewMatrix)
+{
+    PreRender(false);
+    GlGeomBase::RenderLod(modelviewMatrix);
+}
+
 // **********************************************
 // This routine renders the i-th slice.
 // If the sphere's VBO and EBO data need to be calculated, it does this first.
@@ -172,6 +92,11 @@ void GlGeomSphere::RenderSlice(int i)
     assert(i >= 0 && i < numSlices);
     PreRender();
 
+    if (TriangleStripsLoaded()) {
+        int stripLen = GetNumElementsInSliceStrip();
+        GlGeomBase::RenderEBO(GL_TRIANGLE_STRIP, stripLen - 1, i*stripLen);
+        return;
+    }
     int sliceLen = GetNumElementsInSlice();
     GlGeomBase::RenderEBO(GL_TRIANGLES, sliceLen, i*sliceLen);
 }
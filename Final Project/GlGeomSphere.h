@@ -24,6 +24,7 @@
 #define GLGEOM_SPHERE_H
 
 #include "GlGeomBase.h"
+#include "GlGeomSphereMesh.h"
 
 // GlGeomSphere
 //     Generates vertices, normals, and texture coordinates for a sphere.
@@ -45,7 +46,7 @@
 //     * Call Render() to render the sphere. Render() issues the 
 //          the glDrawElements commands for the sphere using the VAO, VBO and EBO.
 
-class GlGeomSphere : public GlGeomBase
+class GlGeomSphere : public GlGeomBase, public GlGeomSphereMesh
 {
 public:
     GlGeomSphere() : GlGeomSphere(6, 6) {}
@@ -54,6 +55,8 @@ public:
     // Remesh: re-mesh to change the number slices and stacks.
     // Can be called either before or after InitializeAttribLocations(), but it is
     //    more efficient if Remesh() is called first, or if the constructor sets the mesh resolution.
+    // Once the VBO and EBO are loaded, the new mesh is calculated on a worker thread,
+    //    and Render() keeps rendering the old mesh until the new mesh is ready.
     void Remesh(int slices, int stacks);
 
     // Allocate the VAO, VBO, and EBO.
@@ -63,11 +66,18 @@ public:
     // Second parameter is the location for the vertex normal vector in the shader program.
     // Third parameter is the location for the vertex 2D texture coordinates in the shader program.
     // The second and third parameters are optional.
+    // The optional fourth parameter is the location for a per-instance matrix (see RenderInstanced).
     void InitializeAttribLocations(
-        unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX);
+        unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX,
+        unsigned int instanceMat_loc = UINT_MAX);
 
     // Render the sphere.  Must call InitializeAttribLocations first.
     void Render();
+    // Render count copies of the sphere with one draw call. See GlGeomBase.h
+    void RenderInstanced(int instanceCount, unsigned int instanceBuffer);
+    // Render the sphere at the level of detail chosen by its size on the screen.
+    //   See SetNumLodLevels and SetLodProjection in GlGeomBase.h
+    void RenderLod(const float* modelviewMatrix);
 
     // Some specialized render routines for rendering portions of the sphere
     // Selectively render a slice or a stack or a north pole triangle fan
@@ -77,30 +87,10 @@ public:
     void RenderStack(int j);    // Renders the j-th stack as a triangle strip
     void RenderNorthPoleFan();  // Renders the north pole stack as a triangle fan.
 
-    int GetNumSlices() const { return numSlices; }
-    int GetNumStacks() const { return numStacks; }
-
-    // Use GetNumElements() and GetNumVerticesTexCoords() and GetNumVerticesNoTexCoords()
-    //    to determine the amount of data that will returned by CalcVboAndEbo.
-    //    Numbers are different since texture coordinates must be assigned differently
-    //        to some vertices depending on which triangle they appear in.
-    int GetNumElements() const { return 6 * numSlices*(numStacks - 1); }
-    int GetNumVerticesTexCoords() const { return (numSlices + 1)*(numStacks - 1) + 2; }
-    int GetNumVerticesNoTexCoords() const { return numSlices * (numStacks - 1) + 2; }
-
-    int GetNumElementsInSlice() const { return 6 * (numStacks - 1); }
-    int GetNumTrianglesInSlice() const { return 2 * (numStacks - 1); }
-    int GetNumTrianglesInStack() const { return 2 * numSlices; }
-    int GetNumTriangles() const { return 2 * numSlices*(numStacks - 1); }
-
-    // CalcVboAndEbo- return all VBO vertex information, and EBO elements for GL_TRIANGLES drawing.
-    // See GlGeomBase.h for additional information
-    void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
-        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
-        unsigned int stride);
+    // The VBO and EBO data are calculated by the GlGeomSphereMesh base class.
+    const GlGeomMeshGenerator* GetMeshGenerator() const { return this; }
 
 private:
-
 	// Disable all copy and assignment operators.
 	// A GlGeomSphere can be allocated as a global or static variable, or with new.
     //     If you need to pass it to/from a function, use references or pointers
@@ -111,21 +101,15 @@ private:
 	GlGeomSphere& operator=(GlGeomSphere&&) = delete;
 
 private:
-    int numSlices;              // Number of radial slices
-    int numStacks;              // Number of levels separating the north pole from the south pole.
-
     bool VboEboLoaded = false;
 
-private:
-    bool GetVertexNumber(int i, int j, bool calcTexCoords, unsigned int* retVertNum);
-    void PreRender();
+    void PreRender(bool waitForMesh = true);
 };
 
 // Constructor
 inline GlGeomSphere::GlGeomSphere(int slices, int stacks)
+    : GlGeomSphereMesh(slices, stacks)
 {
-	numSlices = slices;
-	numStacks = stacks;
 }
 
 #endif  // GLGEOM_SPHERE_H
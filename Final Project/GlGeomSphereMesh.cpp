@@ -0,0 +1,186 @@
+/*
+* GlGeomSphereMesh.cpp
+*
+* Calculates the VBO and EBO data for a sphere, without OpenGL.
+*   See GlGeomSphereMesh.h.
+*/
+
+#include "GlGeomSphereMesh.h"
+#include "MathMisc.h"
+#include "assert.h"
+#include <vector>
+
+// Create the VBO and EBO data for the sphere.
+// See GlGeomMeshGenerator.h for more information.
+template<class IndexType>
+void GlGeomSphereMesh::CalcVboAndEboT(float* VBOdataBuffer, IndexType* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    assert(vertPosOffset >= 0 && stride>0);
+    bool calcNormals = (vertNormalOffset >= 0);       // Should normals be calculated?
+    bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
+
+    // The trig values for each stack are the same for every slice: calculate them once.
+    //    phi measures from the (postive-y)-axis, in numStacks equal steps.
+    std::vector<float> cosPhi(numStacks + 1);
+    std::vector<float> sinPhi(numStacks + 1);
+    SinCosSequence(0.0, PI / (double)numStacks, numStacks + 1, sinPhi.data(), cosPhi.data());
+    sinPhi[numStacks] = 0.0f;           // Exactly zero at the south pole
+    // Likewise for the slices.  theta measures from the (negative-z)-axis, going
+    //    counterclockwise viewed from above.  The last slice is the seam, the same as the first.
+    std::vector<float> cosTheta(numSlices + 1);
+    std::vector<float> sinTheta(numSlices + 1);
+    SinCosSequence(0.0, PI2 / (double)numSlices, numSlices, sinTheta.data(), cosTheta.data());
+    cosTheta[numSlices] = cosTheta[0];
+    sinTheta[numSlices] = sinTheta[0];
+
+    // Without texture coordinates, the last slice would duplicate the first one.
+    int stopSlices = calcTexCoords ? numSlices : numSlices - 1;
+    ParallelFor(stopSlices + 1, (numStacks + 1) * stride, [&](int sliceBegin, int sliceEnd) {
+        for (int i = sliceBegin; i < sliceEnd; i++) {
+            // Handle a slice of vertices.
+            float sTexCd = ((float)i) / (float)numSlices;     // s texture coordinate
+            float costheta = cosTheta[i];
+            float sintheta = sinTheta[i];
+            for (int j = 0; j <= numStacks; j++) {
+                unsigned int vertNumber;
+                if (!GetVertexNumber(i, j, calcTexCoords, &vertNumber)) {
+                    continue;       // North or South pole -- duplicate not needed
+                }
+                float tTexCd = ((float)j) / (float)(numStacks); // t texture coordinate
+                float cosphi = cosPhi[j];
+                float sinphi = sinPhi[j];
+                float x = -sintheta*sinphi;       // Position, x coordinate            
+                float y = -cosphi;                // Position, y coordinate
+                float z = -costheta*sinphi;       // Position, z coordinate
+                float* basePtr = VBOdataBuffer + stride*vertNumber;
+                float* vPtr = basePtr + vertPosOffset;
+                *vPtr = x;
+                *(vPtr + 1) = y;
+                *(vPtr + 2) = z;
+                if (calcNormals) {
+                    float* nPtr = basePtr + vertNormalOffset;
+                    *nPtr = x;
+                    *(nPtr + 1) = y;
+                    *(nPtr + 2) = z;
+                }
+                if (calcTexCoords) {
+                    float* tcPtr = basePtr + vertTexCoordsOffset;
+                    *tcPtr = (j != 0 && j != numStacks) ? sTexCd : 0.5f;  // s=0.5 at the poles
+                    *(tcPtr + 1) = tTexCd;
+                }
+            }
+        }
+    });
+    if (EBOdataBuffer == 0) {
+        return;     // VBO only
+    }
+     
+     // Calculate elements (vertex indices) suitable for putting into an EBO
+     //      in GL_TRIANGLES mode.
+     ParallelFor(numSlices, GetNumElementsInSlice(), [&](int sliceBegin, int sliceEnd) {
+         IndexType* toEbo = EBOdataBuffer + sliceBegin * GetNumElementsInSlice();
+         for (int i = sliceBegin; i < sliceEnd; i++) {
+             // Handle a slice of vertices.
+             unsigned int leftIdxOld, rightIdxOld;
+             GetVertexNumber(i, 0, calcTexCoords, &leftIdxOld);
+             GetVertexNumber(i + 1, 1, calcTexCoords, &rightIdxOld);
+             for (int j = 0; j < numStacks-1; j++) {
+                 unsigned int leftIdxNew, rightIdxNew;
+                 GetVertexNumber(i, j + 1, calcTexCoords, &leftIdxNew);
+                 GetVertexNumber(i + 1, j + 2, calcTexCoords, &rightIdxNew);
+                 *(toEbo++) = leftIdxOld;
+                 *(toEbo++) = rightIdxOld;
+                 *(toEbo++) = leftIdxNew;
+
+                 *(toEbo++) = leftIdxNew;
+                 *(toEbo++) = rightIdxOld;
+                 *(toEbo++) = rightIdxNew;
+
+                 leftIdxOld = leftIdxNew;
+                 rightIdxOld = rightIdxNew;
+             }
+         }
+         assert(sliceEnd < numSlices || toEbo - EBOdataBuffer == GetNumElements());
+     });
+}
+
+// The 32-bit and 16-bit index versions of CalcVboAndEbo
+void GlGeomSphereMesh::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    CalcVboAndEboT(VBOdataBuffer, EBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+}
+
+void GlGeomSphereMesh::CalcVboAndEbo(float* VBOdataBuffer, unsigned short* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    CalcVboAndEboT(VBOdataBuffer, EBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+}
+
+// Calculate elements for GL_TRIANGLE_STRIP mode: one strip per slice, from the
+//     south pole to the north pole, each followed by a restart index.
+//     The vertices alternate between the two sides of the slice, so that the
+//     triangles are the same as in CalcVboAndEbo.
+template<class IndexType>
+void GlGeomSphereMesh::CalcEboStripsT(IndexType* EBOdataBuffer, bool calcTexCoords) const
+{
+    IndexType restartIdx = (IndexType)GetRestartIndex(sizeof(IndexType) == sizeof(unsigned short));
+    IndexType* toEbo = EBOdataBuffer;
+    for (int i = 0; i < numSlices; i++) {
+        for (int j = 0; j < numStacks; j++) {
+            unsigned int leftIdx, rightIdx;
+            GetVertexNumber(i, j, calcTexCoords, &leftIdx);
+            GetVertexNumber(i + 1, j + 1, calcTexCoords, &rightIdx);
+            *(toEbo++) = leftIdx;
+            *(toEbo++) = rightIdx;
+        }
+        *(toEbo++) = restartIdx;
+    }
+    assert(toEbo - EBOdataBuffer == GetNumElementsStrips());
+}
+
+void GlGeomSphereMesh::CalcEboStrips(unsigned int* EBOdataBuffer, bool calcTexCoords) const
+{
+    CalcEboStripsT(EBOdataBuffer, calcTexCoords);
+}
+
+void GlGeomSphereMesh::CalcEboStrips(unsigned short* EBOdataBuffer, bool calcTexCoords) const
+{
+    CalcEboStripsT(EBOdataBuffer, calcTexCoords);
+}
+
+// Calculate the vertex number for the vertex on slice i and stack j.
+// Returns false if this is a duplicate of the south or north pole.
+bool GlGeomSphereMesh::GetVertexNumber(int i, int j, bool calcTexCoords, unsigned int* retVertNum) const
+{
+    if (j == 0) {
+        *retVertNum = 0;    // South pole
+        return (i == 0);
+    }
+    if (j == numStacks) {
+        *retVertNum = 1;    // North pole
+        return (i == 0);
+    }
+    int ii = calcTexCoords ? i : (i%numSlices);
+    *retVertNum = (numStacks - 1)*ii + j + 1;
+    return true;
+}
+
+
+// Identify the mesh data for sharing the VBO and EBO. See GlGeomMeshGenerator.h.
+bool GlGeomSphereMesh::GetMeshKey(GlGeomMeshKey* key) const
+{
+    key->shapeType = GlGeomShapeSphere;
+    key->resolution[0] = numSlices;
+    key->resolution[1] = numStacks;
+    key->resolution[2] = 0;
+    key->shapeParam = 0.0f;
+    return true;
+}
+
+// The same shape, with the resolution halved lodLevel times.
+GlGeomMeshGenerator* GlGeomSphereMesh::NewMeshGenerator(int lodLevel) const
+{
+    return new GlGeomSphereMesh(Max(numSlices >> lodLevel, 3), Max(numStacks >> lodLevel, 3));
+}
@@ -0,0 +1,75 @@
+/*
+* GlGeomSphereMesh.h
+*
+* Mesh generator for a sphere: calculates the VBO and EBO data for a
+*   GlGeomSphere, without OpenGL.  See GlGeomMeshGenerator.h.
+*/
+
+#pragma once
+#ifndef GLGEOM_SPHERE_MESH_H
+#define GLGEOM_SPHERE_MESH_H
+
+#include "GlGeomMeshGenerator.h"
+
+// GlGeomSphereMesh
+//     Generates vertices, normals, and texture coordinates for a unit sphere.
+//     Sphere formed of "slices" and "stacks"
+//     "Slices" means the number of vertical wedges.
+//     "Stacks" means the number of horizontal pieces.
+class GlGeomSphereMesh : public GlGeomMeshGenerator
+{
+public:
+    GlGeomSphereMesh(int slices, int stacks) : numSlices(slices), numStacks(stacks) {}
+
+    int GetNumSlices() const { return numSlices; }
+    int GetNumStacks() const { return numStacks; }
+
+    // Use GetNumElements() and GetNumVerticesTexCoords() and GetNumVerticesNoTexCoords()
+    //    to determine the amount of data that will returned by CalcVboAndEbo.
+    //    Numbers are different since texture coordinates must be assigned differently
+    //        to some vertices depending on which triangle they appear in.
+    int GetNumElements() const { return 6 * numSlices*(numStacks - 1); }
+    int GetNumVerticesTexCoords() const { return (numSlices + 1)*(numStacks - 1) + 2; }
+    int GetNumVerticesNoTexCoords() const { return numSlices * (numStacks - 1) + 2; }
+
+    int GetNumElementsInSlice() const { return 6 * (numStacks - 1); }
+    int GetNumTrianglesInSlice() const { return 2 * (numStacks - 1); }
+    int GetNumTrianglesInStack() const { return 2 * numSlices; }
+    int GetNumTriangles() const { return 2 * numSlices*(numStacks - 1); }
+    int GetNumElementsStrips() const { return numSlices * GetNumElementsInSliceStrip(); }
+    int GetNumElementsInSliceStrip() const { return 2 * numStacks + 1; }  // Includes the restart index
+
+    // CalcVboAndEbo- return all VBO vertex information, and EBO elements for GL_TRIANGLES drawing.
+    //    The EBO elements are either 32-bit or 16-bit.
+    // See GlGeomMeshGenerator.h for additional information
+    void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+        unsigned int stride) const;
+    void CalcVboAndEbo(float* VBOdataBuffer, unsigned short* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+        unsigned int stride) const;
+    // CalcEboStrips - EBO elements for GL_TRIANGLE_STRIP drawing, one strip per slice.
+    void CalcEboStrips(unsigned int* EBOdataBuffer, bool calcTexCoords) const;
+    void CalcEboStrips(unsigned short* EBOdataBuffer, bool calcTexCoords) const;
+
+    // GetMeshKey - identifies the mesh, so identical meshes share one VBO and EBO.
+    // NewMeshGenerator - a copy of the mesh parameters, for remeshing on a worker thread
+    //      and for the coarser levels of detail.
+    bool GetMeshKey(GlGeomMeshKey* key) const;
+    GlGeomMeshGenerator* NewMeshGenerator(int lodLevel = 0) const;
+
+protected:
+    int numSlices;              // Number of radial slices
+    int numStacks;              // Number of levels separating the north pole from the south pole.
+
+    bool GetVertexNumber(int i, int j, bool calcTexCoords, unsigned int* retVertNum) const;
+
+private:
+    template<class IndexType>
+    void CalcVboAndEboT(float* VBOdataBuffer, IndexType* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const;
+    template<class IndexType>
+    void CalcEboStripsT(IndexType* EBOdataBuffer, bool calcTexCoords) const;
+};
+
+#endif  // GLGEOM_SPHERE_MESH_H
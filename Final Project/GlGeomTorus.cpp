@@ -30,6 +30,7 @@
 #include "GlGeomTorus.h"
 #include "MathMisc.h"
 #include "assert.h"
+#include <vector>
 
 
 void GlGeomTorus::Remesh(int rings, int sides, float minorRadius)
@@ -45,79 +46,14 @@ void GlGeomTorus::Remesh(int rings, int sides, float minorRadius)
 }
 
 
-void GlGeomTorus::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
-    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
-{
-    assert(vertPosOffset >= 0 && stride > 0);
-    bool calcNormals = (vertNormalOffset >= 0);       // Should normals be calculated?
-    bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
-
-    // VBO Data is laid out: Around each ring. Starting with ring at x==0 and z<0.
-    //          Each ring starts at the innermost seam of the torus (nearest to the y-axis).
-    float* toPtr = VBOdataBuffer;
-
-    // Outermost loop over the rings
-    int stopRings = calcTexCoords ? numRings : numRings-1;
-    for (int i = 0; i <= stopRings; i++) {
-        // Handle a ring of vertices.
-        // theta measures from the negative z-axis, counterclockwise viewed from above.
-        float sCoord = ((float)(i)) / (float)(numRings);
-        float theta = (float)PI2 * ((float)(i % numRings)) / (float)(numRings);
-        float c = -cosf(theta);      // Negated values (start at negative z-axis)
-        float s = -sinf(theta);
-        int stopSides = calcTexCoords ? numSides : numSides - 1;
-        for (int j = 0; j <= stopSides; j++, toPtr += stride) {
-            // phi measures from the inner seam, going under, around and over, back to the inner seam.
-            float tCoord = ((float)(j)) / (float)(numSides);
-            float phi = (float)PI2 * ((float)(j % numSides)) / (float)(numSides);
-            float cphi = -cosf(phi);      // Negated value (start at inner seam)
-            float sphi = -sinf(phi);       // Negated, start downward (-y)
-            float* posPtr = toPtr;
-            *(posPtr++) = s * (1.0f + radius * cphi);    // x coordinate
-            *(posPtr++) = radius * sphi;                  // y coordinate
-            *posPtr = c * (1.0f + radius * cphi);        // z coordinate
-            if (calcNormals) {
-                float* nPtr = toPtr + vertNormalOffset;
-                *(nPtr++) = s * cphi;           // Normal in x direction
-                *(nPtr++) = sphi;                  // Normal in y direction
-                *nPtr = c * cphi;               // Normal in z direction
-            }
-            if (calcTexCoords) {
-                float* tcPtr = toPtr + vertTexCoordsOffset;
-                *(tcPtr++) = sCoord;
-                *tcPtr = tCoord;
-            }
-        }
-    }
-
-    // EBO data is also laid out in the same order, for GL_TRIANGLES
-    unsigned int* eboPtr = EBOdataBuffer;
-    int ringDelta = calcTexCoords ? numSides + 1 : numSides;
-    for (int ii = 0; ii < numRings; ii++) {
-        int iii = calcTexCoords ? (ii + 1) : ((ii + 1) % numRings);
-        int leftR = ii * ringDelta;
-        int rightR = iii *ringDelta;
-        for (int j = 0; j < numSides; j++) {
-            int jj = calcTexCoords ? (j + 1) : ((j + 1) % numSides);
-            *(eboPtr++) = rightR + j;
-            *(eboPtr++) = leftR + jj;
-            *(eboPtr++) = leftR+j;
-
-            *(eboPtr++) = rightR + j;
-            *(eboPtr++) = rightR + jj;
-            *(eboPtr++) = leftR + jj;
-        }
-    }
-}
-
-
 void GlGeomTorus::InitializeAttribLocations(
-    unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
+    unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc,
+    unsigned int instanceMat_loc)
 {
     // The call to GlGeomBase::InitializeAttribLocations will further call
-    //   GlGeomTorus::CalcVboAndEbo()
+    //   GlGeomTorusMesh::CalcVboAndEbo()
 
-    GlGeomBase::InitializeAttribLocations(pos_loc, normal_loc, texcoords_loc);
+    GlGeomBase::InitializeAttribLocations(pos_loc, normal_loc, texcoords_loc, instanceMat_loc);
     VboEboLoaded = true;
 }
 
@@ -127,28 +63,45 @@ void GlGeomTorus::InitializeAttribLocations(
 // If the torus's VAO, VBO, EBO need to be loaded, it does this first.
 // **********************************************
 
-void GlGeomTorus::PreRender()
+void GlGeomTorus::PreRender(bool waitForMesh)
 {
     GlGeomBase::PreRender();
 
     if (!VboEboLoaded) {
-        ReInitializeAttribLocations();
+        VboEboLoaded = UpdateMesh(waitForMesh);
     }
 }
 
 // Render entire torus as triangles
 void GlGeomTorus::Render()
 {
-    PreRender();
+    PreRender(false);     // The previous mesh is rendered until a remesh is loaded
     GlGeomBase::Render();
 }
 
-// Render one ring as triangles
+void GlGeomTorus::RenderInstanced(int instanceCount, unsigned int instanceBuffer)
+{
+    PreRender(false);     // The previous mesh is rendered until a remesh is loaded
+    GlGeomBase::RenderInstanced(instanceCount, instanceBuffer);
+}
+
+void GlGeomTorus::RenderLod(const float* modelviewMatrix)
+{
+    PreRender(false);
+    GlGeomBase::RenderLod(modelviewMatrix);
+}
+
+// Render one ring as triangles (or as one triangle strip, if strips are loaded)
 void GlGeomTorus::RenderRing(int i)
 {
     assert(i >= 0 && i < numRings);
     PreRender();
 
+    if (TriangleStripsLoaded()) {
+        int stripLen = GetNumElementsPerRingStrip();        // Includes the restart index
+        GlGeomBase::RenderEBO(GL_TRIANGLE_STRIP, stripLen - 1, i*stripLen);
+        return;
+    }
     int numElementsPerRing = GetNumElementsPerRing();
     GlGeomBase::RenderEBO(GL_TRIANGLES, numElementsPerRing, i*numElementsPerRing);
 }
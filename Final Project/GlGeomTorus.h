@@ -23,6 +23,7 @@
 #define GLGEOM_TORUS_H
 
 #include "GlGeomBase.h"
+#include "GlGeomTorusMesh.h"
 #include <limits.h>
 
 // GlGeomTorus
@@ -51,7 +52,7 @@
 // The number of sides = number of wedges around the inner circular path.
 
 
-class GlGeomTorus : public GlGeomBase
+class GlGeomTorus : public GlGeomBase, public GlGeomTorusMesh
 {
 public:
     GlGeomTorus() : GlGeomTorus(8, 8) {}
@@ -60,6 +61,8 @@ public:
 	// Remesh(): Re-mesh to change the number of sides and rings.
     // Can be called either before or after InitAttribLocations(), but it is
     //    more efficient if Remesh() is called first, or if the constructor sets the mesh resolution.
+    // Once the VBO and EBO are loaded, the new mesh is calculated on a worker thread,
+    //    and Render() keeps rendering the old mesh until the new mesh is ready.
     void Remesh(int rings, int sides) { Remesh(rings, sides, radius); }
     void Remesh(int rings, int sides, float minorRadius);
 
@@ -70,10 +73,16 @@ public:
     // Second parameter is the location for the vertex normal vector in the shader program.
     // Third parameter is the location for the vertex 2D texture coordinates in the shader program.
     // The second and third parameters are optional.
+    // The optional fourth parameter is the location for a per-instance matrix (see RenderInstanced).
     void InitializeAttribLocations(
-		unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX);
+		unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX,
+        unsigned int instanceMat_loc = UINT_MAX);
 
     void Render();          // Render(): renders entire torus
+    void RenderInstanced(int instanceCount, unsigned int instanceBuffer);  // See GlGeomBase.h
+    // Render the torus at the level of detail chosen by its size on the screen.
+    //   See SetNumLodLevels and SetLodProjection in GlGeomBase.h
+    void RenderLod(const float* modelviewMatrix);
 
     // Some specialized render routines for rendering portions of the torus
     // Selectively render a ring or a strip of sides
@@ -82,29 +91,10 @@ public:
     void RenderRing(int i);         // Renders the i-th ring as triangles
     void RenderSideStrip(int j);    // Renders the j-th side-strip as a triangle strip
 
-    int GetNumSides() const { return numSides; }
-    int GetNumRings() const { return numRings; }
-    float GetMinorRadius() const { return radius; }
-    float GetMajorRadius() const { return 1.0; }
+    // The VBO and EBO data are calculated by the GlGeomTorusMesh base class.
+    const GlGeomMeshGenerator* GetMeshGenerator() const { return this; }
 
-    // Use GetNumElements() and GetNumVerticesTexCoords() and GetNumVerticesNoTexCoords()
-    //    to determine the amount of data that will returned by CalcVboAndEbo.
-    //    Numbers are different since texture coordinates must be assigned differently
-    //        to some vertices depending on which triangle they appear in.
-    int GetNumElements() const { return 6 * numRings * numSides; }
-    int GetNumVerticesNoTexCoords() const { return numRings * numSides; }
-    int GetNumVerticesTexCoords() const { return (numRings + 1) * (numSides + 1); }
-
-    int GetNumElementsPerRing() const { return numSides * 6; }
-
-    // CalcVboAndEbo- return all VBO vertex information, and EBO elements for GL_TRIANGLES drawing.
-    // See GlGeomBase.h for additional information
-    void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
-        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
-        unsigned int stride);
- 
 private:
-
     // Disable all copy and assignment operators.
 	// A GlGeomTorus can be allocated as a global or static variable, or with new.
 	//     If you need to pass it to/from a function, use references or pointers
@@ -114,22 +104,15 @@ private:
     GlGeomTorus(GlGeomTorus&&) = delete;
     GlGeomTorus& operator=(GlGeomTorus&&) = delete;
 
-private:
-    int numSides;           // Number sides going around the inner circular path
-    int numRings;           // Number of ring-like pieces (perpindicular to the inner path)
-    float radius;           // Minor radius (major radius is fixed equal to 1.0).
-
 private: 
     bool VboEboLoaded = false;
 
-    void PreRender();
+    void PreRender(bool waitForMesh = true);
 };
 
 inline GlGeomTorus::GlGeomTorus(int rings, int sides, float minorRadius)
+    : GlGeomTorusMesh(rings, sides, minorRadius)
 {
-	numSides = sides;
-    numRings = rings;
-    radius = minorRadius;
 }
 
 #endif  // GLGEOM_TORUS_H
@@ -0,0 +1,161 @@
+/*
+* GlGeomTorusMesh.cpp
+*
+* Calculates the VBO and EBO data for a torus, without OpenGL.
+*   See GlGeomTorusMesh.h.
+*/
+
+#include "GlGeomTorusMesh.h"
+#include "MathMisc.h"
+#include "assert.h"
+#include <vector>
+
+template<class IndexType>
+void GlGeomTorusMesh::CalcVboAndEboT(float* VBOdataBuffer, IndexType* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    assert(vertPosOffset >= 0 && stride > 0);
+    bool calcNormals = (vertNormalOffset >= 0);       // Should normals be calculated?
+    bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
+
+    // VBO Data is laid out: Around each ring. Starting with ring at x==0 and z<0.
+    //          Each ring starts at the innermost seam of the torus (nearest to the y-axis).
+
+    // The trig values for each side are the same for every ring: calculate them once.
+    //    phi measures from the inner seam, going under, around and over, back to the inner seam.
+    int stopSides = calcTexCoords ? numSides : numSides - 1;
+    std::vector<float> cosPhi(numSides + 1);
+    std::vector<float> sinPhi(numSides + 1);
+    SinCosSequence(0.0, PI2 / (double)numSides, numSides, sinPhi.data(), cosPhi.data());
+    cosPhi[numSides] = cosPhi[0];       // The seam
+    sinPhi[numSides] = sinPhi[0];
+    for (int j = 0; j <= numSides; j++) {
+        cosPhi[j] = -cosPhi[j];     // Negated value (start at inner seam)
+        sinPhi[j] = -sinPhi[j];     // Negated, start downward (-y)
+    }
+    // Likewise for the rings.  theta measures from the negative z-axis, counterclockwise viewed from above.
+    std::vector<float> cosTheta(numRings + 1);
+    std::vector<float> sinTheta(numRings + 1);
+    SinCosSequence(0.0, PI2 / (double)numRings, numRings, sinTheta.data(), cosTheta.data());
+    cosTheta[numRings] = cosTheta[0];
+    sinTheta[numRings] = sinTheta[0];
+
+    // Outermost loop over the rings
+    int stopRings = calcTexCoords ? numRings : numRings-1;
+    ParallelFor(stopRings + 1, (stopSides + 1) * stride, [&](int ringBegin, int ringEnd) {
+        float* toPtr = VBOdataBuffer + ringBegin * (stopSides + 1) * stride;
+        for (int i = ringBegin; i < ringEnd; i++) {
+            // Handle a ring of vertices.
+            float sCoord = ((float)(i)) / (float)(numRings);
+            float c = -cosTheta[i];      // Negated values (start at negative z-axis)
+            float s = -sinTheta[i];
+            for (int j = 0; j <= stopSides; j++, toPtr += stride) {
+                float tCoord = ((float)(j)) / (float)(numSides);
+                float cphi = cosPhi[j];
+                float sphi = sinPhi[j];
+                float* posPtr = toPtr;
+                *(posPtr++) = s * (1.0f + radius * cphi);    // x coordinate
+                *(posPtr++) = radius * sphi;                  // y coordinate
+                *posPtr = c * (1.0f + radius * cphi);        // z coordinate
+                if (calcNormals) {
+                    float* nPtr = toPtr + vertNormalOffset;
+                    *(nPtr++) = s * cphi;           // Normal in x direction
+                    *(nPtr++) = sphi;                  // Normal in y direction
+                    *nPtr = c * cphi;               // Normal in z direction
+                }
+                if (calcTexCoords) {
+                    float* tcPtr = toPtr + vertTexCoordsOffset;
+                    *(tcPtr++) = sCoord;
+                    *tcPtr = tCoord;
+                }
+            }
+        }
+    });
+    if (EBOdataBuffer == 0) {
+        return;     // VBO only
+    }
+
+    // EBO data is also laid out in the same order, for GL_TRIANGLES
+    int ringDelta = calcTexCoords ? numSides + 1 : numSides;
+    ParallelFor(numRings, 6 * numSides, [&](int ringBegin, int ringEnd) {
+        IndexType* eboPtr = EBOdataBuffer + ringBegin * 6 * numSides;
+        for (int ii = ringBegin; ii < ringEnd; ii++) {
+            int iii = calcTexCoords ? (ii + 1) : ((ii + 1) % numRings);
+            int leftR = ii * ringDelta;
+            int rightR = iii *ringDelta;
+            for (int j = 0; j < numSides; j++) {
+                int jj = calcTexCoords ? (j + 1) : ((j + 1) % numSides);
+                *(eboPtr++) = rightR + j;
+                *(eboPtr++) = leftR + jj;
+                *(eboPtr++) = leftR+j;
+
+                *(eboPtr++) = rightR + j;
+                *(eboPtr++) = rightR + jj;
+                *(eboPtr++) = leftR + jj;
+            }
+        }
+    });
+}
+
+// EBO data for GL_TRIANGLE_STRIP: one strip going around each ring (a band between
+//    two rings of vertices), each followed by a restart index.
+template<class IndexType>
+void GlGeomTorusMesh::CalcEboStripsT(IndexType* EBOdataBuffer, bool calcTexCoords) const
+{
+    IndexType restartIdx = (IndexType)GetRestartIndex(sizeof(IndexType) == sizeof(unsigned short));
+    IndexType* eboPtr = EBOdataBuffer;
+    int ringDelta = calcTexCoords ? numSides + 1 : numSides;
+    for (int ii = 0; ii < numRings; ii++) {
+        int iii = calcTexCoords ? (ii + 1) : ((ii + 1) % numRings);
+        int leftR = ii * ringDelta;
+        int rightR = iii * ringDelta;
+        for (int j = 0; j <= numSides; j++) {
+            int jj = calcTexCoords ? j : (j % numSides);
+            *(eboPtr++) = leftR + jj;
+            *(eboPtr++) = rightR + jj;
+        }
+        *(eboPtr++) = restartIdx;
+    }
+    assert(eboPtr - EBOdataBuffer == GetNumElementsStrips());
+}
+
+// The 32-bit and 16-bit index versions of CalcVboAndEbo and CalcEboStrips
+void GlGeomTorusMesh::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    CalcVboAndEboT(VBOdataBuffer, EBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+}
+
+void GlGeomTorusMesh::CalcVboAndEbo(float* VBOdataBuffer, unsigned short* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const
+{
+    CalcVboAndEboT(VBOdataBuffer, EBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+}
+
+void GlGeomTorusMesh::CalcEboStrips(unsigned int* EBOdataBuffer, bool calcTexCoords) const
+{
+    CalcEboStripsT(EBOdataBuffer, calcTexCoords);
+}
+
+void GlGeomTorusMesh::CalcEboStrips(unsigned short* EBOdataBuffer, bool calcTexCoords) const
+{
+    CalcEboStripsT(EBOdataBuffer, calcTexCoords);
+}
+
+
+// Identify the mesh data for sharing the VBO and EBO. See GlGeomMeshGenerator.h.
+bool GlGeomTorusMesh::GetMeshKey(GlGeomMeshKey* key) const
+{
+    key->shapeType = GlGeomShapeTorus;
+    key->resolution[0] = numRings;
+    key->resolution[1] = numSides;
+    key->resolution[2] = 0;
+    key->shapeParam = radius;
+    return true;
+}
+
+// The same shape, with the resolution halved lodLevel times.
+GlGeomMeshGenerator* GlGeomTorusMesh::NewMeshGenerator(int lodLevel) const
+{
+    return new GlGeomTorusMesh(Max(numRings >> lodLevel, 3), Max(numSides >> lodLevel, 3), radius);
+}
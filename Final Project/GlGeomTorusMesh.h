@@ -0,0 +1,75 @@
+/*
+* GlGeomTorusMesh.h
+*
+* Mesh generator for a torus: calculates the VBO and EBO data for a
+*   GlGeomTorus, without OpenGL.  See GlGeomMeshGenerator.h.
+*/
+
+#pragma once
+#ifndef GLGEOM_TORUS_MESH_H
+#define GLGEOM_TORUS_MESH_H
+
+#include "GlGeomMeshGenerator.h"
+
+// GlGeomTorusMesh
+//     Generates vertices, normals, and texture coodinates for a torus.
+//     Torus is formed of "rings" and "sides"
+//     Torus is centered at the origin, symmetrically around the y-axis.
+//     The major radius is 1.0; minorRadius is the radius of the circular tube.
+class GlGeomTorusMesh : public GlGeomMeshGenerator
+{
+public:
+    GlGeomTorusMesh(int rings, int sides, float minorRadius = 0.5)
+        : numSides(sides), numRings(rings), radius(minorRadius) {}
+
+    int GetNumSides() const { return numSides; }
+    int GetNumRings() const { return numRings; }
+    float GetMinorRadius() const { return radius; }
+    float GetMajorRadius() const { return 1.0; }
+
+    // Use GetNumElements() and GetNumVerticesTexCoords() and GetNumVerticesNoTexCoords()
+    //    to determine the amount of data that will returned by CalcVboAndEbo.
+    //    Numbers are different since texture coordinates must be assigned differently
+    //        to some vertices depending on which triangle they appear in.
+    int GetNumElements() const { return 6 * numRings * numSides; }
+    int GetNumVerticesNoTexCoords() const { return numRings * numSides; }
+    int GetNumVerticesTexCoords() const { return (numRings + 1) * (numSides + 1); }
+
+    int GetNumElementsPerRing() const { return numSides * 6; }
+    int GetNumElementsStrips() const { return numRings * GetNumElementsPerRingStrip(); }
+    int GetNumElementsPerRingStrip() const { return 2 * numSides + 3; }   // Includes the restart index
+
+    // CalcVboAndEbo- return all VBO vertex information, and EBO elements for GL_TRIANGLES drawing.
+    //    The EBO elements are either 32-bit or 16-bit.
+    // See GlGeomMeshGenerator.h for additional information
+    void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+        unsigned int stride) const;
+    void CalcVboAndEbo(float* VBOdataBuffer, unsigned short* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+        unsigned int stride) const;
+    // CalcEboStrips - EBO elements for GL_TRIANGLE_STRIP drawing, one strip per ring.
+    void CalcEboStrips(unsigned int* EBOdataBuffer, bool calcTexCoords) const;
+    void CalcEboStrips(unsigned short* EBOdataBuffer, bool calcTexCoords) const;
+
+    // GetMeshKey - identifies the mesh, so identical meshes share one VBO and EBO.
+    // NewMeshGenerator - a copy of the mesh parameters, for remeshing on a worker thread
+    //      and for the coarser levels of detail.
+    bool GetMeshKey(GlGeomMeshKey* key) const;
+    GlGeomMeshGenerator* NewMeshGenerator(int lodLevel = 0) const;
+    float GetBoundingRadius() const { return 1.0f + radius; }
+
+protected:
+    int numSides;           // Number sides going around the inner circular path
+    int numRings;           // Number of ring-like pieces (perpindicular to the inner path)
+    float radius;           // Minor radius (major radius is fixed equal to 1.0).
+
+private:
+    template<class IndexType>
+    void CalcVboAndEboT(float* VBOdataBuffer, IndexType* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride) const;
+    template<class IndexType>
+    void CalcEboStripsT(IndexType* EBOdataBuffer, bool calcTexCoords) const;
+};
+
+#endif  // GLGEOM_TORUS_MESH_H
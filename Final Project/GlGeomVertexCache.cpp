@@ -0,0 +1,156 @@
+/*
+* GlGeomVertexCache.cpp
+*
+* Post-transform vertex cache optimization (Tipsify) and ACMR measurement.
+*   See GlGeomVertexCache.h.
+*/
+
+#include "GlGeomVertexCache.h"
+#include <vector>
+#include <algorithm>
+#include "assert.h"
+
+namespace {
+
+    // Tipsify: Sander, Nehab, Barczak, "Fast triangle reordering for vertex
+    //    locality and reduced overdraw", SIGGRAPH 2007.
+    // Triangles are emitted as fans around a "fanning" vertex. The next fanning
+    //    vertex is chosen among the vertices just emitted, preferring the oldest one
+    //    that will still be in the cache after its remaining triangles are emitted.
+    template<class IndexType>
+    void OptimizeVertexCacheT(IndexType* elements, int numElements, int numVertices, int cacheSize)
+    {
+        assert(numElements % 3 == 0 && cacheSize > 0);
+        if (numElements == 0) {
+            return;
+        }
+
+        // Adjacency: the triangles using each vertex, stored consecutively
+        std::vector<int> liveCount(numVertices, 0);       // Number of unemitted triangles using the vertex
+        for (int i = 0; i < numElements; i++) {
+            assert((int)elements[i] < numVertices);
+            liveCount[elements[i]]++;
+        }
+        std::vector<int> adjStart(numVertices + 1, 0);
+        for (int v = 0; v < numVertices; v++) {
+            adjStart[v + 1] = adjStart[v] + liveCount[v];
+        }
+        std::vector<int> adjacency(numElements);
+        std::vector<int> adjFill(adjStart.begin(), adjStart.end() - 1);
+        for (int i = 0; i < numElements; i++) {
+            adjacency[adjFill[elements[i]]++] = i / 3;
+        }
+
+        std::vector<int> timeStamp(numVertices, 0);       // Time the vertex last entered the cache
+        std::vector<char> emitted(numElements / 3, 0);
+        std::vector<int> deadEndStack;
+        std::vector<int> candidates;
+        std::vector<IndexType> output;
+        output.reserve(numElements);
+        int time = cacheSize + 1;
+        int cursor = 0;                 // For finding unused vertices when all else fails
+        int fanVertex = elements[0];
+        while (fanVertex >= 0) {
+            candidates.clear();
+            for (int j = adjStart[fanVertex]; j < adjStart[fanVertex + 1]; j++) {
+                int t = adjacency[j];
+                if (emitted[t]) {
+                    continue;
+                }
+                for (int k = 0; k < 3; k++) {
+                    int v = elements[3 * t + k];
+                    output.push_back((IndexType)v);
+                    deadEndStack.push_back(v);
+                    candidates.push_back(v);
+                    liveCount[v]--;
+                    if (time - timeStamp[v] > cacheSize) {
+                        timeStamp[v] = time++;      // Cache miss: the vertex enters the cache
+                    }
+                }
+                emitted[t] = 1;
+            }
+
+            // Choose the next fanning vertex
+            int next = -1;
+            int bestPriority = -1;
+            for (int v : candidates) {
+                if (liveCount[v] > 0) {
+                    int priority = 0;
+                    if (time - timeStamp[v] + 2 * liveCount[v] <= cacheSize) {
+                        priority = time - timeStamp[v];     // Still in cache: prefer older vertices
+                    }
+                    if (priority > bestPriority) {
+                        bestPriority = priority;
+                        next = v;
+                    }
+                }
+            }
+            if (next == -1) {
+                // Dead end: use a recently emitted vertex, else any vertex with triangles left.
+                while (next == -1 && !deadEndStack.empty()) {
+                    int d = deadEndStack.back();
+                    deadEndStack.pop_back();
+                    if (liveCount[d] > 0) {
+                        next = d;
+                    }
+                }
+                for (; next == -1 && cursor < numVertices; cursor++) {
+                    if (liveCount[cursor] > 0) {
+                        next = cursor;
+                    }
+                }
+            }
+            fanVertex = next;
+        }
+        assert((int)output.size() == numElements);
+        std::copy(output.begin(), output.end(), elements);
+    }
+
+    template<class IndexType>
+    float CalcAcmrT(const IndexType* elements, int numElements, int cacheSize, GlGeomCacheModel model)
+    {
+        if (numElements < 3) {
+            return 0.0f;
+        }
+        std::vector<unsigned int> cache;        // cache[0] is the next entry to be evicted
+        cache.reserve(cacheSize);
+        int numMisses = 0;
+        for (int i = 0; i < numElements; i++) {
+            unsigned int v = elements[i];
+            std::vector<unsigned int>::iterator pos = std::find(cache.begin(), cache.end(), v);
+            if (pos != cache.end()) {
+                if (model == GlGeomCacheLRU) {
+                    cache.erase(pos);           // Hit: becomes the most recently used
+                    cache.push_back(v);
+                }
+                continue;
+            }
+            numMisses++;
+            if ((int)cache.size() == cacheSize) {
+                cache.erase(cache.begin());
+            }
+            cache.push_back(v);
+        }
+        return (float)numMisses / (float)(numElements / 3);
+    }
+}
+
+void GlGeomOptimizeVertexCache(unsigned int* elements, int numElements, int numVertices, int cacheSize)
+{
+    OptimizeVertexCacheT(elements, numElements, numVertices, cacheSize);
+}
+
+void GlGeomOptimizeVertexCache(unsigned short* elements, int numElements, int numVertices, int cacheSize)
+{
+    OptimizeVertexCacheT(elements, numElements, numVertices, cacheSize);
+}
+
+float GlGeomCalcAcmr(const unsigned int* elements, int numElements, int cacheSize, GlGeomCacheModel model)
+{
+    return CalcAcmrT(elements, numElements, cacheSize, model);
+}
+
+float GlGeomCalcAcmr(const unsigned short* elements, int numElements, int cacheSize, GlGeomCacheModel model)
+{
+    return CalcAcmrT(elements, numElements, cacheSize, model);
+}
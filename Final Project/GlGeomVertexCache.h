@@ -0,0 +1,41 @@
+/*
+* GlGeomVertexCache.h
+*
+* Post-transform vertex cache optimization for the EBO data of GlGeomShape classes.
+*   GlGeomOptimizeVertexCache reorders the triangles of a GL_TRIANGLES element
+*      list so that the GPU re-shades fewer shared vertices. It uses the
+*      "Tipsify" algorithm of Sander, Nehab and Barczak (2007), which runs in
+*      linear time and does not need to know the exact cache size of the GPU.
+*   GlGeomCalcAcmr gives the average cache miss ratio (ACMR) of an element list
+*      on a simulated FIFO or LRU cache: the number of vertex shader invocations
+*      per triangle. It ranges from 3.0 (no reuse) down to about 0.5.
+*
+* Neither routine uses OpenGL, so they can be used and measured on a machine
+*   without a GPU.  Triangles keep their orientation (winding order).
+*/
+
+#pragma once
+#ifndef GLGEOM_VERTEX_CACHE_H
+#define GLGEOM_VERTEX_CACHE_H
+
+enum GlGeomCacheModel {
+    GlGeomCacheFIFO,        // Typical of real hardware
+    GlGeomCacheLRU,
+};
+
+const int GlGeomDefaultCacheSize = 16;
+
+// Reorder the triangles in elements[0..numElements-1] (numElements a multiple of 3).
+//    All elements must be less than numVertices.
+void GlGeomOptimizeVertexCache(unsigned int* elements, int numElements, int numVertices,
+    int cacheSize = GlGeomDefaultCacheSize);
+void GlGeomOptimizeVertexCache(unsigned short* elements, int numElements, int numVertices,
+    int cacheSize = GlGeomDefaultCacheSize);
+
+// Average number of cache misses per triangle.
+float GlGeomCalcAcmr(const unsigned int* elements, int numElements,
+    int cacheSize = GlGeomDefaultCacheSize, GlGeomCacheModel model = GlGeomCacheFIFO);
+float GlGeomCalcAcmr(const unsigned short* elements, int numElements,
+    int cacheSize = GlGeomDefaultCacheSize, GlGeomCacheModel model = GlGeomCacheFIFO);
+
+#endif  // GLGEOM_VERTEX_CACHE_H
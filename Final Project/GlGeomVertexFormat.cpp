@@ -0,0 +1,121 @@
+/*
+* GlGeomVertexFormat.cpp
+*
+* Packing of vertex data into compact vertex formats.  See GlGeomVertexFormat.h.
+*/
+
+#include "GlGeomVertexFormat.h"
+#include "MathMisc.h"
+#include <string.h>
+
+GlGeomVertexFormat GlGeomVertexFormat::Compact(bool quantizePositions)
+{
+    GlGeomVertexFormat format;
+    format.position = quantizePositions ? GlGeomPositionHalf : GlGeomPositionFloat;
+    format.normal = GlGeomNormalPacked;
+    format.texCoords = GlGeomTexCoordHalf;
+    return format;
+}
+
+bool GlGeomVertexFormat::IsAllFloat() const
+{
+    return position == GlGeomPositionFloat && normal == GlGeomNormalFloat && texCoords == GlGeomTexCoordFloat;
+}
+
+int GlGeomVertexFormat::VertexSize(bool useNormals, bool useTexCoords) const
+{
+    return PositionSize() + (useNormals ? NormalSize() : 0) + (useTexCoords ? TexCoordSize() : 0);
+}
+
+void GlGeomVertexFormat::PackVertices(const float* vertices, int numVertices, int normalOffset, int texOffset,
+    int stride, void* dest) const
+{
+    bool useNormals = (normalOffset >= 0);
+    bool useTexCoords = (texOffset >= 0);
+    int vertexSize = VertexSize(useNormals, useTexCoords);
+    int destNormalOffset = PositionSize();
+    int destTexOffset = PositionSize() + (useNormals ? NormalSize() : 0);
+    const float* src = vertices;
+    unsigned char* toVert = (unsigned char*)dest;
+    for (int i = 0; i < numVertices; i++, src += stride, toVert += vertexSize) {
+        // memcpy is used for all stores, as the data in dest is not aligned for each type.
+        if (position == GlGeomPositionFloat) {
+            memcpy(toVert, src, 3 * sizeof(float));
+        }
+        else {
+            unsigned short h[4] = { GlGeomFloatToHalf(src[0]), GlGeomFloatToHalf(src[1]), GlGeomFloatToHalf(src[2]), 0 };
+            memcpy(toVert, h, sizeof(h));
+        }
+        if (useNormals) {
+            const float* n = src + normalOffset;
+            if (normal == GlGeomNormalFloat) {
+                memcpy(toVert + destNormalOffset, n, 3 * sizeof(float));
+            }
+            else {
+                unsigned int packed = GlGeomPackNormal(n[0], n[1], n[2]);
+                memcpy(toVert + destNormalOffset, &packed, sizeof(packed));
+            }
+        }
+        if (useTexCoords) {
+            const float* tc = src + texOffset;
+            if (texCoords == GlGeomTexCoordFloat) {
+                memcpy(toVert + destTexOffset, tc, 2 * sizeof(float));
+            }
+            else {
+                unsigned short st[2];
+                if (texCoords == GlGeomTexCoordHalf) {
+                    st[0] = GlGeomFloatToHalf(tc[0]);
+                    st[1] = GlGeomFloatToHalf(tc[1]);
+                }
+                else {
+                    st[0] = GlGeomFloatToUnorm16(tc[0]);
+                    st[1] = GlGeomFloatToUnorm16(tc[1]);
+                }
+                memcpy(toVert + destTexOffset, st, sizeof(st));
+            }
+        }
+    }
+}
+
+// IEEE half float: 1 sign bit, 5 exponent bits, 10 mantissa bits.
+unsigned short GlGeomFloatToHalf(float x)
+{
+    unsigned int bits;
+    memcpy(&bits, &x, sizeof(bits));
+    unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+    unsigned int absBits = bits & 0x7fffffff;
+    if (absBits > 0x7f800000) {
+        return sign | 0x7e00;           // NaN
+    }
+    if (absBits >= 0x47800000) {
+        return sign | 0x7c00;           // Infinity, or too large: 2^16 and above
+    }
+    if (absBits < 0x38800000) {
+        // Subnormal half (below 2^-14): the mantissa is x*2^24, rounded to nearest even.
+        float scaled = fabsf(x) * 16777216.0f;
+        return sign | (unsigned short)lrintf(scaled);
+    }
+    // Normal half: rebias the exponent from 127 to 15 and round the mantissa to nearest even.
+    //   A carry out of the mantissa correctly increments the exponent (possibly to infinity).
+    unsigned int h = (absBits - 0x38000000) >> 13;
+    unsigned int roundBits = absBits & 0x1fff;
+    if (roundBits > 0x1000 || (roundBits == 0x1000 && (h & 1) != 0)) {
+        h++;
+    }
+    return sign | (unsigned short)h;
+}
+
+// Signed normalized 10 bit values: x in bits 0-9, y in bits 10-19, z in bits 20-29. The w bits are zero.
+//   Uses the OpenGL 4.2 conversion c = round(511*f) (also used by current OpenGL 3.3 drivers).
+unsigned int GlGeomPackNormal(float x, float y, float z)
+{
+    int ix = (int)lrintf(511.0f * ClampRange(x, -1.0f, 1.0f));
+    int iy = (int)lrintf(511.0f * ClampRange(y, -1.0f, 1.0f));
+    int iz = (int)lrintf(511.0f * ClampRange(z, -1.0f, 1.0f));
+    return ((unsigned int)ix & 0x3ff) | (((unsigned int)iy & 0x3ff) << 10) | (((unsigned int)iz & 0x3ff) << 20);
+}
+
+unsigned short GlGeomFloatToUnorm16(float x)
+{
+    return (unsigned short)lrintf(65535.0f * ClampRange(x, 0.0f, 1.0f));
+}
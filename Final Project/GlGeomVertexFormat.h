@@ -0,0 +1,64 @@
+/*
+* GlGeomVertexFormat.h
+*
+* Vertex formats for the VBO data of GlGeomShape classes.
+*   The GlGeomShape classes always calculate positions, normals and texture
+*   coordinates as floats. A GlGeomVertexFormat selects a more compact storage
+*   for each of them in the VBO; the float data is packed into this format when
+*   the VBO is loaded.
+*
+*   The fully packed format (GlGeomVertexFormat::Compact()) with half float positions
+*   takes 16 bytes per vertex, half of the 32 bytes for all floats.
+*/
+
+#pragma once
+#ifndef GLGEOM_VERTEX_FORMAT_H
+#define GLGEOM_VERTEX_FORMAT_H
+
+enum GlGeomPositionFormat {
+    GlGeomPositionFloat = 0,    // 3 floats (12 bytes)
+    GlGeomPositionHalf,         // 3 half floats, padded (8 bytes). Relative error at most 2^-11
+};
+
+enum GlGeomNormalFormat {
+    GlGeomNormalFloat = 0,      // 3 floats (12 bytes)
+    GlGeomNormalPacked,         // GL_INT_2_10_10_10_REV, normalized (4 bytes). Error at most 1/1022
+};
+
+enum GlGeomTexCoordFormat {
+    GlGeomTexCoordFloat = 0,    // 2 floats (8 bytes)
+    GlGeomTexCoordHalf,         // 2 half floats (4 bytes)
+    GlGeomTexCoordUnorm16,      // 2 unsigned shorts, normalized (4 bytes). Texture coordinates must be in [0,1]
+};
+
+// GlGeomVertexFormat
+//    The attributes are stored in the order: position, normal, texture coordinates.
+//    Omitted attributes take no space. Every attribute is a multiple of 4 bytes.
+struct GlGeomVertexFormat {
+    GlGeomPositionFormat position = GlGeomPositionFloat;
+    GlGeomNormalFormat normal = GlGeomNormalFloat;
+    GlGeomTexCoordFormat texCoords = GlGeomTexCoordFloat;
+
+    // Float positions, packed normals and half float texture coordinates
+    static GlGeomVertexFormat Compact(bool quantizePositions = false);
+
+    bool IsAllFloat() const;
+    int PositionSize() const { return position == GlGeomPositionFloat ? 12 : 8; }     // Sizes in bytes
+    int NormalSize() const { return normal == GlGeomNormalFloat ? 12 : 4; }
+    int TexCoordSize() const { return texCoords == GlGeomTexCoordFloat ? 8 : 4; }
+    int VertexSize(bool useNormals, bool useTexCoords) const;
+    int Code() const { return position | (normal << 4) | (texCoords << 8); }     // Unique per format
+
+    // Pack numVertices vertices from float data into dest.
+    //    The float data has offsets and stride measured in floats, as for CalcVboAndEbo.
+    //    An offset of -1 means the attribute is omitted, both in the float data and in dest.
+    void PackVertices(const float* vertices, int numVertices, int normalOffset, int texOffset,
+        int stride, void* dest) const;
+};
+
+// Conversions used by PackVertices
+unsigned short GlGeomFloatToHalf(float x);                      // Rounds to nearest even
+unsigned int GlGeomPackNormal(float x, float y, float z);       // For GL_INT_2_10_10_10_REV
+unsigned short GlGeomFloatToUnorm16(float x);                   // Clamps to [0,1]
+
+#endif  // GLGEOM_VERTEX_FORMAT_H
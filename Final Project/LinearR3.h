@@ -67,8 +67,8 @@ public:
 	//static const VectorR3 NegUnitZ;
 
 public:
-	VectorR3( ) : x(0.0), y(0.0), z(0.0) {}
-	VectorR3( double xVal, double yVal, double zVal )
+	constexpr VectorR3( ) : x(0.0), y(0.0), z(0.0) {}
+	constexpr VectorR3( double xVal, double yVal, double zVal )
 		: x(xVal), y(yVal), z(zVal) {}
 
 	VectorR3& Set( const Quaternion& );	// Convert quat to rotation vector
@@ -110,6 +110,17 @@ public:
 	VectorR3& SubtractFrom( const VectorR3& u );	
 	VectorR3& AddCrossProduct( const VectorR3& u, const VectorR3& v );
 
+	// Fused operations: these set *this from a compound expression in one pass,
+	//   with no VectorR3 temporaries.  E.g., SetAddScaled(u,v,s) instead of u+s*v.
+	VectorR3& SetDifference( const VectorR3& u, const VectorR3& v );		// u - v
+	VectorR3& SetAddScaled( const VectorR3& u, const VectorR3& v, double s );	// u + s*v
+	VectorR3& SetLinearCombination( double a, const VectorR3& u, double b, const VectorR3& v );	// a*u + b*v
+	VectorR3& SetLinearCombination( double a, const VectorR3& u, double b, const VectorR3& v,
+									double c, const VectorR3& w );			// a*u + b*v + c*w
+	VectorR3& SetCrossProduct( const VectorR3& u, const VectorR3& v );		// u*v
+	VectorR3& SetTriangleNormal( const VectorR3& p0, const VectorR3& p1, 
+								 const VectorR3& p2 );	// (p1-p0)*(p2-p0), not normalized
+
 	bool IsZero() const { return ( x==0.0 && y==0.0 && z==0.0 ); }
 	double Norm() const { return ( (double)sqrt( x*x + y*y + z*z ) ); }
 	double NormSq() const { return ( x*x + y*y + z*z ); }
@@ -143,16 +154,16 @@ public:
 
 };
 
-inline VectorR3 operator+( const VectorR3& u, const VectorR3& v );
-inline VectorR3 operator-( const VectorR3& u, const VectorR3& v ); 
-inline VectorR3 operator*( const VectorR3& u, double m); 
-inline VectorR3 operator*( double m, const VectorR3& u); 
+constexpr VectorR3 operator+( const VectorR3& u, const VectorR3& v );
+constexpr VectorR3 operator-( const VectorR3& u, const VectorR3& v ); 
+constexpr VectorR3 operator*( const VectorR3& u, double m); 
+constexpr VectorR3 operator*( double m, const VectorR3& u); 
 inline VectorR3 operator/( const VectorR3& u, double m); 
 
-inline double operator^ (const VectorR3& u, const VectorR3& v ); // Dot Product
-inline double InnerProduct(const VectorR3& u, const VectorR3& v ) { return (u^v); }
-inline VectorR3 operator* (const VectorR3& u, const VectorR3& v);	 // Cross Product
-inline VectorR3 ArrayProd ( const VectorR3& u, const VectorR3& v );
+constexpr double operator^ (const VectorR3& u, const VectorR3& v ); // Dot Product
+constexpr double InnerProduct(const VectorR3& u, const VectorR3& v ) { return (u^v); }
+constexpr VectorR3 operator* (const VectorR3& u, const VectorR3& v);	 // Cross Product
+constexpr VectorR3 ArrayProd ( const VectorR3& u, const VectorR3& v );
 
 inline double Mag(const VectorR3& u) { return u.Norm(); }
 inline double Dist(const VectorR3& u, const VectorR3& v) { return u.Dist(v); }
@@ -174,6 +185,11 @@ inline VectorR3 ToVectorR3( const Quaternion& q )
 
 VectorR3 Interpolate( const VectorR3& start, const VectorR3& end, double a);
 
+// Fused operations on arrays of count vectors.  dest may equal u or v.
+void AddScaled( VectorR3* dest, const VectorR3* u, double s, int count );	// dest[i] += s*u[i]
+void LinearCombination( VectorR3* dest, double a, const VectorR3* u, 
+						double b, const VectorR3* v, int count );		// dest[i] = a*u[i] + b*v[i]
+
 // *****************************************
 // Matrix3x3 class                         *
 // * * * * * * * * * * * * * * * * * * * * *
@@ -191,7 +207,7 @@ public:
 public:
 	inline Matrix3x3();
 	inline Matrix3x3(const VectorR3&, const VectorR3&, const VectorR3&); // Sets by columns!
-	inline Matrix3x3(double, double, double, double, double, double,
+	inline constexpr Matrix3x3(double, double, double, double, double, double,
 					 double, double, double );	// Sets by columns
 
 	inline void SetIdentity ();		// Set to the identity map
@@ -416,19 +432,19 @@ inline VectorR3& VectorR3::MakeUnit ()			// Convert to unit vector (or leave zer
 	return *this;
 }
 
-inline VectorR3 operator+( const VectorR3& u, const VectorR3& v ) 
+constexpr VectorR3 operator+( const VectorR3& u, const VectorR3& v ) 
 { 
 	return VectorR3(u.x+v.x, u.y+v.y, u.z+v.z); 
 }
-inline VectorR3 operator-( const VectorR3& u, const VectorR3& v ) 
+constexpr VectorR3 operator-( const VectorR3& u, const VectorR3& v ) 
 { 
 	return VectorR3(u.x-v.x, u.y-v.y, u.z-v.z); 
 }
-inline VectorR3 operator*( const VectorR3& u, register double m) 
+constexpr VectorR3 operator*( const VectorR3& u, double m) 
 { 
 	return VectorR3( u.x*m, u.y*m, u.z*m); 
 }
-inline VectorR3 operator*( register double m, const VectorR3& u) 
+constexpr VectorR3 operator*( double m, const VectorR3& u) 
 { 
 	return VectorR3( u.x*m, u.y*m, u.z*m); 
 }
@@ -438,19 +454,19 @@ inline VectorR3 operator/( const VectorR3& u, double m)
 	return VectorR3( u.x*mInv, u.y*mInv, u.z*mInv); 
 }
 
-inline double operator^ ( const VectorR3& u, const VectorR3& v ) // Dot Product
+constexpr double operator^ ( const VectorR3& u, const VectorR3& v ) // Dot Product
 { 
 	return ( u.x*v.x + u.y*v.y + u.z*v.z ); 
 }
 
-inline VectorR3 operator* (const VectorR3& u, const VectorR3& v)	// Cross Product
+constexpr VectorR3 operator* (const VectorR3& u, const VectorR3& v)	// Cross Product
 {
 	return (VectorR3(	u.y*v.z - u.z*v.y,
 					u.z*v.x - u.x*v.z,
 					u.x*v.y - u.y*v.x  ) );
 }
 
-inline VectorR3 ArrayProd ( const VectorR3& u, const VectorR3& v )
+constexpr VectorR3 ArrayProd ( const VectorR3& u, const VectorR3& v )
 {
 	return ( VectorR3( u.x*v.x, u.y*v.y, u.z*v.z ) );
 }
@@ -508,6 +524,61 @@ inline VectorR3& VectorR3::SubtractFrom( const VectorR3& u  )
 	return(*this);
 }
 
+inline VectorR3& VectorR3::SetDifference( const VectorR3& u, const VectorR3& v )
+{
+	x = u.x - v.x;
+	y = u.y - v.y;
+	z = u.z - v.z;
+	return *this;
+}
+
+inline VectorR3& VectorR3::SetAddScaled( const VectorR3& u, const VectorR3& v, double s )
+{
+	x = u.x + s*v.x;
+	y = u.y + s*v.y;
+	z = u.z + s*v.z;
+	return *this;
+}
+
+inline VectorR3& VectorR3::SetLinearCombination( double a, const VectorR3& u, double b, const VectorR3& v )
+{
+	x = a*u.x + b*v.x;
+	y = a*u.y + b*v.y;
+	z = a*u.z + b*v.z;
+	return *this;
+}
+
+inline VectorR3& VectorR3::SetLinearCombination( double a, const VectorR3& u, double b, const VectorR3& v,
+												 double c, const VectorR3& w )
+{
+	x = a*u.x + b*v.x + c*w.x;
+	y = a*u.y + b*v.y + c*w.y;
+	z = a*u.z + b*v.z + c*w.z;
+	return *this;
+}
+
+// u or v may be *this
+inline VectorR3& VectorR3::SetCrossProduct( const VectorR3& u, const VectorR3& v )
+{
+	double xx = u.y*v.z - u.z*v.y;
+	double yy = u.z*v.x - u.x*v.z;
+	z = u.x*v.y - u.y*v.x;
+	x = xx;
+	y = yy;
+	return *this;
+}
+
+// The difference vectors are kept in locals, instead of two VectorR3 temporaries.
+inline VectorR3& VectorR3::SetTriangleNormal( const VectorR3& p0, const VectorR3& p1, const VectorR3& p2 )
+{
+	double ux = p1.x - p0.x, uy = p1.y - p0.y, uz = p1.z - p0.z;
+	double vx = p2.x - p0.x, vy = p2.y - p0.y, vz = p2.z - p0.z;
+	x = uy*vz - uz*vy;
+	y = uz*vx - ux*vz;
+	z = ux*vy - uy*vx;
+	return *this;
+}
+
 inline VectorR3& VectorR3::ReNormalize()			// Convert near unit back to unit
 {
 	double nSq = NormSq();
@@ -570,21 +641,14 @@ inline Matrix3x3::Matrix3x3( const VectorR3& u, const VectorR3& v,
 	m33 = s.z;
 }
 
-inline Matrix3x3::Matrix3x3( double a11, double a21, double a31,
+inline constexpr Matrix3x3::Matrix3x3( double a11, double a21, double a31,
 							 double a12, double a22, double a32,
 							 double a13, double a23, double a33)
 					// Values specified in column order!!!
-{
-	m11 = a11;		// Row 1
-	m12 = a12;
-	m13 = a13;
-	m21 = a21;		// Row 2
-	m22 = a22;
-	m23 = a23;
-	m31 = a31;		// Row 3
-	m32 = a32;
-	m33 = a33;
-}
+	: m11(a11), m21(a21), m31(a31),		// Column 1
+	  m12(a12), m22(a22), m32(a32),		// Column 2
+	  m13(a13), m23(a23), m33(a33)		// Column 3
+{ }
 	
 inline void Matrix3x3::SetIdentity ( )
 {
@@ -0,0 +1,227 @@
+/*
+ *
+ * LinearR3bis.cpp
+ *
+ * Affine maps on R3, as 3x4 matrices.  See LinearR3bis.h.
+ *
+ */
+
+#include "LinearR3bis.h"
+#include "Quaternion.h"
+
+// ******************************************************
+// * AffineMapR3 class - math library functions         *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+AffineMapR3& AffineMapR3::Set( const Matrix4x4& A )
+{
+    assert( A.m41 == 0.0 && A.m42 == 0.0 && A.m43 == 0.0 && A.m44 != 0.0 );
+    double wInv = 1.0 / A.m44;
+    return Set( A.m11*wInv, A.m21*wInv, A.m31*wInv, A.m12*wInv, A.m22*wInv, A.m32*wInv,
+                A.m13*wInv, A.m23*wInv, A.m33*wInv, A.m14*wInv, A.m24*wInv, A.m34*wInv );
+}
+
+float* AffineMapR3::DumpByColumns( float* ret ) const
+{
+    *ret = (float)m11;
+    *(ret+1) = (float)m21;
+    *(ret+2) = (float)m31;
+    *(ret+3) = 0.0f;
+    *(ret+4) = (float)m12;
+    *(ret+5) = (float)m22;
+    *(ret+6) = (float)m32;
+    *(ret+7) = 0.0f;
+    *(ret+8) = (float)m13;
+    *(ret+9) = (float)m23;
+    *(ret+10) = (float)m33;
+    *(ret+11) = 0.0f;
+    *(ret+12) = (float)m14;
+    *(ret+13) = (float)m24;
+    *(ret+14) = (float)m34;
+    *(ret+15) = 1.0f;
+    return ret;
+}
+
+// The columns of the inverse transpose of A = (c1 c2 c3) are the cross products
+//    c2*c3, c3*c1, c1*c2, divided by det(A) = c1^(c2*c3).
+float* AffineMapR3::DumpNormalMatrix( float* ret ) const
+{
+    double n11 = m22*m33 - m32*m23;         // c2*c3
+    double n21 = m32*m13 - m12*m33;
+    double n31 = m12*m23 - m22*m13;
+    double det = m11*n11 + m21*n21 + m31*n31;
+    assert( det != 0.0 );
+    double detInv = 1.0/det;
+    *ret = (float)(n11*detInv);
+    *(ret+1) = (float)(n21*detInv);
+    *(ret+2) = (float)(n31*detInv);
+    *(ret+3) = (float)((m23*m31 - m33*m21)*detInv);     // c3*c1
+    *(ret+4) = (float)((m33*m11 - m13*m31)*detInv);
+    *(ret+5) = (float)((m13*m21 - m23*m11)*detInv);
+    *(ret+6) = (float)((m21*m32 - m31*m22)*detInv);     // c1*c2
+    *(ret+7) = (float)((m31*m12 - m11*m32)*detInv);
+    *(ret+8) = (float)((m11*m22 - m21*m12)*detInv);
+    return ret;
+}
+
+float* AffineMapR3::DumpNormalMatrixRigid( float* ret ) const
+{
+    *ret = (float)m11;
+    *(ret+1) = (float)m21;
+    *(ret+2) = (float)m31;
+    *(ret+3) = (float)m12;
+    *(ret+4) = (float)m22;
+    *(ret+5) = (float)m32;
+    *(ret+6) = (float)m13;
+    *(ret+7) = (float)m23;
+    *(ret+8) = (float)m33;
+    return ret;
+}
+
+// The scaling factor squared is the squared norm of any column.
+float* AffineMapR3::DumpNormalMatrixUniformScale( float* ret ) const
+{
+    double sSq = m11*m11 + m21*m21 + m31*m31;
+    assert( sSq != 0.0 );
+    double sSqInv = 1.0/sSq;
+    *ret = (float)(m11*sSqInv);
+    *(ret+1) = (float)(m21*sSqInv);
+    *(ret+2) = (float)(m31*sSqInv);
+    *(ret+3) = (float)(m12*sSqInv);
+    *(ret+4) = (float)(m22*sSqInv);
+    *(ret+5) = (float)(m32*sSqInv);
+    *(ret+6) = (float)(m13*sSqInv);
+    *(ret+7) = (float)(m23*sSqInv);
+    *(ret+8) = (float)(m33*sSqInv);
+    return ret;
+}
+
+// The inverse of  x -> Ax + t  is  x -> A^{-1}x - A^{-1}t.
+AffineMapR3 AffineMapR3::Inverse() const
+{
+    // The nine subdeterminants, as in LinearMapR3::Inverse()
+    double sd11 = m22*m33-m23*m32;
+    double sd21 = m32*m13-m12*m33;
+    double sd31 = m12*m23-m22*m13;
+    double sd12 = m31*m23-m21*m33;
+    double sd22 = m11*m33-m31*m13;
+    double sd32 = m21*m13-m11*m23;
+    double sd13 = m21*m32-m31*m22;
+    double sd23 = m31*m12-m11*m32;
+    double sd33 = m11*m22-m21*m12;
+
+    double det = m11*sd11 + m12*sd12 + m13*sd13;
+    assert( det != 0.0 );
+    double detInv = 1.0/det;
+
+    AffineMapR3 ret( sd11*detInv, sd12*detInv, sd13*detInv,
+                     sd21*detInv, sd22*detInv, sd23*detInv,
+                     sd31*detInv, sd32*detInv, sd33*detInv, 0.0, 0.0, 0.0 );
+    ret.m14 = -(ret.m11*m14 + ret.m12*m24 + ret.m13*m34);
+    ret.m24 = -(ret.m21*m14 + ret.m22*m24 + ret.m23*m34);
+    ret.m34 = -(ret.m31*m14 + ret.m32*m24 + ret.m33*m34);
+    return ret;
+}
+
+// For a rigid map  x -> Rx + t,  the inverse is  x -> R^T x - R^T t.
+AffineMapR3 AffineMapR3::InverseRigid() const
+{
+    return AffineMapR3( m11, m12, m13, m21, m22, m23, m31, m32, m33,
+                        -(m11*m14 + m21*m24 + m31*m34),
+                        -(m12*m14 + m22*m24 + m32*m34),
+                        -(m13*m14 + m23*m24 + m33*m34) );
+}
+
+// The matrix entries are copied to locals, so the compiler can keep them in registers:
+//   otherwise it must assume the stores into dest might change them.
+void AffineMapR3::AffineTransformPositions( VectorR3* dest, int count ) const
+{
+    double a11 = m11, a21 = m21, a31 = m31, a12 = m12, a22 = m22, a32 = m32;
+    double a13 = m13, a23 = m23, a33 = m33, a14 = m14, a24 = m24, a34 = m34;
+    for (int i = 0; i < count; i++, dest++) {
+        double x = dest->x, y = dest->y, z = dest->z;
+        dest->x = a11*x + a12*y + a13*z + a14;
+        dest->y = a21*x + a22*y + a23*z + a24;
+        dest->z = a31*x + a32*y + a33*z + a34;
+    }
+}
+
+void AffineMapR3::AffineTransformDirections( VectorR3* dest, int count ) const
+{
+    double a11 = m11, a21 = m21, a31 = m31, a12 = m12, a22 = m22, a32 = m32;
+    double a13 = m13, a23 = m23, a33 = m33;
+    for (int i = 0; i < count; i++, dest++) {
+        double x = dest->x, y = dest->y, z = dest->z;
+        dest->x = a11*x + a12*y + a13*z;
+        dest->y = a21*x + a22*y + a23*z;
+        dest->z = a31*x + a32*y + a33*z;
+    }
+}
+
+AffineMapR3& AffineMapR3::Set_glRotate( double costheta, double sintheta, double x, double y, double z )
+{
+    double normSq = x * x + y * y + z * z;
+    assert(normSq > 0.0);
+    double normInv = 1.0 / sqrt(normSq);
+    x *= normInv;
+    y *= normInv;
+    z *= normInv;
+    double omC = 1 - costheta;
+    double omCx = omC * x;
+    double omCy = omC * y;
+    double omCz = omC * z;
+    m11 = omCx * x + costheta;
+    m21 = omCx * y + sintheta * z;
+    m31 = omCx * z - sintheta * y;
+    m12 = omCy * x - sintheta * z;
+    m22 = omCy * y + costheta;
+    m32 = omCy * z + sintheta * x;
+    m13 = omCz * x + sintheta * y;
+    m23 = omCz * y - sintheta * x;
+    m33 = omCz * z + costheta;
+    m14 = m24 = m34 = 0.0;
+    return *this;
+}
+
+AffineMapR3& AffineMapR3::Set_glRotate( const Quaternion& q )
+{
+    Matrix3x3 R;
+    q.ToMatrix3x3( &R );
+    return Set3x3( R );
+}
+
+AffineMapR3& AffineMapR3::Mult_glRotate( const Quaternion& q )
+{
+    Matrix3x3 R;
+    q.ToMatrix3x3( &R );
+    MultLinearPart( R.m11, R.m21, R.m31, R.m12, R.m22, R.m32, R.m13, R.m23, R.m33 );
+    return *this;
+}
+
+AffineMapR3& AffineMapR3::Set_gluLookAt( const VectorR3& eyePos, const VectorR3& lookAtPos, const VectorR3& upDir )
+{
+    LinearMapR4 A;
+    return Set( A.Set_gluLookAt(eyePos, lookAtPos, upDir) );
+}
+
+// The product of a 4x4 matrix and an affine map.  This is how a projection
+//   matrix is applied: the fourth column of B is the only one with a 1 in the last row.
+LinearMapR4 operator* ( const LinearMapR4& A, const AffineMapR3& B )
+{
+    return LinearMapR4( A.m11*B.m11 + A.m12*B.m21 + A.m13*B.m31,
+                        A.m21*B.m11 + A.m22*B.m21 + A.m23*B.m31,
+                        A.m31*B.m11 + A.m32*B.m21 + A.m33*B.m31,
+                        A.m41*B.m11 + A.m42*B.m21 + A.m43*B.m31,
+                        A.m11*B.m12 + A.m12*B.m22 + A.m13*B.m32,
+                        A.m21*B.m12 + A.m22*B.m22 + A.m23*B.m32,
+                        A.m31*B.m12 + A.m32*B.m22 + A.m33*B.m32,
+                        A.m41*B.m12 + A.m42*B.m22 + A.m43*B.m32,
+                        A.m11*B.m13 + A.m12*B.m23 + A.m13*B.m33,
+                        A.m21*B.m13 + A.m22*B.m23 + A.m23*B.m33,
+                        A.m31*B.m13 + A.m32*B.m23 + A.m33*B.m33,
+                        A.m41*B.m13 + A.m42*B.m23 + A.m43*B.m33,
+                        A.m11*B.m14 + A.m12*B.m24 + A.m13*B.m34 + A.m14,
+                        A.m21*B.m14 + A.m22*B.m24 + A.m23*B.m34 + A.m24,
+                        A.m31*B.m14 + A.m32*B.m24 + A.m33*B.m34 + A.m34,
+                        A.m41*B.m14 + A.m42*B.m24 + A.m43*B.m34 + A.m44 );
+}
@@ -69,8 +69,8 @@ public:
 	//static const VectorR4 NegUnitW;
 
 public:
-	VectorR4( ) : x(0.0), y(0.0), z(0.0), w(0.0) {}
-	VectorR4( double xVal, double yVal, double zVal, double wVal )
+	constexpr VectorR4( ) : x(0.0), y(0.0), z(0.0), w(0.0) {}
+	constexpr VectorR4( double xVal, double yVal, double zVal, double wVal )
 		: x(xVal), y(yVal), z(zVal), w(wVal) {}
 	// VectorR4( const Quaternion& q);			// Definition with Quaternion routines
 	
@@ -107,6 +107,11 @@ public:
 
 	VectorR4& AddScaled( const VectorR4& u, double s );
 
+	// Fused operations, with no VectorR4 temporaries.  See VectorR3.
+	VectorR4& SetDifference( const VectorR4& u, const VectorR4& v );		// u - v
+	VectorR4& SetAddScaled( const VectorR4& u, const VectorR4& v, double s );	// u + s*v
+	VectorR4& SetLinearCombination( double a, const VectorR4& u, double b, const VectorR4& v );	// a*u + b*v
+
 	double Norm() const { return ( (double)sqrt( x*x + y*y + z*z +w*w) ); }
 	double NormSq() const { return ( x*x + y*y + z*z + w*w ); }
 	double Dist( const VectorR4& u ) const;	// Distance from u
@@ -129,16 +134,16 @@ public:
 
 };
 
-inline VectorR4 operator+( const VectorR4& u, const VectorR4& v );
-inline VectorR4 operator-( const VectorR4& u, const VectorR4& v ); 
-inline VectorR4 operator*( const VectorR4& u, double m); 
-inline VectorR4 operator*( double m, const VectorR4& u); 
+constexpr VectorR4 operator+( const VectorR4& u, const VectorR4& v );
+constexpr VectorR4 operator-( const VectorR4& u, const VectorR4& v ); 
+constexpr VectorR4 operator*( const VectorR4& u, double m); 
+constexpr VectorR4 operator*( double m, const VectorR4& u); 
 inline VectorR4 operator/( const VectorR4& u, double m); 
 inline bool operator==( const VectorR4& u, const VectorR4& v ); 
 
-inline double operator^ (const VectorR4& u, const VectorR4& v ); // Dot Product
-inline double InnerProduct(const VectorR4& u, const VectorR4& v ) { return (u^v); }
-inline VectorR4 ArrayProd(const VectorR4& u, const VectorR4& v );
+constexpr double operator^ (const VectorR4& u, const VectorR4& v ); // Dot Product
+constexpr double InnerProduct(const VectorR4& u, const VectorR4& v ) { return (u^v); }
+constexpr VectorR4 ArrayProd(const VectorR4& u, const VectorR4& v );
 
 inline double Mag(const VectorR4& u) { return u.Norm(); }
 inline double Dist(const VectorR4& u, const VectorR4& v) { return u.Dist(v); }
@@ -164,7 +169,7 @@ public:
 	Matrix4x4();
 	Matrix4x4( const VectorR4&, const VectorR4&, 
 					const VectorR4&, const VectorR4& );	// Sets by columns!
-	Matrix4x4( double, double, double, double, 
+	constexpr Matrix4x4( double, double, double, double, 
 					 double, double, double, double,
 					 double, double, double, double,
 					 double, double, double, double );	// Sets by columns
@@ -227,7 +232,7 @@ public:
 	LinearMapR4();
 	LinearMapR4( const VectorR4&, const VectorR4&, 
 					const VectorR4&, const VectorR4& );	// Sets by columns!
-	LinearMapR4( double, double, double, double, 
+	constexpr LinearMapR4( double, double, double, double, 
 					 double, double, double, double,
 					 double, double, double, double,
 					 double, double, double, double );	// Sets by columns
@@ -430,19 +435,19 @@ inline VectorR4& VectorR4::MakeUnit ()			// Convert to unit vector (or leave zer
 	return *this;
 }
 
-inline VectorR4 operator+( const VectorR4& u, const VectorR4& v ) 
+constexpr VectorR4 operator+( const VectorR4& u, const VectorR4& v ) 
 { 
 	return VectorR4(u.x+v.x, u.y+v.y, u.z+v.z, u.w+v.w ); 
 }
-inline VectorR4 operator-( const VectorR4& u, const VectorR4& v ) 
+constexpr VectorR4 operator-( const VectorR4& u, const VectorR4& v ) 
 { 
 	return VectorR4(u.x-v.x, u.y-v.y, u.z-v.z, u.w-v.w); 
 }
-inline VectorR4 operator*( const VectorR4& u, register double m) 
+constexpr VectorR4 operator*( const VectorR4& u, double m) 
 { 
 	return VectorR4( u.x*m, u.y*m, u.z*m, u.w*m ); 
 }
-inline VectorR4 operator*( register double m, const VectorR4& u) 
+constexpr VectorR4 operator*( double m, const VectorR4& u) 
 { 
 	return VectorR4( u.x*m, u.y*m, u.z*m, u.w*m ); 
 }
@@ -457,12 +462,12 @@ inline bool operator==( const VectorR4& u, const VectorR4& v )
 	return ( u.x==v.x && u.y==v.y && u.z==v.z && u.w==v.w );
 }
 
-inline double operator^ ( const VectorR4& u, const VectorR4& v ) // Dot Product
+constexpr double operator^ ( const VectorR4& u, const VectorR4& v ) // Dot Product
 { 
 	return ( u.x*v.x + u.y*v.y + u.z*v.z + u.w*v.w ); 
 }
 
-inline VectorR4 ArrayProd ( const VectorR4& u, const VectorR4& v )
+constexpr VectorR4 ArrayProd ( const VectorR4& u, const VectorR4& v )
 {
 	return ( VectorR4( u.x*v.x, u.y*v.y, u.z*v.z, u.w*v.w ) );
 }
@@ -493,6 +498,33 @@ inline VectorR4& VectorR4::AddScaled( const VectorR4& u, double s )
 	return(*this);
 }
 
+inline VectorR4& VectorR4::SetDifference( const VectorR4& u, const VectorR4& v )
+{
+	x = u.x - v.x;
+	y = u.y - v.y;
+	z = u.z - v.z;
+	w = u.w - v.w;
+	return *this;
+}
+
+inline VectorR4& VectorR4::SetAddScaled( const VectorR4& u, const VectorR4& v, double s )
+{
+	x = u.x + s*v.x;
+	y = u.y + s*v.y;
+	z = u.z + s*v.z;
+	w = u.w + s*v.w;
+	return *this;
+}
+
+inline VectorR4& VectorR4::SetLinearCombination( double a, const VectorR4& u, double b, const VectorR4& v )
+{
+	x = a*u.x + b*v.x;
+	y = a*u.y + b*v.y;
+	z = a*u.z + b*v.z;
+	w = a*u.w + b*v.w;
+	return *this;
+}
+
 inline VectorR4& VectorR4::ReNormalize()			// Convert near unit back to unit
 {
 	double nSq = NormSq();
@@ -557,29 +589,16 @@ inline Matrix4x4::Matrix4x4( const VectorR4& u, const VectorR4& v,
 	m44 = t.w;
 }
 
-inline Matrix4x4::Matrix4x4( double a11, double a21, double a31, double a41,
+inline constexpr Matrix4x4::Matrix4x4( double a11, double a21, double a31, double a41,
 							 double a12, double a22, double a32, double a42,
 							 double a13, double a23, double a33, double a43,
 							 double a14, double a24, double a34, double a44)
 					// Values specified in column order!!!
-{
-	m11 = a11;		// Row 1
-	m12 = a12;
-	m13 = a13;
-	m14 = a14;
-	m21 = a21;		// Row 2
-	m22 = a22;
-	m23 = a23;
-	m24 = a24;
-	m31 = a31;		// Row 3
-	m32 = a32;
-	m33 = a33;
-	m34 = a34;
-	m41 = a41;		// Row 4
-	m42 = a42;
-	m43 = a43;
-	m44 = a44;
-}
+	: m11(a11), m21(a21), m31(a31), m41(a41),		// Column 1
+	  m12(a12), m22(a22), m32(a32), m42(a42),		// Column 2
+	  m13(a13), m23(a23), m33(a33), m43(a43),		// Column 3
+	  m14(a14), m24(a24), m34(a34), m44(a44)		// Column 4
+{ }
 
 /*
 inline Matrix4x4::Matrix4x4 ( const Matrix4x4& A)
@@ -872,7 +891,7 @@ inline LinearMapR4::LinearMapR4( const VectorR4& u, const VectorR4& v,
 :Matrix4x4 ( u, v, s ,t )
 { }
 
-inline LinearMapR4::LinearMapR4( 
+inline constexpr LinearMapR4::LinearMapR4( 
 							 double a11, double a21, double a31, double a41,
 							 double a12, double a22, double a32, double a42,
 							 double a13, double a23, double a33, double a43,
@@ -0,0 +1,353 @@
+/*
+ *
+ * LinearR4f.cpp
+ *
+ * Single precision 4x4 matrices.  See LinearR4f.h.
+ *
+ */
+
+#include "LinearR4f.h"
+
+#include <assert.h>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+// ******************************************************
+// * LinearMapR4f class - math library functions        *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+LinearMapR4f& LinearMapR4f::Set( const Matrix4x4& A )
+{
+    return Set( (float)A.m11, (float)A.m21, (float)A.m31, (float)A.m41,
+                (float)A.m12, (float)A.m22, (float)A.m32, (float)A.m42,
+                (float)A.m13, (float)A.m23, (float)A.m33, (float)A.m43,
+                (float)A.m14, (float)A.m24, (float)A.m34, (float)A.m44 );
+}
+
+LinearMapR4 LinearMapR4f::ToLinearMapR4() const
+{
+    return LinearMapR4( m11, m21, m31, m41, m12, m22, m32, m42,
+                        m13, m23, m33, m43, m14, m24, m34, m44 );
+}
+
+#ifdef USE_SSE2
+namespace {
+    // Selects (a[i], a[j], b[k], b[l])
+    #define SHUFFLE_R4F(a, b, i, j, k, l) _mm_shuffle_ps(a, b, _MM_SHUFFLE(l, k, j, i))
+    #define SWIZZLE_R4F(a, i, j, k, l) _mm_shuffle_ps(a, a, _MM_SHUFFLE(l, k, j, i))
+
+    // 2x2 matrices are held as (a11, a12, a21, a22).  A# denotes the adjugate of A.
+    inline __m128 Mat2Mult(__m128 a, __m128 b)         // A*B
+    {
+        return _mm_add_ps(_mm_mul_ps(a, SWIZZLE_R4F(b, 0, 3, 0, 3)),
+                          _mm_mul_ps(SWIZZLE_R4F(a, 1, 0, 3, 2), SWIZZLE_R4F(b, 2, 1, 2, 1)));
+    }
+    inline __m128 Mat2AdjMult(__m128 a, __m128 b)      // A#*B
+    {
+        return _mm_sub_ps(_mm_mul_ps(SWIZZLE_R4F(a, 3, 3, 0, 0), b),
+                          _mm_mul_ps(SWIZZLE_R4F(a, 1, 1, 2, 2), SWIZZLE_R4F(b, 2, 3, 0, 1)));
+    }
+    inline __m128 Mat2MultAdj(__m128 a, __m128 b)      // A*B#
+    {
+        return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE_R4F(b, 3, 0, 3, 0)),
+                          _mm_mul_ps(SWIZZLE_R4F(a, 1, 0, 3, 2), SWIZZLE_R4F(b, 2, 1, 2, 1)));
+    }
+}
+#endif
+
+// The inverse is calculated blockwise, from the 2x2 blocks  M = ( A B )
+//                                                               ( C D ).
+//   The four 2x2 blocks of the inverse are
+//        X = (|D|A - B(D#C))#,   Y = (|B|C - D(A#B)#)#,
+//        Z = (|C|B - A(D#C)#)#,  W = (|A|D - C(A#B))#,
+//   all divided by |M| = |A||D| + |B||C| - trace((A#B)(D#C)).
+// The inverse of the transpose is the transpose of the inverse, so this works
+//   equally well with the columns of M in place of the rows.
+// Without SSE2, the inverse is calculated in double precision by LinearMapR4.
+LinearMapR4f LinearMapR4f::Inverse() const
+{
+#ifdef USE_SSE2
+    __m128 c1 = _mm_load_ps(Column(0));
+    __m128 c2 = _mm_load_ps(Column(1));
+    __m128 c3 = _mm_load_ps(Column(2));
+    __m128 c4 = _mm_load_ps(Column(3));
+    __m128 A = _mm_movelh_ps(c1, c2);
+    __m128 B = _mm_movehl_ps(c2, c1);
+    __m128 C = _mm_movelh_ps(c3, c4);
+    __m128 D = _mm_movehl_ps(c4, c3);
+
+    // The four 2x2 determinants (|A|, |B|, |C|, |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(SHUFFLE_R4F(c1, c3, 0, 2, 0, 2), SHUFFLE_R4F(c2, c4, 1, 3, 1, 3)),
+        _mm_mul_ps(SHUFFLE_R4F(c1, c3, 1, 3, 1, 3), SHUFFLE_R4F(c2, c4, 0, 2, 0, 2)));
+    __m128 detA = SWIZZLE_R4F(detSub, 0, 0, 0, 0);
+    __m128 detB = SWIZZLE_R4F(detSub, 1, 1, 1, 1);
+    __m128 detC = SWIZZLE_R4F(detSub, 2, 2, 2, 2);
+    __m128 detD = SWIZZLE_R4F(detSub, 3, 3, 3, 3);
+
+    __m128 DadjC = Mat2AdjMult(D, C);
+    __m128 AadjB = Mat2AdjMult(A, B);
+    __m128 Xadj = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mult(B, DadjC));
+    __m128 Wadj = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mult(C, AadjB));
+    __m128 Yadj = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MultAdj(D, AadjB));
+    __m128 Zadj = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MultAdj(A, DadjC));
+
+    __m128 tr = _mm_mul_ps(AadjB, SWIZZLE_R4F(DadjC, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, SWIZZLE_R4F(tr, 2, 3, 0, 1));
+    tr = _mm_add_ps(tr, SWIZZLE_R4F(tr, 1, 0, 3, 2));       // trace((A#B)(D#C)) in all four entries
+    __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+    // The signs for taking the adjugates, divided by |M|
+    __m128 detMInv = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    Xadj = _mm_mul_ps(Xadj, detMInv);
+    Yadj = _mm_mul_ps(Yadj, detMInv);
+    Zadj = _mm_mul_ps(Zadj, detMInv);
+    Wadj = _mm_mul_ps(Wadj, detMInv);
+
+    LinearMapR4f ret;
+    _mm_store_ps(ret.Column(0), SHUFFLE_R4F(Xadj, Yadj, 3, 1, 3, 1));
+    _mm_store_ps(ret.Column(1), SHUFFLE_R4F(Xadj, Yadj, 2, 0, 2, 0));
+    _mm_store_ps(ret.Column(2), SHUFFLE_R4F(Zadj, Wadj, 3, 1, 3, 1));
+    _mm_store_ps(ret.Column(3), SHUFFLE_R4F(Zadj, Wadj, 2, 0, 2, 0));
+    return ret;
+#else
+    return LinearMapR4f(ToLinearMapR4().Inverse());
+#endif
+}
+
+// Multiply a VectorR3 postion by an affine transformation.
+//     The w component of the VectorR3 object is treated as equal to 1.0.
+void LinearMapR4f::AffineTransformPosition( VectorR3& dest ) const
+{
+    assert(IsAffine());
+    alignas(16) float v[4] = { (float)dest.x, (float)dest.y, (float)dest.z, 1.0f };
+    Transform(v, v);
+    float wInv = 1.0f / m44;
+    dest.Set(v[0] * wInv, v[1] * wInv, v[2] * wInv);
+}
+
+// Multiply a VectorR3 direction vector by an affine transformation.
+//     The w component of the VectorR3 object is treated as equal to 0.0.
+void LinearMapR4f::AffineTransformDirection( VectorR3& dest ) const
+{
+    assert(IsAffine());
+    alignas(16) float v[4] = { (float)dest.x, (float)dest.y, (float)dest.z, 0.0f };
+    Transform(v, v);
+    dest.Set(v[0], v[1], v[2]);
+}
+
+LinearMapR4f& LinearMapR4f::Set_glRotate( float costheta, float sintheta, float x, float y, float z )
+{
+    float normSq = x * x + y * y + z * z;
+    assert(normSq > 0.0f);
+    float normInv = 1.0f / sqrtf(normSq);
+    x *= normInv;
+    y *= normInv;
+    z *= normInv;
+    float omC = 1.0f - costheta;
+    float omCx = omC * x;
+    float omCy = omC * y;
+    float omCz = omC * z;
+    m11 = omCx * x + costheta;
+    m21 = omCx * y + sintheta * z;
+    m31 = omCx * z - sintheta * y;
+    m12 = omCy * x - sintheta * z;
+    m22 = omCy * y + costheta;
+    m32 = omCy * z + sintheta * x;
+    m13 = omCz * x + sintheta * y;
+    m23 = omCz * y - sintheta * x;
+    m33 = omCz * z + costheta;
+    m41 = m42 = m43 = m14 = m24 = m34 = 0.0f;
+    m44 = 1.0f;
+    return *this;
+}
+
+// The projection and viewing matrices are set up once per frame:
+//   they are calculated in double precision by LinearMapR4.
+
+LinearMapR4f& LinearMapR4f::Set_glFrustum( double left, double right, double bottom, double top, double near, double far )
+{
+    LinearMapR4 A;
+    return Set(A.Set_glFrustum(left, right, bottom, top, near, far));
+}
+
+LinearMapR4f& LinearMapR4f::Set_glOrtho( double left, double right, double bottom, double top, double near, double far )
+{
+    LinearMapR4 A;
+    return Set(A.Set_glOrtho(left, right, bottom, top, near, far));
+}
+
+LinearMapR4f& LinearMapR4f::Set_gluPerspective( double fieldofview_y_Radians, double aspectRatio, double zNear, double zFar )
+{
+    LinearMapR4 A;
+    return Set(A.Set_gluPerspective(fieldofview_y_Radians, aspectRatio, zNear, zFar));
+}
+
+LinearMapR4f& LinearMapR4f::Set_gluLookAt( const VectorR3& eyePos, const VectorR3& lookAtPos, const VectorR3& upDir )
+{
+    LinearMapR4 A;
+    return Set(A.Set_gluLookAt(eyePos, lookAtPos, upDir));
+}
+
+// The columns of the inverse transpose of A = (c1 c2 c3) are the cross products
+//    c2*c3, c3*c1, c1*c2, divided by det(A) = c1^(c2*c3).  About 30 multiplications,
+//    and one division, per matrix.
+// For a rigid map the 3x3 part is its own inverse transpose.  For a rigid map times a uniform
+//    scaling by s, it is A/s^2, and s^2 is the squared norm of any column.
+//    (Checking for these cases per matrix costs as much as the general case, so the caller says.)
+void LinearMapR4f::NormalMatrices( const float* src, float* dest, int count, int srcStride, int destStride,
+                                   TransformKind kind )
+{
+    if ( kind != GeneralTransform ) {
+        for ( int i = 0; i < count; i++, src += srcStride, dest += destStride ) {
+            float sSqInv = 1.0f;
+            if ( kind == UniformScaleTransform ) {
+                float sSq = src[0]*src[0] + src[1]*src[1] + src[2]*src[2];
+                assert( sSq != 0.0f );
+                sSqInv = 1.0f/sSq;
+            }
+            for ( int j = 0; j < 3; j++ ) {
+                dest[3*j] = src[4*j]*sSqInv;
+                dest[3*j+1] = src[4*j+1]*sSqInv;
+                dest[3*j+2] = src[4*j+2]*sSqInv;
+            }
+        }
+        return;
+    }
+    for ( int i = 0; i < count; i++, src += srcStride, dest += destStride ) {
+        float a11 = src[0], a21 = src[1], a31 = src[2];         // Column 1
+        float a12 = src[4], a22 = src[5], a32 = src[6];         // Column 2
+        float a13 = src[8], a23 = src[9], a33 = src[10];        // Column 3
+        float n11 = a22*a33 - a32*a23;
+        float n21 = a32*a13 - a12*a33;
+        float n31 = a12*a23 - a22*a13;
+        float det = a11*n11 + a21*n21 + a31*n31;
+        assert( det != 0.0f );
+        float detInv = 1.0f/det;
+        dest[0] = n11*detInv;
+        dest[1] = n21*detInv;
+        dest[2] = n31*detInv;
+        dest[3] = (a23*a31 - a33*a21)*detInv;
+        dest[4] = (a33*a11 - a13*a31)*detInv;
+        dest[5] = (a13*a21 - a23*a11)*detInv;
+        dest[6] = (a21*a32 - a31*a22)*detInv;
+        dest[7] = (a31*a12 - a11*a32)*detInv;
+        dest[8] = (a11*a22 - a21*a12)*detInv;
+    }
+}
+
+// ******************************************************
+// * LinearMapR4f class - batch transformations          *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+namespace {
+    // Calls rangeFunc(begin, end) on consecutive subranges covering [0,count).
+    //   If useThreads is true and count is large, the subranges run on worker threads.
+    void BatchRanges( int count, bool useThreads, const std::function<void(int, int)>& rangeFunc )
+    {
+        const int minVectorsPerThread = 1 << 14;
+        int numThreads = useThreads ? Min((int)std::thread::hardware_concurrency(), count / minVectorsPerThread) : 1;
+        if (numThreads <= 1) {
+            rangeFunc(0, count);
+            return;
+        }
+        std::vector<std::future<void>> parts;
+        for (int t = 1; t < numThreads; t++) {
+            parts.push_back(std::async(std::launch::async, rangeFunc,
+                (int)((long long)count * t / numThreads), (int)((long long)count * (t + 1) / numThreads)));
+        }
+        rangeFunc(0, count / numThreads);
+        for (size_t t = 0; t < parts.size(); t++) {
+            parts[t].get();
+        }
+    }
+}
+
+void LinearMapR4f::TransformPositions( const float* src, float* dest, int count,
+                                       int srcStride, int destStride, bool useThreads ) const
+{
+    BatchRanges(count, useThreads, [&](int begin, int end) {
+        TransformPoints(src + (size_t)srcStride * begin, dest + (size_t)destStride * begin,
+                        end - begin, srcStride, destStride, 1.0f);
+    });
+}
+
+void LinearMapR4f::TransformDirections( const float* src, float* dest, int count,
+                                        int srcStride, int destStride, bool useThreads ) const
+{
+    BatchRanges(count, useThreads, [&](int begin, int end) {
+        TransformPoints(src + (size_t)srcStride * begin, dest + (size_t)destStride * begin,
+                        end - begin, srcStride, destStride, 0.0f);
+    });
+}
+
+// Transforms (x,y,z,w) for each of the count vectors, and stores x, y and z.
+void LinearMapR4f::TransformPoints( const float* src, float* dest, int count,
+                                    int srcStride, int destStride, float w ) const
+{
+    assert(srcStride >= 3 && destStride >= 3);
+#ifdef USE_SSE2
+    __m128 c1 = _mm_load_ps(Column(0));
+    __m128 c2 = _mm_load_ps(Column(1));
+    __m128 c3 = _mm_load_ps(Column(2));
+    __m128 c4w = _mm_mul_ps(_mm_load_ps(Column(3)), _mm_set1_ps(w));
+    for (int i = 0; i < count; i++, src += srcStride, dest += destStride) {
+        __m128 r = _mm_add_ps(c4w, _mm_mul_ps(c1, _mm_set1_ps(src[0])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(src[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(src[2])));
+        _mm_storel_pi((__m64*)dest, r);             // x and y
+        _mm_store_ss(dest + 2, _mm_movehl_ps(r, r));    // z  (Do not write past the three floats)
+    }
+#else
+    float a11 = m11, a21 = m21, a31 = m31, a12 = m12, a22 = m22, a32 = m32, a13 = m13, a23 = m23, a33 = m33;
+    float t1 = m14 * w, t2 = m24 * w, t3 = m34 * w;
+    for (int i = 0; i < count; i++, src += srcStride, dest += destStride) {
+        float x = src[0], y = src[1], z = src[2];
+        dest[0] = a11*x + a12*y + a13*z + t1;
+        dest[1] = a21*x + a22*y + a23*z + t2;
+        dest[2] = a31*x + a32*y + a33*z + t3;
+    }
+#endif
+}
+
+void LinearMapR4f::TransformPositionsSoA( const float* x, const float* y, const float* z,
+                                          float* destX, float* destY, float* destZ, int count, bool useThreads ) const
+{
+    BatchRanges(count, useThreads, [&](int begin, int end) {
+        int i = begin;
+#ifdef USE_SSE2
+        // Four positions at a time: each entry of the matrix is broadcast to all four lanes.
+        __m128 a11 = _mm_set1_ps(m11), a12 = _mm_set1_ps(m12), a13 = _mm_set1_ps(m13), a14 = _mm_set1_ps(m14);
+        __m128 a21 = _mm_set1_ps(m21), a22 = _mm_set1_ps(m22), a23 = _mm_set1_ps(m23), a24 = _mm_set1_ps(m24);
+        __m128 a31 = _mm_set1_ps(m31), a32 = _mm_set1_ps(m32), a33 = _mm_set1_ps(m33), a34 = _mm_set1_ps(m34);
+        for (; i + 4 <= end; i += 4) {
+            __m128 vx = _mm_loadu_ps(x + i);
+            __m128 vy = _mm_loadu_ps(y + i);
+            __m128 vz = _mm_loadu_ps(z + i);
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a11, vx), _mm_mul_ps(a12, vy)), _mm_add_ps(_mm_mul_ps(a13, vz), a14));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a21, vx), _mm_mul_ps(a22, vy)), _mm_add_ps(_mm_mul_ps(a23, vz), a24));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a31, vx), _mm_mul_ps(a32, vy)), _mm_add_ps(_mm_mul_ps(a33, vz), a34));
+            _mm_storeu_ps(destX + i, rx);
+            _mm_storeu_ps(destY + i, ry);
+            _mm_storeu_ps(destZ + i, rz);
+        }
+#endif
+        for (; i < end; i++) {
+            float vx = x[i], vy = y[i], vz = z[i];
+            destX[i] = m11*vx + m12*vy + (m13*vz + m14);
+            destY[i] = m21*vx + m22*vy + (m23*vz + m24);
+            destZ[i] = m31*vx + m32*vy + (m33*vz + m34);
+        }
+    });
+}
+
+void LinearMapR4f::TransformVectors( const float* src, float* dest, int count, bool useThreads ) const
+{
+    BatchRanges(count, useThreads, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            Transform(src + 4 * (size_t)i, dest + 4 * (size_t)i);
+        }
+    });
+}
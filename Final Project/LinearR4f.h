@@ -0,0 +1,340 @@
+/*
+ *
+ * LinearR4f.h
+ *
+ * Single precision 4x4 matrices, for the OpenGL modelview and projection matrices.
+ *
+ *   A LinearMapR4f holds 16 floats in column order, aligned on a 16 byte boundary:
+ *   exactly the layout expected by glUniformMatrix4fv. So it can be uploaded with
+ *   no conversion (use Data() or DumpByColumns()).
+ *   It has the same Set_gl* and Mult_gl* routines as LinearMapR4, and converts to
+ *   and from LinearMapR4, so code can be changed over one matrix at a time.
+ *
+ *   The matrix product, the transformation of vectors and the inverse use SSE2
+ *   when it is available (see USE_SSE2 in MathMisc.h).
+ *
+ */
+
+#ifndef LINEAR_R4F_H
+#define LINEAR_R4F_H
+
+#include <string.h>
+#include "LinearR4.h"
+#include "MathMisc.h"
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+class LinearMapR4f;
+
+// *****************************************
+// LinearMapR4f class                      *
+// * * * * * * * * * * * * * * * * * * * * *
+
+class alignas(16) LinearMapR4f {
+
+public:
+    // m_i_j - row-i and column-j entry. The entries are stored by columns.
+    float m11, m21, m31, m41, m12, m22, m32, m42,
+          m13, m23, m33, m43, m14, m24, m34, m44;
+
+public:
+    LinearMapR4f() {}
+    constexpr LinearMapR4f( float, float, float, float,
+                  float, float, float, float,
+                  float, float, float, float,
+                  float, float, float, float );     // Sets by columns
+    explicit LinearMapR4f( const Matrix4x4& A ) { Set(A); }
+
+    // Conversions to and from double precision
+    LinearMapR4f& Set( const Matrix4x4& A );
+    LinearMapR4 ToLinearMapR4() const;
+
+    LinearMapR4f& SetIdentity();
+    LinearMapR4f& SetZero();
+    LinearMapR4f& Set( float, float, float, float,
+                       float, float, float, float,
+                       float, float, float, float,
+                       float, float, float, float );  // Sets by columns
+    LinearMapR4f& LoadByColumns( const float* );
+
+    // The 16 entries in column order, e.g., for glUniformMatrix4fv.
+    const float* Data() const { return &m11; }
+    float* DumpByColumns( float* ret ) const { memcpy(ret, &m11, 16 * sizeof(float)); return ret; }
+
+    LinearMapR4f& operator*= ( const LinearMapR4f& B );     // Matrix product
+
+    LinearMapR4f Inverse() const;           // Returns inverse
+    LinearMapR4f& Invert();                 // Converts into inverse.
+
+    // dest = M*v, for a vector v of four floats.  v and dest may be the same.
+    void Transform( const float* v, float* dest ) const;
+    bool IsAffine() const { return m41 == 0.0f && m42 == 0.0f && m43 == 0.0f && m44 != 0.0f; }
+    void AffineTransformPosition( VectorR3& dest ) const;
+    void AffineTransformDirection( VectorR3& dest ) const;
+
+    // Batch transformations of count vectors, for arrays such as VBO data.
+    //   Positions and directions have three floats (x,y,z); the stride is in floats,
+    //   so the positions in a VBO with 8 floats per vertex use stride 8.
+    //   Positions are transformed with w = 1, directions with w = 0; the matrix should be affine.
+    //   The source and destination may be the same array (with the same stride).
+    //   If useThreads is true, large arrays are split across worker threads.
+    void TransformPositions( const float* src, float* dest, int count,
+                             int srcStride = 3, int destStride = 3, bool useThreads = false ) const;
+    void TransformDirections( const float* src, float* dest, int count,
+                              int srcStride = 3, int destStride = 3, bool useThreads = false ) const;
+    // Positions stored as separate x, y and z arrays (structure of arrays): four at a time with SSE2.
+    void TransformPositionsSoA( const float* x, const float* y, const float* z,
+                                float* destX, float* destY, float* destZ, int count, bool useThreads = false ) const;
+    // Vectors of four floats (x,y,z,w), packed one after another.
+    void TransformVectors( const float* src, float* dest, int count, bool useThreads = false ) const;
+
+    // The normal matrix: the inverse transpose of the upper 3x3 part, as 9 floats in column order.
+    void DumpNormalMatrix( float* dest ) const { NormalMatrices( &m11, dest, 1 ); }
+    // Batched normal matrices, for count 4x4 matrices in column order (as from DumpByColumns).
+    //   The strides are in floats.  The matrices and the normal matrices may be interleaved
+    //   in one array, e.g., in an instance buffer with a matrix and its normal matrix per instance.
+    //   If the caller knows all the matrices are rigid, or rigid times a uniform scaling, the
+    //   inverse is not needed: the normal matrix is the 3x3 part, or the 3x3 part divided by
+    //   the square of the scaling.  (As for AffineMapR3::DumpNormalMatrixRigid, etc.)
+    enum TransformKind { GeneralTransform, UniformScaleTransform, RigidTransform };
+    static void NormalMatrices( const float* src, float* dest, int count,
+                                int srcStride = 16, int destStride = 9, TransformKind kind = GeneralTransform );
+
+    // Reproduce OpenGL Projection and Modelview Matrix operations, as for LinearMapR4.
+    //  EXCEPT: these routines use radians, not degrees.  (!)
+    LinearMapR4f& Set_glScale( float xyzScale );
+    LinearMapR4f& Mult_glScale( float xyzScale );
+    LinearMapR4f& Set_glScale( float xScale, float yScale, float zScale );
+    LinearMapR4f& Mult_glScale( float xScale, float yScale, float zScale );
+    LinearMapR4f& Set_glTranslate( float xTranslation, float yTranslation, float zTranslation );
+    LinearMapR4f& Mult_glTranslate( float xTranslation, float yTranslation, float zTranslation );
+    LinearMapR4f& Set_glTranslate( const VectorR3& translation );
+    LinearMapR4f& Mult_glTranslate( const VectorR3& translation );
+    LinearMapR4f& Set_glRotate( float radians, float x, float y, float z );
+    LinearMapR4f& Mult_glRotate( float radians, float x, float y, float z );
+    LinearMapR4f& Set_glRotate( float radians, const VectorR3& axis );
+    LinearMapR4f& Mult_glRotate( float radians, const VectorR3& axis );
+    LinearMapR4f& Set_glRotate( float costheta, float sintheta, float x, float y, float z );
+    LinearMapR4f& Mult_glRotate( float costheta, float sintheta, float x, float y, float z );
+    LinearMapR4f& Set_glFrustum( double left, double right, double bottom, double top, double near, double far );
+    LinearMapR4f& Set_glOrtho( double left, double right, double bottom, double top, double near, double far );
+    LinearMapR4f& Set_gluPerspective( double fieldofview_y_Radians, double aspectRatio, double zNear, double zFar );
+    LinearMapR4f& Set_gluLookAt( const VectorR3& eyePos, const VectorR3& lookAtPos, const VectorR3& upDir );
+
+private:
+    float* Column( int j ) { return &m11 + 4 * j; }
+    const float* Column( int j ) const { return &m11 + 4 * j; }
+    void TransformPoints( const float* src, float* dest, int count, int srcStride, int destStride, float w ) const;
+};
+
+inline LinearMapR4f operator* ( const LinearMapR4f&, const LinearMapR4f& );
+
+// *********************************************************
+// * LinearMapR4f class - inlined functions                *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * *****
+
+inline constexpr LinearMapR4f::LinearMapR4f( float a11, float a21, float a31, float a41,
+                                   float a12, float a22, float a32, float a42,
+                                   float a13, float a23, float a33, float a43,
+                                   float a14, float a24, float a34, float a44 )
+    : m11(a11), m21(a21), m31(a31), m41(a41), m12(a12), m22(a22), m32(a32), m42(a42),
+      m13(a13), m23(a23), m33(a33), m43(a43), m14(a14), m24(a24), m34(a34), m44(a44)
+{ }
+
+inline LinearMapR4f& LinearMapR4f::Set( float a11, float a21, float a31, float a41,
+                                        float a12, float a22, float a32, float a42,
+                                        float a13, float a23, float a33, float a43,
+                                        float a14, float a24, float a34, float a44 )
+{
+    m11 = a11;      // Column 1
+    m21 = a21;
+    m31 = a31;
+    m41 = a41;
+    m12 = a12;      // Column 2
+    m22 = a22;
+    m32 = a32;
+    m42 = a42;
+    m13 = a13;      // Column 3
+    m23 = a23;
+    m33 = a33;
+    m43 = a43;
+    m14 = a14;      // Column 4
+    m24 = a24;
+    m34 = a34;
+    m44 = a44;
+    return *this;
+}
+
+inline LinearMapR4f& LinearMapR4f::SetIdentity()
+{
+    return Set( 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f );
+}
+
+inline LinearMapR4f& LinearMapR4f::SetZero()
+{
+    memset(&m11, 0, 16 * sizeof(float));
+    return *this;
+}
+
+inline LinearMapR4f& LinearMapR4f::LoadByColumns( const float* v )
+{
+    memcpy(&m11, v, 16 * sizeof(float));
+    return *this;
+}
+
+// Matrix product: each column of the product is a linear combination of the columns of *this.
+inline LinearMapR4f& LinearMapR4f::operator*= ( const LinearMapR4f& B )
+{
+#ifdef USE_SSE2
+    __m128 a1 = _mm_load_ps(Column(0));
+    __m128 a2 = _mm_load_ps(Column(1));
+    __m128 a3 = _mm_load_ps(Column(2));
+    __m128 a4 = _mm_load_ps(Column(3));
+    for (int j = 0; j < 4; j++) {
+        const float* b = B.Column(j);       // (Read before column j is overwritten, in case B is *this)
+        __m128 c = _mm_mul_ps(a1, _mm_set1_ps(b[0]));
+        c = _mm_add_ps(c, _mm_mul_ps(a2, _mm_set1_ps(b[1])));
+        c = _mm_add_ps(c, _mm_mul_ps(a3, _mm_set1_ps(b[2])));
+        c = _mm_add_ps(c, _mm_mul_ps(a4, _mm_set1_ps(b[3])));
+        _mm_store_ps(Column(j), c);
+    }
+#else
+    LinearMapR4f A(*this);
+    for (int j = 0; j < 4; j++) {
+        const float* b = B.Column(j);
+        A.Transform(b, Column(j));
+    }
+#endif
+    return *this;
+}
+
+inline void LinearMapR4f::Transform( const float* v, float* dest ) const
+{
+#ifdef USE_SSE2
+    __m128 c = _mm_mul_ps(_mm_load_ps(Column(0)), _mm_set1_ps(v[0]));
+    c = _mm_add_ps(c, _mm_mul_ps(_mm_load_ps(Column(1)), _mm_set1_ps(v[1])));
+    c = _mm_add_ps(c, _mm_mul_ps(_mm_load_ps(Column(2)), _mm_set1_ps(v[2])));
+    c = _mm_add_ps(c, _mm_mul_ps(_mm_load_ps(Column(3)), _mm_set1_ps(v[3])));
+    _mm_storeu_ps(dest, c);
+#else
+    float x = v[0], y = v[1], z = v[2], w = v[3];
+    dest[0] = m11*x + m12*y + m13*z + m14*w;
+    dest[1] = m21*x + m22*y + m23*z + m24*w;
+    dest[2] = m31*x + m32*y + m33*z + m34*w;
+    dest[3] = m41*x + m42*y + m43*z + m44*w;
+#endif
+}
+
+inline LinearMapR4f operator* ( const LinearMapR4f& A, const LinearMapR4f& B )
+{
+    LinearMapR4f AA(A);
+    AA *= B;
+    return AA;
+}
+
+inline LinearMapR4f& LinearMapR4f::Invert()
+{
+    *this = Inverse();
+    return *this;
+}
+
+// Various scale, translation and rotation matrices,
+//   to reproduce OpenGL ModelView matrix functionality
+//   The "Mult" routines multiply on the right. (Like legacy OpenGL.)
+//   The "Set" routines replace the matrix contents.
+//   All routines return the *this matrix.
+
+inline LinearMapR4f& LinearMapR4f::Set_glScale( float xyzScale )
+{
+    return Set_glScale(xyzScale, xyzScale, xyzScale);
+}
+
+inline LinearMapR4f& LinearMapR4f::Mult_glScale( float xyzScale )
+{
+    return Mult_glScale(xyzScale, xyzScale, xyzScale);
+}
+
+inline LinearMapR4f& LinearMapR4f::Set_glScale( float xScale, float yScale, float zScale )
+{
+    return Set( xScale, 0.0f, 0.0f, 0.0f, 0.0f, yScale, 0.0f, 0.0f,
+                0.0f, 0.0f, zScale, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f );
+}
+
+inline LinearMapR4f& LinearMapR4f::Mult_glScale( float xScale, float yScale, float zScale )
+{
+#ifdef USE_SSE2
+    _mm_store_ps(Column(0), _mm_mul_ps(_mm_load_ps(Column(0)), _mm_set1_ps(xScale)));
+    _mm_store_ps(Column(1), _mm_mul_ps(_mm_load_ps(Column(1)), _mm_set1_ps(yScale)));
+    _mm_store_ps(Column(2), _mm_mul_ps(_mm_load_ps(Column(2)), _mm_set1_ps(zScale)));
+#else
+    m11 *= xScale;
+    m21 *= xScale;
+    m31 *= xScale;
+    m41 *= xScale;
+    m12 *= yScale;
+    m22 *= yScale;
+    m32 *= yScale;
+    m42 *= yScale;
+    m13 *= zScale;
+    m23 *= zScale;
+    m33 *= zScale;
+    m43 *= zScale;
+#endif
+    return *this;
+}
+
+inline LinearMapR4f& LinearMapR4f::Set_glTranslate( float xTranslation, float yTranslation, float zTranslation )
+{
+    return Set( 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                0.0f, 0.0f, 1.0f, 0.0f, xTranslation, yTranslation, zTranslation, 1.0f );
+}
+
+// The fourth column becomes M*(x,y,z,1)
+inline LinearMapR4f& LinearMapR4f::Mult_glTranslate( float xTranslation, float yTranslation, float zTranslation )
+{
+    float t[4] = { xTranslation, yTranslation, zTranslation, 1.0f };
+    Transform(t, Column(3));
+    return *this;
+}
+
+inline LinearMapR4f& LinearMapR4f::Set_glTranslate( const VectorR3& translation )
+{
+    return Set_glTranslate((float)translation.x, (float)translation.y, (float)translation.z);
+}
+
+inline LinearMapR4f& LinearMapR4f::Mult_glTranslate( const VectorR3& translation )
+{
+    return Mult_glTranslate((float)translation.x, (float)translation.y, (float)translation.z);
+}
+
+inline LinearMapR4f& LinearMapR4f::Set_glRotate( float radians, float x, float y, float z )
+{
+    return Set_glRotate(cosf(radians), sinf(radians), x, y, z);
+}
+
+inline LinearMapR4f& LinearMapR4f::Mult_glRotate( float radians, float x, float y, float z )
+{
+    return Mult_glRotate(cosf(radians), sinf(radians), x, y, z);
+}
+
+inline LinearMapR4f& LinearMapR4f::Set_glRotate( float radians, const VectorR3& axis )
+{
+    return Set_glRotate(cosf(radians), sinf(radians), (float)axis.x, (float)axis.y, (float)axis.z);
+}
+
+inline LinearMapR4f& LinearMapR4f::Mult_glRotate( float radians, const VectorR3& axis )
+{
+    return Mult_glRotate(cosf(radians), sinf(radians), (float)axis.x, (float)axis.y, (float)axis.z);
+}
+
+inline LinearMapR4f& LinearMapR4f::Mult_glRotate( float costheta, float sintheta, float x, float y, float z )
+{
+    LinearMapR4f rotMatrix;
+    rotMatrix.Set_glRotate(costheta, sintheta, x, y, z);
+    (*this) *= rotMatrix;
+    return *this;
+}
+
+#endif  // LINEAR_R4F_H
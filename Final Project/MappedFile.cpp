@@ -0,0 +1,117 @@
+/*
+* MappedFile.cpp
+*
+* Read-only memory mapped files.  See MappedFile.h.
+*/
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+    data = 0;
+    size = 0;
+#if defined(_WIN32)
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = 0;
+#endif
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const char* filename)
+{
+    Close();
+    fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        Close();
+        return false;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+    if (mappingHandle == 0) {
+        Close();
+        return false;
+    }
+    data = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (data == 0) {
+        Close();
+        return false;
+    }
+    size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data != 0) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle != 0) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+    }
+    data = 0;
+    size = 0;
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = 0;
+}
+
+#else
+
+// The file descriptor can be closed as soon as the file is mapped.
+bool MappedFile::Open(const char* filename)
+{
+    Close();
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* ptr = mmap(0, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+    data = (const unsigned char*)ptr;
+    size = (size_t)fileStat.st_size;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data != 0) {
+        munmap((void*)data, size);
+    }
+    data = 0;
+    size = 0;
+}
+
+#endif  // defined(_WIN32)
+
+void MappedFile::Prefault() const
+{
+    const size_t pageSize = 4096;
+    volatile unsigned char sum = 0;
+    for (size_t i = 0; i < size; i += pageSize) {
+        sum += data[i];
+    }
+}
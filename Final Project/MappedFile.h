@@ -0,0 +1,54 @@
+/*
+* MappedFile.h
+*
+* A read-only memory mapping of a whole file.
+*   The file's contents are available as a byte array without reading or copying
+*   them: pages are brought in by the operating system when they are first touched.
+*   Uses CreateFileMapping/MapViewOfFile on Windows, and mmap elsewhere.
+*
+* How to use:
+*     MappedFile file;
+*     if (file.Open("floor.bmp")) {
+*         const unsigned char* bytes = file.Data();    // file.Size() bytes
+*         ...
+*     }
+*   The mapping is released by Close() or by the destructor: pointers into
+*   Data() must not be used after that.
+*/
+
+#pragma once
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile() { Close(); }
+
+    // Returns true for success.  An empty file cannot be mapped, and is an error.
+    bool Open(const char* filename);
+    void Close();
+
+    bool IsOpen() const { return data != 0; }
+    const unsigned char* Data() const { return data; }
+    size_t Size() const { return size; }
+
+    // Touch one byte per page, so the pages are read in now (for instance, in a
+    //    worker thread) instead of when the data is first used.
+    void Prefault() const;
+
+private:
+    const unsigned char* data;
+    size_t size;
+#if defined(_WIN32)
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif  // MAPPED_FILE_H
@@ -25,57 +25,70 @@
 #include <limits.h>
 #include <float.h>
 #include <assert.h>
+#include <limits>
+
+//
+// SIMD: USE_SSE2 is defined when the SSE2 intrinsics (<emmintrin.h>) can be used.
+//    This is always true for x64 builds, and for x86 builds with /arch:SSE2 or -msse2.
+//    Define NO_SSE2 to use only the plain C++ versions of routines.
+//
+#if !defined(NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define USE_SSE2 1
+#endif
 
 //
 // Commonly used constants
+//   These are constexpr, so they are compile time constants with no static initialization.
+//   The values that are not arithmetic combinations of others are given to full precision,
+//   since sqrt, exp and log are not constexpr.
 //
 
-const double DBL_NAN = sqrt(-1.0);	// Kludgy - ought to be an IEEE standard for this constant
-
-const double PI = 3.1415926535897932384626433832795028841972;
-const double PI2 = 2.0*PI;
-const double PI4 = 4.0*PI;
-const double PISq = PI*PI;
-const double PIhalves = 0.5*PI;
-const double PIthirds = PI/3.0;
-const double PItwothirds = PI2/3.0;
-const double PIfourths = 0.25*PI;
-const double PIsixths = PI/6.0;
-const double PIsixthsSq = PIsixths*PIsixths;
-const double PItwelfths = PI/12.0;
-const double PItwelfthsSq = PItwelfths*PItwelfths;
-const double PIinv = 1.0/PI;
-const double PI2inv = 0.5/PI;
-const double PIhalfinv = 2.0/PI;
-const double TwoPiSqrtInv = 1.0/sqrt(2.0*PI);
-const double LogPI = log(PI);
-
-const double RadiansToDegrees = 180.0/PI;
-const double DegreesToRadians = PI/180;
-
-const double OneThird = 1.0/3.0;
-const double TwoThirds = 2.0/3.0;
-const double OneSixth = 1.0/6.0;
-const double OneEighth = 1.0/8.0;
-const double OneTwelfth = 1.0/12.0;
-
-const double Root2 = sqrt(2.0);
-const double Root3 = sqrt(3.0);
-const double Root2Inv = 1.0/Root2;	// sqrt(2)/2
-const double HalfRoot3 = sqrt(3.0)/2.0;
-
-const double E = exp(1.0);
-const double LnTwo = log(2.0);
-const double LnTwoInv = 1.0/log(2.0);
-
-const double GoldenRatio = (sqrt(5.0)+1.0)*0.5;
-const double GoldenRatioInv = (sqrt(5.0)-1.0)*0.5;  // 1.0/GoldenRatio
+constexpr double DBL_NAN = std::numeric_limits<double>::quiet_NaN();
+
+constexpr double PI = 3.1415926535897932384626433832795028841972;
+constexpr double PI2 = 2.0*PI;
+constexpr double PI4 = 4.0*PI;
+constexpr double PISq = PI*PI;
+constexpr double PIhalves = 0.5*PI;
+constexpr double PIthirds = PI/3.0;
+constexpr double PItwothirds = PI2/3.0;
+constexpr double PIfourths = 0.25*PI;
+constexpr double PIsixths = PI/6.0;
+constexpr double PIsixthsSq = PIsixths*PIsixths;
+constexpr double PItwelfths = PI/12.0;
+constexpr double PItwelfthsSq = PItwelfths*PItwelfths;
+constexpr double PIinv = 1.0/PI;
+constexpr double PI2inv = 0.5/PI;
+constexpr double PIhalfinv = 2.0/PI;
+constexpr double TwoPiSqrtInv = 0.3989422804014326779399460599343818684759;	// 1.0/sqrt(2.0*PI)
+constexpr double LogPI = 1.1447298858494001741434273513530587116473;		// log(PI)
+
+constexpr double RadiansToDegrees = 180.0/PI;
+constexpr double DegreesToRadians = PI/180;
+
+constexpr double OneThird = 1.0/3.0;
+constexpr double TwoThirds = 2.0/3.0;
+constexpr double OneSixth = 1.0/6.0;
+constexpr double OneEighth = 1.0/8.0;
+constexpr double OneTwelfth = 1.0/12.0;
+
+constexpr double Root2 = 1.4142135623730950488016887242096980785697;		// sqrt(2.0)
+constexpr double Root3 = 1.7320508075688772935274463415058723669428;		// sqrt(3.0)
+constexpr double Root2Inv = 1.0/Root2;	// sqrt(2)/2
+constexpr double HalfRoot3 = 0.5*Root3;
+
+constexpr double E = 2.7182818284590452353602874713526624977572;			// exp(1.0)
+constexpr double LnTwo = 0.6931471805599453094172321214581765680755;		// log(2.0)
+constexpr double LnTwoInv = 1.0/LnTwo;
+
+constexpr double GoldenRatio = 1.6180339887498948482045868343656381177203;	// (sqrt(5.0)+1.0)*0.5
+constexpr double GoldenRatioInv = GoldenRatio-1.0;  // 1.0/GoldenRatio
 
 // Special purpose constants
-const double OnePlusEpsilon15 = 1.0+1.0e-15;
-const double OneMinusEpsilon15 = 1.0-1.0e-15;
+constexpr double OnePlusEpsilon15 = 1.0+1.0e-15;
+constexpr double OneMinusEpsilon15 = 1.0-1.0e-15;
 
-const long HALF_LONG_MIN = (LONG_MIN>>1);	// Signed half of long min.
+constexpr long HALF_LONG_MIN = (LONG_MIN>>1);	// Signed half of long min.
 
 inline double ZeroValue(const double& )
 {
@@ -450,6 +463,40 @@ inline double SafeAcos( double x ) {
 	}
 }
 
+// **********************************************************
+// Fast single precision approximations (in MathMisc.cpp)	*
+// **********************************************************
+
+// These use polynomial approximations, and the array versions compute four 
+//   values at a time with SSE2 (when USE_SSE2 is defined).  They are accurate enough
+//   for vertex data and animation.  The speed gain is in the array versions: the scalar
+//   versions are about as fast as the library functions, and ExpApprox is slower than expf.
+//   The maximum errors were measured against the double precision libm functions; the
+//   speeds are relative to a loop calling sinf and cosf, expf or atan2f (x64, gcc -O2,
+//   glibc; see BenchApprox.cpp).  Without SSE2, the array versions are no faster.
+// SinCosApprox:  absolute error at most 8.0e-8 for |x| <= 8192.  (Larger |x| lose accuracy.)
+//     Speed: array 7x, scalar 1.1x.
+// ExpApprox:  relative error at most 1.0e-7.  Returns 0 for x < -87.336 (no denormals),
+//     x > 88.376 is treated as 88.376 (giving 2.4e38, not infinity), and NaN returns NaN.
+//     Speed: array 2.5x, scalar 0.6x.
+// Atan2Approx:  absolute error at most 2.8e-7.  The result is in [-pi, pi].
+//     Signed zeros are handled as by atan2: e.g., Atan2Approx(0,0) is 0 and Atan2Approx(0,-1) is pi.
+//     Speed: array 15x, scalar 1.3x.
+void SinCosApprox( float x, float* sinx, float* cosx );
+float ExpApprox( float x );
+float Atan2Approx( float y, float x );
+// The same, for arrays of count values.  The destination arrays may equal the source arrays.
+void SinCosApprox( const float* x, float* sinx, float* cosx, int count );
+void ExpApprox( const float* x, float* dest, int count );
+void Atan2Approx( const float* y, const float* x, float* dest, int count );
+
+// Sines and cosines of evenly spaced angles, start + i*delta for 0 <= i < count,
+//   by repeated rotation: each step is a 2x2 rotation, with no call to sin or cos.
+//   The recurrence is done in double precision, and restarted every 256 steps, so the
+//   error is far below float precision.  Either of sinx or cosx may be null.
+void SinCosSequence( double start, double delta, int count, float* sinx, float* cosx );
+void SinCosSequence( double start, double delta, int count, double* sinx, double* cosx );
+
 
 // **********************************************************************
 // Roots and powers														*
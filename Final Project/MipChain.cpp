@@ -0,0 +1,364 @@
+/*
+* MipChain.cpp
+*
+* Mipmap levels calculated on the CPU.  See MipChain.h.
+*/
+
+#include "MipChain.h"
+#include "MathMisc.h"
+#include <math.h>
+#include <string.h>
+#include "assert.h"
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+#if defined(_WIN32)         // If on windows, need this for gl.h
+#include <windows.h>
+#endif  // defined(_WIN32)
+#include "GL/gl.h"
+#endif
+#ifndef GL_BGR
+#define GL_BGR 0x80E0       // Not in the OpenGL 1.1 gl.h of Windows
+#endif
+
+namespace {
+
+    // **********************************************
+    // Conversion between bytes and linear intensity.
+    //   sRGB decoding is a table lookup.  sRGB encoding is exact: the result is the
+    //   number of thresholds (the midpoints between the codes, as linear values) at
+    //   or below the value.  A table indexed by the value gives the count at the
+    //   start of its bucket, and the buckets are small enough that at most one
+    //   more threshold can follow in the bucket.
+    // **********************************************
+    const int EncodeBuckets = 1 << 14;
+
+    struct ConversionTables {
+        float sRgbToLinear[256];
+        float byteToFloat[256];
+        float thresholds[256];                  // thresholds[k] is between codes k-1 and k
+        unsigned char bucketCode[EncodeBuckets + 1];
+
+        ConversionTables()
+        {
+            for (int i = 0; i < 256; i++) {
+                sRgbToLinear[i] = (float)SRgbToLinear(i / 255.0);
+                byteToFloat[i] = (float)(i / 255.0);
+                thresholds[i] = (i == 0) ? -1.0f : (float)SRgbToLinear((i - 0.5) / 255.0);
+            }
+            int code = 0;
+            for (int b = 0; b <= EncodeBuckets; b++) {
+                float v = (float)b / (float)EncodeBuckets;
+                while (code < 255 && thresholds[code + 1] <= v) {
+                    code++;
+                }
+                bucketCode[b] = (unsigned char)code;
+            }
+        }
+        static double SRgbToLinear(double c)
+        {
+            return (c <= 0.04045) ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+        }
+    };
+
+    const ConversionTables& GetTables()
+    {
+        static const ConversionTables tables;       // Initialized once, thread safe
+        return tables;
+    }
+
+    inline unsigned char EncodeSRgb(float v, const ConversionTables& tables)
+    {
+        if (!(v > 0.0f)) {
+            return 0;
+        }
+        if (v >= 1.0f) {
+            return 255;
+        }
+        int code = tables.bucketCode[(int)(v * (float)EncodeBuckets)];
+        if (code < 255 && v >= tables.thresholds[code + 1]) {
+            code++;
+        }
+        return (unsigned char)code;
+    }
+
+    inline unsigned char EncodeLinear(float v)
+    {
+        if (!(v > 0.0f)) {
+            return 0;
+        }
+        if (v >= 1.0f) {
+            return 255;
+        }
+        return (unsigned char)(int)(v * 255.0f + 0.5f);
+    }
+
+    // **********************************************
+    // The filter taps of a one dimensional resampling from numIn to numOut pixels.
+    //   Output pixel i uses the count[i] taps starting at first[i].  The tap indices
+    //   are clamped to the image, and never decrease.  The weights sum to one.
+    // **********************************************
+    struct FilterTaps {
+        std::vector<int> first;
+        std::vector<int> count;
+        std::vector<int> index;
+        std::vector<float> weight;
+        int maxCount;
+    };
+
+    // Kaiser window of a sinc, for |x| < KaiserRadius (in output pixels)
+    const double KaiserRadius = 1.5;
+    const double KaiserAlpha = 4.0;
+
+    double BesselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        double xHalfSq = 0.25 * x * x;
+        for (int k = 1; term > 1.0e-12 * sum; k++) {
+            term *= xHalfSq / ((double)k * (double)k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    double KaiserSinc(double x)
+    {
+        double t = x / KaiserRadius;
+        if (t * t >= 1.0) {
+            return 0.0;
+        }
+        double sinc = (x == 0.0) ? 1.0 : sin(PI * x) / (PI * x);
+        return sinc * BesselI0(KaiserAlpha * sqrt(1.0 - t * t)) / BesselI0(KaiserAlpha);
+    }
+
+    void CalcFilterTaps(long numIn, long numOut, MipFilter filter, FilterTaps* taps)
+    {
+        double scale = (double)numIn / (double)numOut;     // Input pixels per output pixel
+        taps->first.resize(numOut);
+        taps->count.resize(numOut);
+        taps->index.clear();
+        taps->weight.clear();
+        taps->maxCount = 0;
+        std::vector<double> w;
+        for (long i = 0; i < numOut; i++) {
+            // Output pixel i covers [i*scale, (i+1)*scale) in input pixels.
+            double left = i * scale;
+            double right = left + scale;
+            long j0, j1;                // Input pixels j0 to j1 (unclamped)
+            w.clear();
+            if (filter == MipFilterBox) {
+                j0 = (long)floor(left);
+                j1 = (long)ceil(right) - 1;
+                for (long j = j0; j <= j1; j++) {
+                    w.push_back(Min((double)(j + 1), right) - Max((double)j, left));
+                }
+            }
+            else {
+                double center = left + 0.5 * scale;
+                double radius = KaiserRadius * Max(scale, 1.0);
+                j0 = (long)floor(center - radius);
+                j1 = (long)ceil(center + radius);
+                for (long j = j0; j <= j1; j++) {
+                    w.push_back(KaiserSinc((j + 0.5 - center) / Max(scale, 1.0)));
+                }
+            }
+            double sum = 0.0;
+            for (size_t k = 0; k < w.size(); k++) {
+                sum += w[k];
+            }
+            taps->first[i] = (int)taps->index.size();
+            for (size_t k = 0; k < w.size(); k++) {
+                if (w[k] != 0.0) {
+                    long j = ClampRange(j0 + (long)k, 0L, numIn - 1);
+                    taps->index.push_back((int)j);
+                    taps->weight.push_back((float)(w[k] / sum));
+                }
+            }
+            taps->count[i] = (int)taps->index.size() - taps->first[i];
+            UpdateMax(taps->count[i], taps->maxCount);
+        }
+    }
+
+    // dest[0..n-1] += w * src[0..n-1].  This is where most of the time goes.
+    void AddScaledRow(float* dest, const float* src, float w, long n)
+    {
+        long k = 0;
+#ifdef USE_SSE2
+        __m128 ww = _mm_set1_ps(w);
+        for (; k + 4 <= n; k += 4) {
+            __m128 d = _mm_loadu_ps(dest + k);
+            d = _mm_add_ps(d, _mm_mul_ps(ww, _mm_loadu_ps(src + k)));
+            _mm_storeu_ps(dest + k, d);
+        }
+#endif
+        for (; k < n; k++) {
+            dest[k] += w * src[k];
+        }
+    }
+
+    // Filters one level down to the next: vertically first (whole rows at a time),
+    //    then horizontally.  The source rows are converted to linear floats once
+    //    each, into a ring of rows big enough for the vertical taps of one output row.
+    void FilterLevel(const unsigned char* src, long srcRows, long srcCols, long srcBytesPerRow,
+                     unsigned char* dest, long destRows, long destCols, long destBytesPerRow,
+                     MipFilter filter, bool sRgbAveraging)
+    {
+        const ConversionTables& tables = GetTables();
+        const float* toLinear = sRgbAveraging ? tables.sRgbToLinear : tables.byteToFloat;
+        FilterTaps rowTaps, colTaps;
+        CalcFilterTaps(srcRows, destRows, filter, &rowTaps);
+        CalcFilterTaps(srcCols, destCols, filter, &colTaps);
+
+        long rowFloats = 3 * srcCols;
+        int ringSize = rowTaps.maxCount;
+        std::vector<float> ring((size_t)ringSize * rowFloats);
+        std::vector<long> ringRow(ringSize, -1);             // The source row in each slot
+        std::vector<float> columnSums(rowFloats);
+
+        for (long r = 0; r < destRows; r++) {
+            memset(columnSums.data(), 0, rowFloats * sizeof(float));
+            for (int t = rowTaps.first[r]; t < rowTaps.first[r] + rowTaps.count[r]; t++) {
+                long row = rowTaps.index[t];
+                int slot = (int)(row % ringSize);
+                float* ringData = ring.data() + (size_t)slot * rowFloats;
+                if (ringRow[slot] != row) {
+                    const unsigned char* srcRow = src + row * srcBytesPerRow;
+                    for (long k = 0; k < rowFloats; k++) {
+                        ringData[k] = toLinear[srcRow[k]];
+                    }
+                    ringRow[slot] = row;
+                }
+                AddScaledRow(columnSums.data(), ringData, rowTaps.weight[t], rowFloats);
+            }
+
+            unsigned char* destRow = dest + r * destBytesPerRow;
+            for (long i = 0; i < destCols; i++) {
+                float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f;
+                for (int t = colTaps.first[i]; t < colTaps.first[i] + colTaps.count[i]; t++) {
+                    const float* p = columnSums.data() + 3 * colTaps.index[t];
+                    float w = colTaps.weight[t];
+                    sum0 += w * p[0];
+                    sum1 += w * p[1];
+                    sum2 += w * p[2];
+                }
+                if (sRgbAveraging) {
+                    destRow[3 * i] = EncodeSRgb(sum0, tables);
+                    destRow[3 * i + 1] = EncodeSRgb(sum1, tables);
+                    destRow[3 * i + 2] = EncodeSRgb(sum2, tables);
+                }
+                else {
+                    destRow[3 * i] = EncodeLinear(sum0);
+                    destRow[3 * i + 1] = EncodeLinear(sum1);
+                    destRow[3 * i + 2] = EncodeLinear(sum2);
+                }
+            }
+            memset(destRow + 3 * destCols, 0, destBytesPerRow - 3 * destCols);     // Padding
+        }
+    }
+
+    inline long BytesPerRow(long numCols)
+    {
+        return ((3 * numCols + 3) >> 2) << 2;
+    }
+}
+
+// **********************************************
+// MipChain
+// **********************************************
+
+void MipChain::Generate(const unsigned char* basePixels, long numRows, long numCols, long bytesPerRow,
+                        MipFilter filter, bool sRgbAveraging)
+{
+    assert(numRows > 0 && numCols > 0 && bytesPerRow >= 3 * numCols);
+    Reset();
+    baseRows = numRows;
+    baseCols = numCols;
+    size_t offset = 0;
+    for (long rows = numRows, cols = numCols; rows > 1 || cols > 1; ) {
+        rows = Max(rows >> 1, 1L);
+        cols = Max(cols >> 1, 1L);
+        levelOffsets.push_back(offset);
+        offset += (size_t)rows * BytesPerRow(cols);
+    }
+    data.resize(offset);
+
+    const unsigned char* src = basePixels;
+    long srcBytesPerRow = bytesPerRow;
+    for (int level = 1; level <= GetMaxLevel(); level++) {
+        unsigned char* dest = data.data() + levelOffsets[level - 1];
+        FilterLevel(src, GetNumRows(level - 1), GetNumCols(level - 1), srcBytesPerRow,
+                    dest, GetNumRows(level), GetNumCols(level), GetNumBytesPerRow(level),
+                    filter, sRgbAveraging);
+        src = dest;
+        srcBytesPerRow = GetNumBytesPerRow(level);
+    }
+}
+
+void MipChain::Reset()
+{
+    baseRows = 0;
+    baseCols = 0;
+    levelOffsets.clear();
+    data.clear();
+}
+
+long MipChain::GetNumRows(int level) const
+{
+    assert(level >= 0 && level <= GetMaxLevel());
+    return Max(baseRows >> level, 1L);
+}
+
+long MipChain::GetNumCols(int level) const
+{
+    assert(level >= 0 && level <= GetMaxLevel());
+    return Max(baseCols >> level, 1L);
+}
+
+const unsigned char* MipChain::GetLevelData(int level) const
+{
+    assert(level >= 1 && level <= GetMaxLevel());
+    return data.data() + levelOffsets[level - 1];
+}
+
+size_t MipChain::CalcDataSize(long numRows, long numCols)
+{
+    size_t size = 0;
+    while (numRows > 1 || numCols > 1) {
+        numRows = Max(numRows >> 1, 1L);
+        numCols = Max(numCols >> 1, 1L);
+        size += (size_t)numRows * BytesPerRow(numCols);
+    }
+    return size;
+}
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+
+void MipChain::TexImage2D(unsigned int target, int internalFormat, bool bgr) const
+{
+    TexImage2D(target, internalFormat, bgr, data.data(), baseRows, baseCols);
+}
+
+void MipChain::TexImage2D(unsigned int target, int internalFormat, bool bgr,
+                          const unsigned char* packedLevels, long numRows, long numCols)
+{
+    GLint oldAlignment, oldRowLength;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &oldRowLength);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    GLenum format = bgr ? GL_BGR : GL_RGB;
+    for (int level = 1; numRows > 1 || numCols > 1; level++) {
+        numRows = Max(numRows >> 1, 1L);
+        numCols = Max(numCols >> 1, 1L);
+        glTexImage2D((GLenum)target, level, internalFormat, (GLsizei)numCols, (GLsizei)numRows, 0,
+                     format, GL_UNSIGNED_BYTE, packedLevels);
+        packedLevels += (size_t)numRows * BytesPerRow(numCols);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, oldRowLength);
+}
+
+#endif  // RGBIMAGE_DONT_USE_OPENGL
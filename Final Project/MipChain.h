@@ -0,0 +1,87 @@
+/*
+* MipChain.h
+*
+* Mipmap levels calculated on the CPU, for uploading with glTexImage2D
+*   instead of calling glGenerateMipmap.  The result is the same on every
+*   driver (including software OpenGL), and can be saved and reused.
+*
+*   The source image is level 0, and is not copied: the chain holds levels
+*   1 through GetMaxLevel(), down to 1x1.  Each level is floor(half) the size of
+*   the one before in each dimension (at least 1), as OpenGL expects, so
+*   odd (non-power-of-two) sizes are filtered over their true footprint.
+*
+*   Pixels are three bytes.  The channels are filtered independently, so the
+*   chain has the same channel order as the source (RGB from an RgbImage,
+*   BGR from a BmpFileView).  Rows are padded to a multiple of four bytes, as in
+*   RgbImage and BMP files.
+*
+*   Filters (separable, each level calculated from the level before it):
+*     MipFilterBox     The average over each pixel's footprint: 2x2 for even sizes,
+*                        3 taps with fractional weights in an odd dimension.
+*     MipFilterKaiser  A Kaiser windowed sinc, 6 taps for even sizes.  Sharper,
+*                        with less aliasing; about three times slower.
+*   With sRGB averaging (the default), the bytes are converted to linear
+*   intensity before filtering and back after: averaging the sRGB encoded
+*   values directly darkens the smaller levels.
+*
+* How to use:
+*     MipChain mips;
+*     mips.Generate(texMap.PixelData(), texMap.GetNumRows(), texMap.GetNumCols(),
+*                   texMap.GetNumBytesPerRow());
+*     texMap.TexImage2D(GL_TEXTURE_2D, 0, GL_RGB);     // Level 0
+*     mips.TexImage2D(GL_TEXTURE_2D, GL_RGB, true);     // Levels 1, 2, ... (BGR data)
+*/
+
+#pragma once
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <stddef.h>
+#include <vector>
+
+enum MipFilter {
+    MipFilterBox,
+    MipFilterKaiser,
+};
+
+class MipChain {
+public:
+    MipChain() : baseRows(0), baseCols(0) {}
+
+    // Calculates the levels below the base image.  bytesPerRow is the distance
+    //    between rows of the base image (at least 3*numCols).
+    void Generate(const unsigned char* basePixels, long numRows, long numCols, long bytesPerRow,
+                  MipFilter filter = MipFilterBox, bool sRgbAveraging = true);
+    void Reset();
+
+    // Sizes of the levels from 1 up to GetMaxLevel().  Level 0 gives the base size.
+    int GetMaxLevel() const { return (int)levelOffsets.size(); }
+    long GetNumRows(int level) const;
+    long GetNumCols(int level) const;
+    long GetNumBytesPerRow(int level) const { return ((3 * GetNumCols(level) + 3) >> 2) << 2; }
+    const unsigned char* GetLevelData(int level) const;
+
+    // All the levels, packed one after the other (for saving the chain).
+    const unsigned char* Data() const { return data.data(); }
+    size_t DataSize() const { return data.size(); }
+
+    // The total size of levels 1 and up, for a base of this size.
+    static size_t CalcDataSize(long numRows, long numCols);
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+    // glTexImage2D for levels 1 and up, to the currently bound texture.
+    //    bgr tells whether the data is BGR (from a BMP file) or RGB.
+    void TexImage2D(unsigned int target, int internalFormat, bool bgr) const;
+    // The same, for levels packed as in Data(), for instance read back from a file.
+    static void TexImage2D(unsigned int target, int internalFormat, bool bgr,
+                           const unsigned char* packedLevels, long numRows, long numCols);
+#endif
+
+private:
+    long baseRows;
+    long baseCols;
+    std::vector<size_t> levelOffsets;       // Offset in data of level i+1
+    std::vector<unsigned char> data;
+};
+
+#endif  // MIP_CHAIN_H
@@ -15,15 +15,24 @@
 
 #include "LinearR3.h"		// Adjust path as needed.
 #include "LinearR4.h"		// Adjust path as needed.
+#include "LinearR4f.h"      // Adjust path as needed
+#include "LinearR3bis.h"    // Adjust path as needed
+#include "Quaternion.h"     // Adjust path as needed
 #include "MathMisc.h"       // Adjust path as needed
 
 #include "MyGeometries.h"
 #include "TextureProj.h"
 #include "PhongData.h"
 #include "RgbImage.h"
+#include "BmpFileView.h"
+#include "TextureLoadQueue.h"
 #include "GlGeomCylinder.h"
 #include "GlGeomSphere.h"
 #include "GlGeomTorus.h"
+#include "SceneGraph.h"
+
+#include <chrono>
+#include <stdio.h>
 
 // **********************************
 // Material to underlie a texture map.
@@ -70,6 +79,45 @@ unsigned int myVBO[NumObjects];  // a Vertex Buffer Object holds an array of dat
 unsigned int myVAO[NumObjects];  // a Vertex Array Object - holds info about an array of vertex data;
 unsigned int myEBO[NumObjects];  // a Element Array Buffer Object - holds an array of elements (vertex indices)
 
+// Per-instance matrices for the cylinders drawn with one instanced draw call:
+//    the three buttons, the fifteen tray bars and the two tray rails.
+//    Each instance has its matrix (16 floats) followed by its normal matrix (9 floats).
+const int NumBarInstances = 20;
+const int InstanceFloats = GlGeomBase::InstanceFloats;
+unsigned int barsInstanceVBO;    // VBO holding the per-instance matrices
+float barsInstanceMats[InstanceFloats * NumBarInstances];
+
+// The stove: the cubes and cylinders of its body, and of its door which rotates
+//    around a hinge. The door parts are children of the door node.
+SceneGraph stoveScene;
+int stoveViewNode;      // The root: the view matrix
+int stoveDoorNode;      // The door's rotation around its hinge
+const int NumStoveCubes = 9;
+const int NumStoveBars = 2;
+int stoveCubeNodes[NumStoveCubes];
+int stoveBarNodes[NumStoveBars];
+
+// Translate by (tx,ty,tz) after scaling by (sx,sy,sz).  Same as Set_glTranslate followed by Mult_glScale.
+constexpr AffineMapR3 TranslateScale(double tx, double ty, double tz, double sx, double sy, double sz)
+{
+    return AffineMapR3(sx, 0.0, 0.0, 0.0, sy, 0.0, 0.0, 0.0, sz, tx, ty, tz);
+}
+
+// The local transformations of the stove's cubes. These are computed at compile time.
+//    The first five are relative to the view, the rest (the door frame) relative to the door.
+const int NumStoveBodyCubes = 5;
+constexpr AffineMapR3 stoveCubeLocals[NumStoveCubes] = {
+    TranslateScale(0.0, 0.1, -3.0, 8.0, 0.2, 6.0),      // bottom
+    TranslateScale(0.0, 5.0, -3.0, 8.0, 1.0, 6.0),      // top
+    TranslateScale(0.0, 2.75, -6.1, 8.0, 5.5, 0.2),
+    TranslateScale(4.1, 2.75, -3.1, 0.2, 5.5, 6.2),
+    TranslateScale(-4.1, 2.75, -3.1, 0.2, 5.5, 6.2),
+    TranslateScale(3.7, 2.4, 0.1, 0.6, 4.2, 0.2),       // door frame
+    TranslateScale(-3.7, 2.4, 0.1, 0.6, 4.2, 0.2),
+    TranslateScale(0.0, 0.6, 0.1, 6.8, 1.0, 0.2),
+    TranslateScale(0.0, 4.1, 0.1, 6.8, 0.8, 0.2),
+};
+
 // ********************************************
 // This sets up for texture maps. It is called only once
 // ********************************************
@@ -93,37 +141,43 @@ void SetupForTextures()
     donutMaterial.SpecularExponent = 80.0;
     // ***********************************************
     // Load texture maps
+    //    The files are mapped and read in, and their mipmaps calculated, on worker
+    //    threads (see TextureLoadQueue.h).  Each one is uploaded here as soon as it is ready.
+    //    After the first run, they come ready-made from the ".texcache" files instead.
+    //    Mipmaps are used (Best!): the load queue calculates them on the CPU (see MipChain.h),
+    //    with sRGB-correct averaging, the same result on every driver, unlike glGenerateMipmap.
+    //    Set useMipmaps to false to not use mipmaps: try moving away from the brick wall a great distance.
 	// ***********************************************
-    RgbImage texMap;
+    const bool useMipmaps = true;
+    TextureLoadQueue texQueue(TextureFiles, NumTextures, useMipmaps);
 
     glUseProgram(shaderProgramBitmap);
     glActiveTexture(GL_TEXTURE0);
     glGenTextures(NumTextures, TextureNames);
-    for (int i = 0; i < NumTextures; i++) {
-        texMap.LoadBmpFile(TextureFiles[i]);            // Read i-th texture from the i-th file.
+    for (int i; (i = texQueue.WaitForNext()) >= 0; ) {
+        std::chrono::steady_clock::time_point uploadStart = std::chrono::steady_clock::now();
         glBindTexture(GL_TEXTURE_2D, TextureNames[i]);  // Bind (select) the i-th OpenGL texture
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-        // Set best quality filtering.   Also see below for disabling mipmaps.
+        // Set best quality filtering.   Also see above for disabling mipmaps.
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);  // Requires that mipmaps be generated (see below)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                        useMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);  // GL_LINEAR_MIPMAP_LINEAR requires the mipmaps
         // You may also try GL_LINEAR_MIPMAP_NEAREST -- try looking at the wall from a 30 degree angle, and look for sweeping transitions.
 
-        // Store the texture into the OpenGL texture named TextureNames[i]
-        int textureWidth = texMap.GetNumCols();
-        int textureHeight = texMap.GetNumRows();
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, textureWidth, textureHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, texMap.ImageData());
- #if 1
-        // Use mipmaps  (Best!)
-        glGenerateMipmap(GL_TEXTURE_2D);
-#else
-        // Don't use mipmaps.  Try moving away from the brick wall a great distance
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-#endif
-
+        // Store the i-th texture, from the i-th file, into the OpenGL texture named TextureNames[i]
+        //    The pixels go from the mapped file to OpenGL as BGR, with no intermediate copy.
+        //    With mipmaps, TexImage2D uploads them too.
+        texQueue.TexImage2D(i, GL_TEXTURE_2D, GL_RGB);
+        double uploadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+        printf("Texture %s (%ld x %ld): %s %.1f ms, upload %.1f ms.\n", TextureFiles[i],
+            texQueue.GetNumCols(i), texQueue.GetNumRows(i), texQueue.IsFromCache(i) ? "cached" : "decode",
+            texQueue.GetDecodeMilliseconds(i), uploadMilliseconds);
+        texQueue.Release(i);
     }
+    printf("Loaded %d textures in %.1f ms.\n", NumTextures, texQueue.GetTotalMilliseconds());
 
     // Make sure that the shaderProgramBitmap uses the GL_TEXTURE_0 texture.
     glUseProgram(shaderProgramBitmap);
@@ -145,8 +199,15 @@ void SetupForTextures()
 // **********************
 void MySetupSurfaces() {
 
+    texSphere.SetVertexFormat(GlGeomVertexFormat::Compact());
+    texSphere.SetTriangleStrips(true);
     texSphere.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
-    texCylinder.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+    texCylinder.SetVertexFormat(GlGeomVertexFormat::Compact());
+    texCylinder.SetTriangleStrips(true);
+    texCylinder.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc, instanceMat_loc);
+    texTorus.SetNumLodLevels(3);
+    texTorus.SetOptimizeVertexCache(true);
+    texTorus.SetVertexFormat(GlGeomVertexFormat::Compact());
     texTorus.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
 
     // Initialize the VAO's, VBO's and EBO's for the ground plane, the back wall
@@ -158,6 +219,7 @@ void MySetupSurfaces() {
     glGenVertexArrays(NumObjects, &myVAO[0]);
     glGenBuffers(NumObjects, &myVBO[0]);
     glGenBuffers(NumObjects, &myEBO[0]);
+    glGenBuffers(1, &barsInstanceVBO);
 
     // For the Floor:
     // Allocate the needed Vertex Array Objects (VAO's),
@@ -165,14 +227,14 @@ void MySetupSurfaces() {
     // Since the floor has only four vertices.  Each vertex stores its
     //    position, its normal (0,1,0) and its (s,t)-coordinates.
     // YOU DO NOT NEED TO REMESH THE FLOOR (OR THE BACK WALL) SINCE WE USE PHONG INTERPOLATION
-    float floorVerts[] = {
+    static constexpr float floorVerts[] = {
         // Position              // Normal                  // Texture coordinates
         -8.0f, 0.0f, -8.0f,      0.0f, 1.0f, 0.0f,          0.0f, 1.0f,         // Back left
          8.0f, 0.0f, -8.0f,      0.0f, 1.0f, 0.0f,          1.0f, 1.0f,         // Back right
          8.0f, 0.0f,  8.0f,      0.0f, 1.0f, 0.0f,          1.0f, 0.0f,         // Front right
         -8.0f, 0.0f,  8.0f,      0.0f, 1.0f, 0.0f,          0.0f, 0.0f,         // Front left
     };
-    unsigned int floorElts[] = { 0, 3, 1, 2 };
+    static constexpr unsigned int floorElts[] = { 0, 3, 1, 2 };
     glBindBuffer(GL_ARRAY_BUFFER, myVBO[iFloor]);
     glBindVertexArray(myVAO[iFloor]);
     glBufferData(GL_ARRAY_BUFFER, sizeof(floorVerts), floorVerts, GL_STATIC_DRAW);
@@ -210,14 +272,14 @@ void MySetupSurfaces() {
     // FOR THE BACK WALL: ADD YOUR OWN CODE!! 
     // IT WILL BE SIMILAR TO THE FLOOR ABOVE.
     // YOU DO NOT NEED TO REMESH THE BACK WALL - ONE RECTANGLE (TWO TRIANGLES) IS ENOUGH
-    float wallVerts[] = {
+    static constexpr float wallVerts[] = {
         -8.0f, 0.0f, -8.0f,    0.0f,0.0f,1.0f,   0.0f, 0.0f,    //bootom left
         8.0f, 0.0f, -8.0f,    0.0f,0.0f,1.0f,   1.0f, 0.0f,    //bootom right
         -8.0f, 8.0f, -8.0f,    0.0f,0.0f,1.0f,   0.0f, 1.0f,    //top left
         8.0f, 8.0f, -8.0f,    0.0f,0.0f,1.0f,   1.0f, 1.0f    //top right
 
     };
-    unsigned int WallElmts[] = { 0,1,2,3 };
+    static constexpr unsigned int WallElmts[] = { 0,1,2,3 };
     glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWall]);
     glBindVertexArray(myVAO[iWall]);
     glBufferData(GL_ARRAY_BUFFER, sizeof(wallVerts), wallVerts, GL_STATIC_DRAW);
@@ -231,10 +293,30 @@ void MySetupSurfaces() {
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(WallElmts), WallElmts, GL_STATIC_DRAW);
 
     setupCube();
+    setupStoveScene();
 
     check_for_opengl_errors();      // Watch the console window for error messages!
 }
 
+// The local transformations of the parts of the stove, relative to the view (for the body)
+//    or to the door.
+void setupStoveScene() {
+    stoveViewNode = stoveScene.AddNode();
+    stoveDoorNode = stoveScene.AddNode(stoveViewNode);
+    for (int i = 0; i < NumStoveCubes; i++) {
+        int parent = (i < NumStoveBodyCubes) ? stoveViewNode : stoveDoorNode;
+        stoveCubeNodes[i] = stoveScene.AddNode(parent, stoveCubeLocals[i]);
+    }
+    AffineMapR3 mat;
+    //stove
+    mat.Set_glTranslate(0.0f, 0.2f, 0.2f).Mult_glRotate(PI / 2, 0.0f, 0.0f, 1.0f).Mult_glScale(0.2f, 4.0f, 0.2f);
+    stoveBarNodes[0] = stoveScene.AddNode(stoveViewNode, mat);
+
+    //door frame
+    mat.Set_glTranslate(0.0f, 4.4f, 0.4f).Mult_glRotate(PI / 2, 0.0f, 0.0f, 1.0f).Mult_glScale(0.2f, 3.0f, 0.2f);
+    stoveBarNodes[1] = stoveScene.AddNode(stoveDoorNode, mat);
+}
+
 void MyRemeshGeometries() 
 {
 // IT IS NOT NECESSARY TO REMESH EITHER THE FLOOR OR THE BACK WALL
@@ -255,6 +337,12 @@ void MyRemeshGeometries()
 void MyRenderGeometries() {
 
     float matEntries[16];       // Temporary storage for floats
+    float normalMatEntries[9];  // Temporary storage for a normal matrix
+    // The modelview matrices are all affine: AffineMapR3 avoids full 4x4 products.
+    //    The view is rigid, so its normal matrix needs no inverse.
+    AffineMapR3 viewAffine(viewMatrix);
+    float viewNormalMatEntries[9];
+    viewAffine.DumpNormalMatrixRigid(viewNormalMatEntries);
     // ******
     // Render the Floor - using a procedural texture map
     // ******
@@ -262,7 +350,7 @@ void MyRenderGeometries() {
     glBindVertexArray(myVAO[iFloor]);                // Select the floor VAO (Vertex Array Object)
     materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
     viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    loadModelviewMatrix(matEntries, viewNormalMatEntries);
     glBindTexture(GL_TEXTURE_2D, TextureNames[0]);
     glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
     // Draw the floor as a single triangle strip
@@ -273,7 +361,7 @@ void MyRenderGeometries() {
     glBindVertexArray(myVAO[iWall]);
     materialUnderTexture.LoadIntoShaders();
     viewMatrix.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    loadModelviewMatrix(matEntries, viewNormalMatEntries);
     glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
     glUniform1i(applyTextureLocation, true);
     glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
@@ -281,16 +369,15 @@ void MyRenderGeometries() {
 
     glEnable(GL_POLYGON_OFFSET_FILL);
     glPolygonOffset(0.2f, 0.2f);
-    LinearMapR4 cubeMat = viewMatrix;
 
 #if 0
-    cubeMat = viewMatrix;
+    AffineMapR3 cubeMat = viewAffine;
     cubeMat.Mult_glTranslate(0.0f, 2.4f, 3.0f);
     cubeMat.Mult_glScale(2.0f);
     glBindVertexArray(myVAO[iCube]);
     metalMaterial.LoadIntoShaders();
     cubeMat.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    loadModelviewMatrix(matEntries, cubeMat.DumpNormalMatrixUniformScale(normalMatEntries));
     glBindTexture(GL_TEXTURE_2D, TextureNames[3]);
     glUniform1i(applyTextureLocation, true);
     glDrawArrays(GL_TRIANGLES, 0, 36);
@@ -298,101 +385,33 @@ void MyRenderGeometries() {
     return;
 #endif
     
-    //stove
-    //bottom
-    cubeMat.Mult_glTranslate(0.0, 0.1f, -3.0f);
-    cubeMat.Mult_glScale(8.0f, 0.2f, 6.0f);
-    renderCube(cubeMat, matEntries);
-
-    //top
-    cubeMat = viewMatrix;
-    cubeMat.Mult_glTranslate(0.0f, 5.0f, -3.0f);
-    cubeMat.Mult_glScale(8.0f, 1.0f, 6.0f);
-    renderCube(cubeMat, matEntries);
-    
-    cubeMat = viewMatrix;
-    cubeMat.Mult_glTranslate(0.0f, 2.75f, -6.1f);
-    cubeMat.Mult_glScale(8.0f, 5.5f, 0.2f);
-    renderCube(cubeMat, matEntries);
-
-    cubeMat = viewMatrix;
-    cubeMat.Mult_glTranslate( 4.1f, 2.75f, -3.1f);
-    cubeMat.Mult_glScale(0.2f, 5.5f, 6.2f);
-    renderCube(cubeMat, matEntries);
-
-    cubeMat = viewMatrix;
-    cubeMat.Mult_glTranslate(-4.1f, 2.75f, -3.1f);
-    cubeMat.Mult_glScale(0.2f, 5.5f, 6.2f);
-    renderCube(cubeMat, matEntries);
-
-    LinearMapR4 barMat = viewMatrix;
-    barMat.Mult_glTranslate(0.0f, 0.2f, 0.2f);
-    barMat.Mult_glRotate(PI / 2, 0.0f, 0.0f, 1.0f);
-    barMat.Mult_glScale(0.2f, 4.0f, 0.2f);
-    barMat.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    texCylinder.Render();
-    
-
-    //door frame
+    // The stove and its door: the modelview matrices come from the scene graph,
+    //    and are only recalculated when the view or the door angle changes.
     float r = (float)currentTime / 100.0f * ((float)PI / 2.0f);
-    cubeMat = viewMatrix;
-    cubeMat = axisRotation(cubeMat, 0.0f, -0.1f, -0.1f, r, 'x');
-    cubeMat.Mult_glTranslate(3.7f, 2.4f, 0.1f);
-    cubeMat.Mult_glScale(0.6f, 4.2f, 0.2f);
-    renderCube(cubeMat, matEntries);
-    
-    cubeMat = viewMatrix;
-    cubeMat = axisRotation(cubeMat, 0.0f, -0.1f, -0.1f, r, 'x');
-    cubeMat.Mult_glTranslate(-3.7f, 2.4f, 0.1f);
-    cubeMat.Mult_glScale(0.6f, 4.2f, 0.2f);
-    renderCube(cubeMat, matEntries);
-
-    cubeMat = viewMatrix;
-    cubeMat = axisRotation(cubeMat, 0.0f, -0.1f, -0.1f, r, 'x');
-    cubeMat.Mult_glTranslate(0.0f,0.6f,0.1f);
-    cubeMat.Mult_glScale(6.8f, 1.0f, 0.2f);
-    renderCube(cubeMat, matEntries);
-
-    cubeMat = viewMatrix;
-    cubeMat = axisRotation(cubeMat, 0.0f, -0.1f, -0.1f, r, 'x');
-    cubeMat.Mult_glTranslate(0.0f, 4.1f, 0.1f);
-    cubeMat.Mult_glScale(6.8f, 0.8f, 0.2f);
-    renderCube(cubeMat, matEntries);
-
-    barMat = viewMatrix;
-    barMat = axisRotation(barMat, 0.0f, -0.1f, -0.1f, r, 'x');
-    barMat.Mult_glTranslate(0.0f, 4.4f, 0.4f);
-    barMat.Mult_glRotate(PI/2,0.0f,0.0f, 1.0f);
-    barMat.Mult_glScale(0.2f, 3.0f, 0.2f);
-    barMat.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    texCylinder.Render();
-
-    //bottons
-    barMat = viewMatrix;
-    barMat.Mult_glTranslate(0.0f, 5.0f, 0.05f);
-    barMat.Mult_glRotate(PI / 2, 1.0f, 0.0f, 0.0f);
-    barMat.Mult_glScale(0.3f, 0.05f, 0.3f);
-    barMat.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    texCylinder.Render();
-
-    barMat = viewMatrix;
-    barMat.Mult_glTranslate(1.5f, 5.0f, 0.05f);
-    barMat.Mult_glRotate(PI / 2, 1.0f, 0.0f, 0.0f);
-    barMat.Mult_glScale(0.3f, 0.05f, 0.3f);
-    barMat.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    texCylinder.Render();
-
-    barMat = viewMatrix;
-    barMat.Mult_glTranslate(-1.5f, 5.0f, 0.05f);
-    barMat.Mult_glRotate(PI / 2, 1.0f, 0.0f, 0.0f);
-    barMat.Mult_glScale(0.3f, 0.05f, 0.3f);
-    barMat.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    texCylinder.Render();
+    stoveScene.SetLocal(stoveViewNode, viewAffine);
+    stoveScene.SetLocal(stoveDoorNode, axisRotation(AffineMapR3(), 0.0f, -0.1f, -0.1f, r, 'x'));
+    stoveScene.Update();
+    for (int i = 0; i < NumStoveCubes; i++) {
+        renderCube(stoveScene.GetWorldFloats(stoveCubeNodes[i]), stoveScene.GetNormalFloats(stoveCubeNodes[i]));
+    }
+    for (int i = 0; i < NumStoveBars; i++) {
+        loadModelviewMatrix(stoveScene.GetWorldFloats(stoveBarNodes[i]), stoveScene.GetNormalFloats(stoveBarNodes[i]));
+        texCylinder.Render();
+    }
+
+    //bottons, tray bars and tray rails
+    // These are all copies of the same cylinder with the same material,
+    //    so they are drawn with a single instanced draw call.
+    // The instance matrices are relative to the viewMatrix.
+    float* toInstanceMat = barsInstanceMats;
+    LinearMapR4f instMat;
+    for (int i = -1; i <= 1; i++) {
+        instMat.Set_glTranslate(1.5f * i, 5.0f, 0.05f);
+        instMat.Mult_glRotate(PI / 2, 1.0f, 0.0f, 0.0f);
+        instMat.Mult_glScale(0.3f, 0.05f, 0.3f);
+        instMat.DumpByColumns(toInstanceMat);
+        toInstanceMat += InstanceFloats;
+    }
     float translation;
     if (currentTime < 50) {
         translation = 0;
@@ -402,36 +421,39 @@ void MyRenderGeometries() {
     }
     
     for (int i = 0;  i < 15; i++) {
-        barMat = viewMatrix;
-        barMat.Mult_glTranslate(-3.5f+i*0.5f, 1.5f, -3.0f+translation);
-        barMat.Mult_glRotate(PI / 2, 1.0f, 0.0f, 0.0f);
-        barMat.Mult_glScale(0.1f,2.5f,0.1f);
-        barMat.DumpByColumns(matEntries);
-        glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-        texCylinder.Render();
+        instMat.Set_glTranslate(-3.5f+i*0.5f, 1.5f, -3.0f+translation);
+        instMat.Mult_glRotate(PI / 2, 1.0f, 0.0f, 0.0f);
+        instMat.Mult_glScale(0.1f,2.5f,0.1f);
+        instMat.DumpByColumns(toInstanceMat);
+        toInstanceMat += InstanceFloats;
     }
 
-    barMat = viewMatrix;
-    barMat.Mult_glTranslate(0.0f, 1.5f, -0.5f + translation);
-    barMat.Mult_glRotate(PI / 2, 0.0f, 0.0f, 1.0f);
-    barMat.Mult_glScale(0.1f, 3.5f, 0.1f);
-    barMat.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    texCylinder.Render();
-
-    barMat = viewMatrix;
-    barMat.Mult_glTranslate(0.0f, 1.5f, -5.5f + translation);
-    barMat.Mult_glRotate(PI / 2, 0.0f, 0.0f, 1.0f);
-    barMat.Mult_glScale(0.1f, 3.5f, 0.1f);
-    barMat.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    texCylinder.Render();
+    for (int i = 0; i < 2; i++) {
+        instMat.Set_glTranslate(0.0f, 1.5f, -0.5f - 5.0f * i + translation);
+        instMat.Mult_glRotate(PI / 2, 0.0f, 0.0f, 1.0f);
+        instMat.Mult_glScale(0.1f, 3.5f, 0.1f);
+        instMat.DumpByColumns(toInstanceMat);
+        toInstanceMat += InstanceFloats;
+    }
+    assert(toInstanceMat - barsInstanceMats == InstanceFloats * NumBarInstances);
+    // The normal matrices of all the instances, in one pass.  The bars are scaled
+    //    non-uniformly, so these need the general inverse transpose.
+    LinearMapR4f::NormalMatrices(barsInstanceMats, barsInstanceMats + 16, NumBarInstances,
+                                 InstanceFloats, InstanceFloats);
+
+    glBindBuffer(GL_ARRAY_BUFFER, barsInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(barsInstanceMats), barsInstanceMats, GL_STREAM_DRAW);
+    selectShaderProgram(shaderProgramBitmapInstanced);
+    viewMatrix.DumpByColumns(matEntries);
+    loadModelviewMatrix(matEntries, viewNormalMatEntries);
+    texCylinder.RenderInstanced(NumBarInstances, barsInstanceVBO);
+    selectShaderProgram(shaderProgramBitmap);
 
 
 
     donutMaterial.LoadIntoShaders();
     if (clicked!=1) {
-        LinearMapR4 donutMat = viewMatrix;
+        AffineMapR3 donutMat = viewAffine;
         donutMat.Mult_glTranslate(0.0f, 2.0f, -3.0f + translation);
         donutMat.Mult_glScale(0.8f, 0.5f, 0.8f);
         
@@ -449,8 +471,8 @@ void MyRenderGeometries() {
             glUniform1i(applyTextureLocation, true);
         }
         donutMat.DumpByColumns(matEntries);
-        glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-        texTorus.Render();
+        loadModelviewMatrix(matEntries, donutMat.DumpNormalMatrix(normalMatEntries));
+        texTorus.RenderLod(matEntries);
         glUniform1i(applyTextureLocation, false);
     }
 
@@ -462,7 +484,7 @@ void MyRenderGeometries() {
 
 
 void setupCube(){
-    float cubeVerts[] = {
+    static constexpr float cubeVerts[] = {
         //front face two triangles          Normals                 Texture
         -0.5f, -0.5f, 0.5f,                 0.0f,0.0f,0.5f,         0.25f,0.333f,
         0.5f, -0.5f, 0.5f,                  0.0f,0.0f,0.5f,         0.5f,0.333f,
@@ -530,32 +552,33 @@ void setupCube(){
 
 }
 
-void renderCube(LinearMapR4 cubematrix,float* matEntries) {
+void renderCube(const float* cubeMatEntries, const float* cubeNormalMatEntries) {
     glBindVertexArray(myVAO[iCube]);
     metalMaterial.LoadIntoShaders();
-    cubematrix.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    loadModelviewMatrix(cubeMatEntries, cubeNormalMatEntries);
     glBindTexture(GL_TEXTURE_2D, TextureNames[1]);
     glUniform1i(applyTextureLocation, true);
     glDrawArrays(GL_TRIANGLES,0,36);
     glUniform1i(applyTextureLocation, false);
 }
 
-LinearMapR4 axisRotation(LinearMapR4 mat, float x, float y, float z, float r, char axis) {
-    mat.Mult_glTranslate(-x, -y, -z);
+AffineMapR3 axisRotation(AffineMapR3 mat, float x, float y, float z, float r, char axis) {
+    Quaternion rot;
     switch (axis)
     {
     case 'x':
-        mat.Mult_glRotate(r, 1.0f, 0.0f, 0.0f);
+        rot.SetRotate(r, 1.0f, 0.0f, 0.0f);
         break;
     case 'y':
-        mat.Mult_glRotate(r, 0.0f, 1.0f, 0.0f);
+        rot.SetRotate(r, 0.0f, 1.0f, 0.0f);
         break;
     case 'z':
-        mat.Mult_glRotate(r, 0.0f, 0.0f, 1.0f);
+        rot.SetRotate(r, 0.0f, 0.0f, 1.0f);
         break;
     }
     
+    mat.Mult_glTranslate(-x, -y, -z);
+    mat.Mult_glRotate(rot);
     mat.Mult_glTranslate(x, y, z);
     return mat;
 }
\ No newline at end of file
@@ -20,6 +20,8 @@ void MyRemeshGeometries();             // Called when mesh changes, must update
 void MyRenderGeometries();            // Called to render the two surfaces
 
 void setupCube();
-void renderCube(LinearMapR4 cubematrix, float* matEntries);
-LinearMapR4 axisRotation(LinearMapR4 mat, float x, float y, float z, float r,char axis);
+void setupStoveScene();
+class AffineMapR3;
+void renderCube(const float* cubeMatEntries, const float* cubeNormalMatEntries);
+AffineMapR3 axisRotation(AffineMapR3 mat, float x, float y, float z, float r,char axis);
 
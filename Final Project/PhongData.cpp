@@ -48,6 +48,7 @@ void MySetupGlobalLight()
 void MySetupLights()
 {
 
+    myLightSphere.SetNumLodLevels(3);
     myLightSphere.InitializeAttribLocations(vertPos_loc); 
     
     // First light (light #0).
@@ -131,10 +132,10 @@ void MyRenderSpheresForLights() {
             modelviewMat.Mult_glTranslate(myLightPositions[i].x, myLightPositions[i].y,myLightPositions[i].z);
             modelviewMat.Mult_glScale(0.2);
             modelviewMat.DumpByColumns(matEntries);
-            glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+            loadModelviewMatrixUniformScale(matEntries);
             myEmissiveMaterial.EmissiveColor = myLights[i].DiffuseColor;
             myEmissiveMaterial.LoadIntoShaders();
-            myLightSphere.Render();
+            myLightSphere.RenderLod(matEntries);
         }
     }
 }
@@ -0,0 +1,193 @@
+/*
+ *
+ * Quaternion.cpp
+ *
+ * Quaternions, for representing and composing rotations in R3.  See Quaternion.h.
+ *
+ */
+
+#include "Quaternion.h"
+
+// ******************************************************
+// * Quaternion class - math library functions          *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+// The length of rotVec is the rotation angle; its direction is the axis.
+Quaternion& Quaternion::SetRotate( const VectorR3& rotVec )
+{
+    double theta = rotVec.Norm();
+    if ( theta == 0.0 ) {
+        return SetIdentity();
+    }
+    double s = sin(0.5*theta) / theta;
+    return Set( s*rotVec.x, s*rotVec.y, s*rotVec.z, cos(0.5*theta) );
+}
+
+// Convert a rotation matrix to a quaternion.
+//   The largest of |x|, |y|, |z|, |w| is calculated first from the diagonal, for numerical
+//   stability; the other three then come from the off-diagonal entries.
+Quaternion& Quaternion::Set( const Matrix3x3& R )
+{
+    double trace = R.m11 + R.m22 + R.m33;
+    if ( trace >= R.m11 && trace >= R.m22 && trace >= R.m33 ) {
+        w = 0.5*sqrt( 1.0 + trace );
+        double f = 0.25 / w;
+        x = (R.m32 - R.m23) * f;
+        y = (R.m13 - R.m31) * f;
+        z = (R.m21 - R.m12) * f;
+    }
+    else if ( R.m11 >= R.m22 && R.m11 >= R.m33 ) {
+        x = 0.5*sqrt( 1.0 + R.m11 - R.m22 - R.m33 );
+        double f = 0.25 / x;
+        w = (R.m32 - R.m23) * f;
+        y = (R.m12 + R.m21) * f;
+        z = (R.m13 + R.m31) * f;
+    }
+    else if ( R.m22 >= R.m33 ) {
+        y = 0.5*sqrt( 1.0 - R.m11 + R.m22 - R.m33 );
+        double f = 0.25 / y;
+        w = (R.m13 - R.m31) * f;
+        x = (R.m12 + R.m21) * f;
+        z = (R.m23 + R.m32) * f;
+    }
+    else {
+        z = 0.5*sqrt( 1.0 - R.m11 - R.m22 + R.m33 );
+        double f = 0.25 / z;
+        w = (R.m21 - R.m12) * f;
+        x = (R.m13 + R.m31) * f;
+        y = (R.m23 + R.m32) * f;
+    }
+    return *this;
+}
+
+Quaternion& Quaternion::Set( const Matrix4x4& R )
+{
+    Matrix3x3 R3( R.m11, R.m21, R.m31, R.m12, R.m22, R.m32, R.m13, R.m23, R.m33 );
+    return Set( R3 );
+}
+
+void Quaternion::ToMatrix3x3( Matrix3x3* R ) const
+{
+    double x2 = x + x, y2 = y + y, z2 = z + z;
+    double xx2 = x*x2, yy2 = y*y2, zz2 = z*z2;
+    double xy2 = x*y2, xz2 = x*z2, yz2 = y*z2;
+    double wx2 = w*x2, wy2 = w*y2, wz2 = w*z2;
+    R->Set( 1.0 - yy2 - zz2, xy2 + wz2, xz2 - wy2,          // Set by columns
+            xy2 - wz2, 1.0 - xx2 - zz2, yz2 + wx2,
+            xz2 + wy2, yz2 - wx2, 1.0 - xx2 - yy2 );
+}
+
+LinearMapR4 Quaternion::ToLinearMapR4() const
+{
+    Matrix3x3 R;
+    ToMatrix3x3( &R );
+    return LinearMapR4( R.m11, R.m21, R.m31, 0.0, R.m12, R.m22, R.m32, 0.0,
+                        R.m13, R.m23, R.m33, 0.0, 0.0, 0.0, 0.0, 1.0 );
+}
+
+double Quaternion::RotationAngle() const
+{
+    double halfAngle = atan2( sqrt(x*x + y*y + z*z), w );
+    return 2.0*halfAngle;
+}
+
+void Quaternion::Rotate( VectorR3* v, int count ) const
+{
+    Matrix3x3 R;
+    ToMatrix3x3( &R );
+    for ( int i = 0; i < count; i++ ) {
+        R.Transform( v + i );
+    }
+}
+
+// ******************************************************
+// * Interpolation of rotations                         *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+Quaternion Slerp( const Quaternion& q1, const Quaternion& q2, double alpha )
+{
+    double cosOmega = q1 ^ q2;
+    double sign = 1.0;
+    if ( cosOmega < 0.0 ) {         // q2 and -q2 are the same rotation: use the shorter arc
+        cosOmega = -cosOmega;
+        sign = -1.0;
+    }
+    double c1, c2;
+    if ( cosOmega > 0.9995 ) {
+        // Nearly the same rotation: sin(omega) is too small to divide by.
+        //   Linear interpolation (and normalizing) is accurate here.
+        c1 = 1.0 - alpha;
+        c2 = alpha;
+    }
+    else {
+        double omega = acos( cosOmega );
+        double sinOmegaInv = 1.0 / sin(omega);
+        c1 = sin( (1.0 - alpha)*omega ) * sinOmegaInv;
+        c2 = sin( alpha*omega ) * sinOmegaInv;
+    }
+    c2 *= sign;
+    Quaternion q( c1*q1.x + c2*q2.x, c1*q1.y + c2*q2.y, c1*q1.z + c2*q2.z, c1*q1.w + c2*q2.w );
+    if ( cosOmega > 0.9995 ) {
+        q.Normalize();
+    }
+    return q;
+}
+
+Quaternion Nlerp( const Quaternion& q1, const Quaternion& q2, double alpha )
+{
+    double c1 = 1.0 - alpha;
+    double c2 = ( (q1 ^ q2) < 0.0 ) ? -alpha : alpha;
+    Quaternion q( c1*q1.x + c2*q2.x, c1*q1.y + c2*q2.y, c1*q1.z + c2*q2.z, c1*q1.w + c2*q2.w );
+    return q.Normalize();
+}
+
+void Slerp( const Quaternion* q1, const Quaternion* q2, double alpha, Quaternion* dest, int count )
+{
+    for ( int i = 0; i < count; i++ ) {
+        dest[i] = Slerp( q1[i], q2[i], alpha );
+    }
+}
+
+void Nlerp( const Quaternion* q1, const Quaternion* q2, double alpha, Quaternion* dest, int count )
+{
+    for ( int i = 0; i < count; i++ ) {
+        dest[i] = Nlerp( q1[i], q2[i], alpha );
+    }
+}
+
+// ******************************************************
+// * VectorR3 and VectorR4 functions using quaternions  *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+// Convert a unit quaternion to a rotation vector: the axis scaled by the rotation angle.
+VectorR3& VectorR3::Set( const Quaternion& q )
+{
+    double sinHalf = sqrt( q.x*q.x + q.y*q.y + q.z*q.z );
+    if ( sinHalf == 0.0 ) {
+        return SetZero();
+    }
+    double halfAngle = atan2( sinHalf, q.w );
+    double f = 2.0*halfAngle / sinHalf;
+    x = f*q.x;
+    y = f*q.y;
+    z = f*q.z;
+    return *this;
+}
+
+// Rotate by the unit quaternion q:  v' = v + 2w(u*v) + 2u*(u*v),  where u = (q.x, q.y, q.z)
+//    and * is the cross product.  This does not form the rotation matrix.
+VectorR3& VectorR3::Rotate( const Quaternion& q )
+{
+    double tx = 2.0*(q.y*z - q.z*y);         // t = 2 u*v
+    double ty = 2.0*(q.z*x - q.x*z);
+    double tz = 2.0*(q.x*y - q.y*x);
+    x += q.w*tx + (q.y*tz - q.z*ty);
+    y += q.w*ty + (q.z*tx - q.x*tz);
+    z += q.w*tz + (q.x*ty - q.y*tx);
+    return *this;
+}
+
+VectorR4& VectorR4::Set( const Quaternion& q )
+{
+    return Set( q.x, q.y, q.z, q.w );
+}
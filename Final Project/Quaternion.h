@@ -0,0 +1,128 @@
+/*
+ *
+ * Quaternion.h
+ *
+ * Quaternions, for representing and composing rotations in R3.
+ *
+ *   The Quaternion class is forward declared in LinearR3.h, which also
+ *   declares VectorR3::Set(const Quaternion&) and VectorR3::Rotate(const Quaternion&).
+ *   Those are defined in Quaternion.cpp.
+ *
+ *   A unit quaternion q = (x,y,z,w) = (sin(theta/2)*u, cos(theta/2)) represents
+ *   the rotation by theta radians around the unit vector u.
+ *   The product q1*q2 is the rotation q2 followed by the rotation q1, the same
+ *   order as for matrices.  Composing two rotations takes 16 multiplications,
+ *   instead of the 27 of a 3x3 matrix product.
+ *
+ */
+
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include "LinearR3.h"
+#include "LinearR4.h"
+
+class Quaternion;
+
+// *****************************************
+// Quaternion class                        *
+// * * * * * * * * * * * * * * * * * * * * *
+
+class Quaternion {
+
+public:
+    double x, y, z, w;      // The vector part is (x,y,z), the scalar part is w.
+
+public:
+    Quaternion() : x(0.0), y(0.0), z(0.0), w(1.0) {}       // The identity rotation
+    Quaternion( double xx, double yy, double zz, double ww ) : x(xx), y(yy), z(zz), w(ww) {}
+
+    Quaternion& Set( double xx, double yy, double zz, double ww )
+            { x = xx; y = yy; z = zz; w = ww; return *this; }
+    Quaternion& SetIdentity() { x = 0.0; y = 0.0; z = 0.0; w = 1.0; return *this; }
+    Quaternion& SetRotate( double theta, const VectorR3& axis );      // axis need not be a unit vector
+    Quaternion& SetRotate( double theta, double ax, double ay, double az );
+    Quaternion& SetRotate( const VectorR3& rotVec );      // Rotation vector: the length is the angle
+    Quaternion& Set( const Matrix3x3& R );                // R must be a rotation matrix
+    Quaternion& Set( const Matrix4x4& R );                // Uses the upper 3x3 part, which must be a rotation
+
+    void ToMatrix3x3( Matrix3x3* R ) const;               // q must be a unit quaternion
+    LinearMapR4 ToLinearMapR4() const;                    // The 4x4 rotation matrix
+
+    double Norm() const { return sqrt(x*x + y*y + z*z + w*w); }
+    double NormSq() const { return x*x + y*y + z*z + w*w; }
+    Quaternion& Normalize() { double nInv = 1.0 / Norm(); x *= nInv; y *= nInv; z *= nInv; w *= nInv; return *this; }
+    Quaternion& Conjugate() { x = -x; y = -y; z = -z; return *this; }   // The inverse rotation, for unit q
+    Quaternion& Negate() { x = -x; y = -y; z = -z; w = -w; return *this; }  // The same rotation
+    double RotationAngle() const;                         // In [0, 2*pi]
+
+    Quaternion& operator*= ( const Quaternion& q );       // this = this * q
+    Quaternion& LeftMultiplyBy( const Quaternion& q );    // this = q * this
+
+    // Rotate count vectors, in place.  Faster than VectorR3::Rotate for more than a few vectors,
+    //    since the quaternion is converted to a rotation matrix once.
+    void Rotate( VectorR3* v, int count ) const;
+
+};
+
+inline Quaternion operator* ( const Quaternion& q1, const Quaternion& q2 );
+inline double operator^ ( const Quaternion& q1, const Quaternion& q2 );     // Dot product
+
+// Spherical linear interpolation: constant angular speed, from q1 (alpha=0) to q2 (alpha=1).
+//   q1 and q2 must be unit quaternions.  Takes the shorter of the two arcs.
+Quaternion Slerp( const Quaternion& q1, const Quaternion& q2, double alpha );
+// Normalized linear interpolation: faster than Slerp, with the same path but not constant speed.
+Quaternion Nlerp( const Quaternion& q1, const Quaternion& q2, double alpha );
+// Batched versions: dest[i] = Slerp(q1[i], q2[i], alpha), for 0 <= i < count.
+//   For example, for the joints of an animated model at one time step.
+void Slerp( const Quaternion* q1, const Quaternion* q2, double alpha, Quaternion* dest, int count );
+void Nlerp( const Quaternion* q1, const Quaternion* q2, double alpha, Quaternion* dest, int count );
+
+// *********************************************************
+// * Quaternion class - inlined functions                  *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * *****
+
+inline Quaternion& Quaternion::SetRotate( double theta, const VectorR3& axis )
+{
+    return SetRotate( theta, axis.x, axis.y, axis.z );
+}
+
+inline Quaternion& Quaternion::SetRotate( double theta, double ax, double ay, double az )
+{
+    double normSq = ax*ax + ay*ay + az*az;
+    assert( normSq > 0.0 );
+    double s = sin(0.5*theta) / sqrt(normSq);
+    return Set( s*ax, s*ay, s*az, cos(0.5*theta) );
+}
+
+inline Quaternion& Quaternion::operator*= ( const Quaternion& q )
+{
+    double xx = w*q.x + x*q.w + y*q.z - z*q.y;
+    double yy = w*q.y + y*q.w + z*q.x - x*q.z;
+    double zz = w*q.z + z*q.w + x*q.y - y*q.x;
+    w = w*q.w - x*q.x - y*q.y - z*q.z;
+    x = xx;
+    y = yy;
+    z = zz;
+    return *this;
+}
+
+inline Quaternion& Quaternion::LeftMultiplyBy( const Quaternion& q )
+{
+    *this = q * (*this);
+    return *this;
+}
+
+inline Quaternion operator* ( const Quaternion& q1, const Quaternion& q2 )
+{
+    Quaternion q(q1);
+    q *= q2;
+    return q;
+}
+
+inline double operator^ ( const Quaternion& q1, const Quaternion& q2 )
+{
+    return q1.x*q2.x + q1.y*q2.y + q1.z*q2.z + q1.w*q2.w;
+}
+
+#endif  // QUATERNION_H
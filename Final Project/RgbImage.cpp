@@ -23,6 +23,11 @@
 #define _CRT_SECURE_NO_DEPRECATE 1
 
 #include "RgbImage.h"
+#include "MathMisc.h"
+#include <string.h>
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
 
 #ifndef RGBIMAGE_DONT_USE_OPENGL
 #if defined(_WIN32)			// If on windows, need this for gl.h
@@ -89,26 +94,29 @@ bool RgbImage::LoadBmpFile( const char* filename )
 		return false;
 	}
 
+	// The header fields are read with a single fread, and then unpacked.
 	bool fileFormatOK = false;
-	int bChar = fgetc( infile );
-	int mChar = fgetc( infile );
-	if ( bChar=='B' && mChar=='M' ) {			// If starts with "BM" for "BitMap"
-		skipChars(infile, 4 + 2 + 2);			// Skip 3 fields (size of file and two reserved fields)
-		int offset = readLong(infile);			// Offset to the bitmap table
-		int headerSize = readLong(infile);		// Size of the Bitmap header
-		NumCols = readLong( infile );
-		NumRows = readLong( infile );
-		skipChars( infile, 2 );					// Skip one field (number of color planes)
-		int bitsPerPixel = readShort( infile );
-		int bytesRead = 30;						// 2 + 4 + 2 + 2 + 4 + 4 + 4 + 4 + 2 + 2
-		int compressionMethod = BI_RGB;
+	unsigned char header[34];
+	if ( fread( header, 1, 30, infile )==30 && header[0]=='B' && header[1]=='M' ) {	// If starts with "BM" for "BitMap"
+		// Skip 3 fields (size of file and two reserved fields)
+		long offset = getLong( header+10 );		// Offset to the bitmap table
+		long headerSize = getLong( header+14 );	// Size of the Bitmap header
+		NumCols = getLong( header+18 );
+		NumRows = getLong( header+22 );
+		// Skip one field (number of color planes)
+		int bitsPerPixel = getShort( header+28 );
+		long bytesRead = 30;					// 2 + 4 + 2 + 2 + 4 + 4 + 4 + 4 + 2 + 2
+		long compressionMethod = BI_RGB;
 		if (headerSize >= 40) {
-			compressionMethod = readLong(infile);
-			bytesRead += 4;
+			bytesRead += (long)fread( header+30, 1, 4, infile );
+			compressionMethod = getLong(header+30);
+		}
+		if ( offset > bytesRead ) {
+			fseek( infile, offset, SEEK_SET );
 		}
-		skipChars(infile, offset - bytesRead);
 
-		if ( NumCols>0 && NumCols<=100000 && NumRows>0 && NumRows<=100000  
+		if ( bytesRead>=30+(headerSize>=40 ? 4 : 0)
+			&& NumCols>0 && NumCols<=100000 && NumRows>0 && NumRows<=100000  
 			&& bitsPerPixel==24 && compressionMethod ==BI_RGB && !feof(infile) ) {
 			fileFormatOK = true;
 		}
@@ -127,22 +135,11 @@ bool RgbImage::LoadBmpFile( const char* filename )
 		return false;
 	}
 
-	unsigned char* cPtr = ImagePtr;
-	for ( int i=0; i<NumRows; i++ ) {
-		int j;
-		for ( j=0; j<NumCols; j++ ) {
-			*(cPtr+2) = (unsigned char)fgetc( infile );	// Blue color value
-			*(cPtr+1) = (unsigned char)fgetc( infile );	// Green color value
-			*cPtr = (unsigned char)fgetc( infile );		// Red color value
-			cPtr += 3;
-		}
-		int k=3*NumCols;					// Num bytes already read
-		for ( ; k<GetNumBytesPerRow(); k++ ) {
-			fgetc( infile );				// Read and ignore padding;
-			*(cPtr++) = 0;
-		}
-	}
-	if ( feof( infile ) ) {
+	// The rows in the file are padded to multiples of four bytes, the same as in ImagePtr:
+	//   so the whole pixel table is read at once, and then converted from BGR to RGB in place.
+	long rowLen = GetNumBytesPerRow();
+	size_t tableSize = (size_t)NumRows*(size_t)rowLen;
+	if ( fread( ImagePtr, 1, tableSize, infile ) != tableSize ) {
 		fprintf( stderr, "Premature end of file: %s.\n", filename );
 		Reset();
 		ErrorCode = ReadError;
@@ -150,46 +147,74 @@ bool RgbImage::LoadBmpFile( const char* filename )
 		return false;
 	}
 	fclose( infile );	// Close the file
+
+	unsigned char* cPtr = ImagePtr;
+	for ( long i=0; i<NumRows; i++ ) {
+		swapRedBlue( cPtr, cPtr, NumCols );
+		memset( cPtr+3*NumCols, 0, rowLen-3*NumCols );	// Padding is zeroed
+		cPtr += rowLen;
+	}
 	ErrorCode = NoError;
 	return true;
 }
 
-short RgbImage::readShort( FILE* infile )
+short RgbImage::getShort( const unsigned char* bytes )
 {
-	// read a 16 bit integer
-    unsigned char lowByte = (unsigned char)fgetc(infile);			// Read the low order byte (little endian form)
-    unsigned char hiByte = (unsigned char)fgetc(infile);			// Read the high order byte
-
-	// Pack together
-	short ret = hiByte;
+	// 16 bit integer, low order byte first (little endian form)
+	short ret = bytes[1];
 	ret <<= 8;
-	ret |= lowByte;
+	ret |= bytes[0];
 	return ret;
 }
 
-long RgbImage::readLong( FILE* infile )
+long RgbImage::getLong( const unsigned char* bytes )
 {  
-	// Read in 32 bit integer
-    unsigned char byte0 = (unsigned char)fgetc(infile);			// Read bytes, low order to high order
-    unsigned char byte1 = (unsigned char)fgetc(infile);
-    unsigned char byte2 = (unsigned char)fgetc(infile);
-    unsigned char byte3 = (unsigned char)fgetc(infile);
-
-	// Pack together
-	long ret = byte3;
+	// 32 bit integer, bytes from low order to high order
+	long ret = bytes[3];
 	ret <<= 8;
-	ret |= byte2;
+	ret |= bytes[2];
 	ret <<= 8;
-	ret |= byte1;
+	ret |= bytes[1];
 	ret <<= 8;
-	ret |= byte0;
+	ret |= bytes[0];
 	return ret;
 }
 
-void RgbImage::skipChars( FILE* infile, int numChars )
+// With SSE2, five pixels (15 bytes) are done per 16 byte load: the red and blue bytes
+//    come from the load shifted by two bytes either way, and the green bytes (and the
+//    16th byte) are kept.  The 16th byte belongs to the next block, which is loaded
+//    before this block is stored.  (Loading it after the overlapping store would
+//    stall, and would load the already swapped bytes when src equals dest.)
+void RgbImage::swapRedBlue( const unsigned char* src, unsigned char* dest, long numPixels )
 {
-	for ( int i=0; i<numChars; i++ ) {
-		fgetc( infile );
+	long numBytes = 3*numPixels;
+	long k = 0;
+#ifdef USE_SSE2
+	const __m128i keepMask = _mm_setr_epi8( 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, -1 );
+	const __m128i redMask = _mm_setr_epi8( -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, 0 );
+	const __m128i blueMask = _mm_setr_epi8( 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0 );
+	if ( numBytes >= 16 ) {
+		__m128i v = _mm_loadu_si128( (const __m128i*)src );
+		for ( ; ; k += 15 ) {
+			bool more = ( k+15+16 <= numBytes );
+			__m128i next = more ? _mm_loadu_si128( (const __m128i*)(src+k+15) ) : v;
+			__m128i ret = _mm_and_si128( v, keepMask );
+			ret = _mm_or_si128( ret, _mm_and_si128( _mm_srli_si128( v, 2 ), redMask ) );
+			ret = _mm_or_si128( ret, _mm_and_si128( _mm_slli_si128( v, 2 ), blueMask ) );
+			_mm_storeu_si128( (__m128i*)(dest+k), ret );
+			v = next;
+			if ( !more ) {
+				k += 15;
+				break;
+			}
+		}
+	}
+#endif
+	for ( ; k<numBytes; k += 3 ) {
+		unsigned char t = src[k];
+		dest[k] = src[k+2];
+		dest[k+1] = src[k+1];
+		dest[k+2] = t;
 	}
 }
 
@@ -210,73 +235,61 @@ bool RgbImage::WriteBmpFile( const char* filename )
 		return false;
 	}
 
-	fputc('B',outfile);
-	fputc('M',outfile);
+	// The header is assembled in memory and written with a single fwrite.
 	int rowLen = GetNumBytesPerRow();
-	writeLong( 40+14+NumRows*rowLen, outfile );	// Length of file
-	writeShort( 0, outfile );					// Reserved for future use
-	writeShort( 0, outfile );
-	writeLong( 40+14, outfile );				// Offset to pixel data
-	writeLong( 40, outfile );					// header length
-	writeLong( NumCols, outfile );				// width in pixels
-	writeLong( NumRows, outfile );				// height in pixels (pos for bottom up)
-	writeShort( 1, outfile );		// number of planes
-	writeShort( 24, outfile );		// bits per pixel
-	writeLong( 0, outfile );		// no compression
-	writeLong( 0, outfile );		// not used if no compression
-	writeLong( 0, outfile );		// Pixels per meter
-	writeLong( 0, outfile );		// Pixels per meter
-	writeLong( 0, outfile );		// unused for 24 bits/pixel
-	writeLong( 0, outfile );		// unused for 24 bits/pixel
-
-	// Now write out the pixel data:
-	unsigned char* cPtr = ImagePtr;
-	for ( int i=0; i<NumRows; i++ ) {
-		// Write out i-th row's data
-		int j;
-		for ( j=0; j<NumCols; j++ ) {
-			fputc( *(cPtr+2), outfile);		// Blue color value
-			fputc( *(cPtr+1), outfile);		// Blue color value
-			fputc( *(cPtr+0), outfile);		// Blue color value
-			cPtr+=3;
-		}
-		// Pad row to word boundary
-		int k=3*NumCols;					// Num bytes already read
-		for ( ; k<GetNumBytesPerRow(); k++ ) {
-			fputc( 0, outfile );				// Read and ignore padding;
-			cPtr++;
-		}
+	unsigned char header[14+40];
+	memset( header, 0, sizeof(header) );
+	header[0] = 'B';
+	header[1] = 'M';
+	putLong( 40+14+NumRows*rowLen, header+2 );	// Length of file
+												// Two reserved shorts (zero)
+	putLong( 40+14, header+10 );				// Offset to pixel data
+	putLong( 40, header+14 );					// header length
+	putLong( NumCols, header+18 );				// width in pixels
+	putLong( NumRows, header+22 );				// height in pixels (pos for bottom up)
+	putShort( 1, header+26 );		// number of planes
+	putShort( 24, header+28 );		// bits per pixel
+	// The rest are zero: no compression, image size (not used if no compression),
+	//    pixels per meter (twice), and two fields unused for 24 bits/pixel.
+	bool writeOK = ( fwrite( header, 1, sizeof(header), outfile ) == sizeof(header) );
+
+	// Now write out the pixel data, a row at a time, converted to BGR order.
+	unsigned char* rowBuffer = new unsigned char[rowLen];
+	memset( rowBuffer+3*NumCols, 0, rowLen-3*NumCols );		// Pad row to word boundary
+	const unsigned char* cPtr = ImagePtr;
+	for ( int i=0; i<NumRows && writeOK; i++ ) {
+		swapRedBlue( cPtr, rowBuffer, NumCols );
+		writeOK = ( fwrite( rowBuffer, 1, rowLen, outfile ) == (size_t)rowLen );
+		cPtr += rowLen;
 	}
+	delete[] rowBuffer;
 
-	fclose( outfile );	// Close the file
+	if ( fclose( outfile )!=0 ) {	// Close the file
+		writeOK = false;
+	}
+	if ( !writeOK ) {
+		fprintf(stderr, "Unable to write file: %s\n", filename);
+		ErrorCode = WriteError;
+		return false;
+	}
 	ErrorCode = NoError;
 	return true;
 }
 
-void RgbImage::writeLong( long data, FILE* outfile )
+void RgbImage::putLong( long data, unsigned char* bytes )
 {  
-	// Read in 32 bit integer
-	unsigned char byte0, byte1, byte2, byte3;
-	byte0 = (unsigned char)(data&0x000000ff);		// Write bytes, low order to high order
-	byte1 = (unsigned char)((data>>8)&0x000000ff);
-	byte2 = (unsigned char)((data>>16)&0x000000ff);
-	byte3 = (unsigned char)((data>>24)&0x000000ff);
-
-	fputc( byte0, outfile );
-	fputc( byte1, outfile );
-	fputc( byte2, outfile );
-	fputc( byte3, outfile );
+	// Write out 32 bit integer, bytes low order to high order
+	bytes[0] = (unsigned char)(data&0x000000ff);
+	bytes[1] = (unsigned char)((data>>8)&0x000000ff);
+	bytes[2] = (unsigned char)((data>>16)&0x000000ff);
+	bytes[3] = (unsigned char)((data>>24)&0x000000ff);
 }
 
-void RgbImage::writeShort( short data, FILE* outfile )
+void RgbImage::putShort( short data, unsigned char* bytes )
 {  
-	// Read in 32 bit integer
-	unsigned char byte0, byte1;
-	byte0 = data&0x000000ff;		// Write bytes, low order to high order
-	byte1 = (data>>8)&0x000000ff;
-
-	fputc( byte0, outfile );
-	fputc( byte1, outfile );
+	// Write out 16 bit integer, low order byte first
+	bytes[0] = (unsigned char)(data&0x000000ff);
+	bytes[1] = (unsigned char)((data>>8)&0x000000ff);
 }
 
 
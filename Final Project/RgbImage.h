@@ -78,11 +78,13 @@ private:
 	long NumCols;				// number of columns in image
 	int ErrorCode;				// error code
 
-	static short readShort( FILE* infile );
-	static long readLong( FILE* infile );
-	static void skipChars( FILE* infile, int numChars );
-	static void writeLong( long data, FILE* outfile );
-	static void writeShort( short data, FILE* outfile );
+	// Little endian integers in the file headers
+	static short getShort( const unsigned char* bytes );
+	static long getLong( const unsigned char* bytes );
+	static void putShort( short data, unsigned char* bytes );
+	static void putLong( long data, unsigned char* bytes );
+	// BMP files store pixels as BGR: swap the red and blue of each pixel. src may equal dest.
+	static void swapRedBlue( const unsigned char* src, unsigned char* dest, long numPixels );
 	
 	static unsigned char doubleToUnsignedChar( double x );
 
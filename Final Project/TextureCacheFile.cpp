@@ -0,0 +1,219 @@
+/*
+* TextureCacheFile.cpp
+*
+* On-disk cache of textures and their mipmaps.  See TextureCacheFile.h.
+*/
+
+// This tells the Visual C++ compiler to allow use of fopen, etc.  (As in RgbImage.cpp.)
+#define _CRT_SECURE_NO_DEPRECATE 1
+
+#include "TextureCacheFile.h"
+#include "BmpFileView.h"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "assert.h"
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+#if defined(_WIN32)         // If on windows, need this for gl.h
+#include <windows.h>
+#endif  // defined(_WIN32)
+#include "GL/gl.h"
+#endif
+#ifndef GL_BGR
+#define GL_BGR 0x80E0       // Not in the OpenGL 1.1 gl.h of Windows
+#endif
+
+namespace {
+    const char CacheMagic[8] = { 'T', 'E', 'X', 'C', 'A', 'C', 'H', '1' };
+
+    bool GetFileStat(const char* filename, uint64_t* size, int64_t* modTime)
+    {
+#if defined(_WIN32)
+        struct _stat64 fileStat;
+        if (_stat64(filename, &fileStat) != 0) {
+            return false;
+        }
+#else
+        struct stat fileStat;
+        if (stat(filename, &fileStat) != 0) {
+            return false;
+        }
+#endif
+        *size = (uint64_t)fileStat.st_size;
+        *modTime = (int64_t)fileStat.st_mtime;
+        return true;
+    }
+
+    // 64 bit FNV-1a
+    uint64_t HashBytes(const unsigned char* bytes, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool HashFile(const char* filename, uint64_t* hash)
+    {
+        MappedFile source;
+        if (!source.Open(filename)) {
+            return false;
+        }
+        *hash = HashBytes(source.Data(), source.Size());
+        return true;
+    }
+
+    // Overwrites the sourceModTime field of a cache file's header, so the next
+    //    check of the file does not need to hash its source again.
+    bool WriteModTime(const char* cacheFilename, int64_t sourceModTime)
+    {
+        FILE* cacheFile = fopen(cacheFilename, "r+b");
+        if (!cacheFile) {
+            return false;
+        }
+        bool writeOK = fseek(cacheFile, (long)offsetof(TextureCacheHeader, sourceModTime), SEEK_SET) == 0
+            && fwrite(&sourceModTime, sizeof(sourceModTime), 1, cacheFile) == 1;
+        if (fclose(cacheFile) != 0) {
+            writeOK = false;
+        }
+        return writeOK;
+    }
+
+    uint32_t CalcDataOffset(size_t pathLength)
+    {
+        return (uint32_t)((sizeof(TextureCacheHeader) + pathLength + 15) & ~(size_t)15);
+    }
+
+    uint64_t CalcDataSize(long numRows, long numCols)
+    {
+        long bytesPerRow = ((3 * numCols + 3) >> 2) << 2;
+        return (uint64_t)numRows * bytesPerRow + MipChain::CalcDataSize(numRows, numCols);
+    }
+}
+
+bool TextureCacheFile::OpenForSource(const char* sourceFile, MipFilter mipFilter, bool sRgbAveraging)
+{
+    Close();
+    uint64_t sourceSize;
+    int64_t sourceModTime;
+    std::string cacheFilename = CacheFilename(sourceFile);
+    if (!GetFileStat(sourceFile, &sourceSize, &sourceModTime)
+        || !file.Open(cacheFilename.c_str())) {
+        return false;
+    }
+
+    // Check the header is complete and consistent before using any other field.
+    const TextureCacheHeader* h = (const TextureCacheHeader*)file.Data();
+    size_t pathLength = strlen(sourceFile);
+    bool ok = file.Size() >= sizeof(TextureCacheHeader)
+        && memcmp(h->magic, CacheMagic, sizeof(CacheMagic)) == 0
+        && h->pathLength == pathLength
+        && h->dataOffset == CalcDataOffset(pathLength)
+        && h->dataOffset <= file.Size()
+        && memcmp(file.Data() + sizeof(TextureCacheHeader), sourceFile, pathLength) == 0
+        && h->numRows > 0 && h->numRows <= 100000 && h->numCols > 0 && h->numCols <= 100000
+        && h->dataSize == CalcDataSize(h->numRows, h->numCols)
+        && h->dataOffset + h->dataSize == file.Size()
+        && h->mipFilter == (uint32_t)mipFilter
+        && h->sRgbAveraging == (sRgbAveraging ? 1u : 0u)
+        && h->sourceSize == sourceSize;
+    // A different modification time alone does not mean different contents.
+    uint64_t sourceHash;
+    if (ok && h->sourceModTime != sourceModTime) {
+        ok = HashFile(sourceFile, &sourceHash) && sourceHash == h->sourceHash;
+        if (ok) {
+            // Record the new modification time, so the source is hashed only once.
+            //    The mapping is read only (and on Windows locks out writers), so
+            //    unmap, patch the header, and map again.  If the patch fails, the
+            //    cache is still valid: it is just hashed again next time.
+            file.Close();
+            WriteModTime(cacheFilename.c_str(), sourceModTime);
+            ok = file.Open(cacheFilename.c_str())
+                && file.Size() >= sizeof(TextureCacheHeader) + pathLength;
+            h = (const TextureCacheHeader*)file.Data();
+            ok = ok && h->dataOffset + h->dataSize == file.Size();
+        }
+    }
+    if (!ok) {
+        file.Close();
+        return false;
+    }
+    header = h;
+    return true;
+}
+
+void TextureCacheFile::Close()
+{
+    file.Close();
+    header = 0;
+}
+
+bool TextureCacheFile::Write(const char* sourceFile, const BmpFileView& image, const MipChain& mips,
+                             MipFilter mipFilter, bool sRgbAveraging)
+{
+    assert(image.IsOpen() && mips.GetNumRows(0) == image.GetNumRows() && mips.GetNumCols(0) == image.GetNumCols());
+    TextureCacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CacheMagic, sizeof(CacheMagic));
+    if (!GetFileStat(sourceFile, &h.sourceSize, &h.sourceModTime)
+        || !HashFile(sourceFile, &h.sourceHash)) {
+        return false;
+    }
+    size_t pathLength = strlen(sourceFile);
+    size_t baseSize = (size_t)image.GetNumRows() * image.GetNumBytesPerRow();
+    h.dataOffset = CalcDataOffset(pathLength);
+    h.dataSize = baseSize + mips.DataSize();
+    h.numRows = (uint32_t)image.GetNumRows();
+    h.numCols = (uint32_t)image.GetNumCols();
+    h.numLevels = (uint32_t)mips.GetMaxLevel() + 1;
+    h.mipFilter = (uint32_t)mipFilter;
+    h.sRgbAveraging = sRgbAveraging ? 1 : 0;
+    h.pathLength = (uint32_t)pathLength;
+
+    std::string cacheFilename = CacheFilename(sourceFile);
+    std::string tempFilename = cacheFilename + ".tmp";
+    FILE* outfile = fopen(tempFilename.c_str(), "wb");
+    if (!outfile) {
+        return false;
+    }
+    static const unsigned char zeros[16] = { 0 };
+    size_t padding = h.dataOffset - sizeof(TextureCacheHeader) - pathLength;
+    bool writeOK = fwrite(&h, sizeof(TextureCacheHeader), 1, outfile) == 1
+        && fwrite(sourceFile, 1, pathLength, outfile) == pathLength
+        && fwrite(zeros, 1, padding, outfile) == padding
+        && fwrite(image.PixelData(), 1, baseSize, outfile) == baseSize
+        && fwrite(mips.Data(), 1, mips.DataSize(), outfile) == mips.DataSize();
+    if (fclose(outfile) != 0) {
+        writeOK = false;
+    }
+    if (writeOK) {
+        remove(cacheFilename.c_str());      // rename does not replace an existing file on Windows
+        writeOK = (rename(tempFilename.c_str(), cacheFilename.c_str()) == 0);
+    }
+    if (!writeOK) {
+        remove(tempFilename.c_str());
+    }
+    return writeOK;
+}
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+
+void TextureCacheFile::TexImage2D(unsigned int target, int internalFormat) const
+{
+    GLint oldAlignment, oldRowLength;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &oldRowLength);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexImage2D((GLenum)target, 0, internalFormat, (GLsizei)GetNumCols(), (GLsizei)GetNumRows(), 0,
+                 GL_BGR, GL_UNSIGNED_BYTE, GetBaseData());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, oldRowLength);
+    MipChain::TexImage2D(target, internalFormat, true, GetPackedMips(), GetNumRows(), GetNumCols());
+}
+
+#endif  // RGBIMAGE_DONT_USE_OPENGL
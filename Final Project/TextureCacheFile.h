@@ -0,0 +1,88 @@
+/*
+* TextureCacheFile.h
+*
+* An on-disk cache of textures, with their mipmaps already calculated.
+*   The cache file for "floor.bmp" is "floor.bmp.texcache".  It holds a header,
+*   the source path, and then level 0 (the pixels of the BMP file) followed by
+*   mipmap levels 1 and up, packed as in MipChain::Data().  Pixels are BGR,
+*   with rows padded to a multiple of four bytes.
+*
+*   The first load of a texture writes its cache file (see Write).  Later loads
+*   map the cache file (see MappedFile.h) and upload straight from it: nothing
+*   is decoded or filtered.
+*
+*   A cache file is used only if it matches its source: the same path, size and
+*   modification time.  If only the modification time differs (for instance,
+*   after a fresh checkout) the source file's contents are hashed and compared;
+*   if they match, the new modification time is written into the cache file's header.
+*   The mipmap filter and sRGB averaging must match too.  A cache file that does
+*   not match is ignored, and rewritten by the next Write.
+*
+*   The header fields are written in the byte order of the machine (little endian
+*   on every platform this project builds for).  Block compression is not used:
+*   the data is exactly what glTexImage2D is given.
+*/
+
+#pragma once
+#ifndef TEXTURE_CACHE_FILE_H
+#define TEXTURE_CACHE_FILE_H
+
+#include "MappedFile.h"
+#include "MipChain.h"
+#include <stdint.h>
+#include <string>
+
+class BmpFileView;
+
+struct TextureCacheHeader {
+    char magic[8];              // "TEXCACH1"
+    uint64_t sourceSize;
+    int64_t sourceModTime;
+    uint64_t sourceHash;        // FNV-1a hash of the source file's contents
+    uint64_t dataSize;          // Level 0 and the packed mipmaps
+    uint32_t dataOffset;        // The header and source path, rounded up to a multiple of 16
+    uint32_t numRows;           // Of level 0
+    uint32_t numCols;
+    uint32_t numLevels;         // Including level 0
+    uint32_t mipFilter;         // A MipFilter
+    uint32_t sRgbAveraging;     // 1 for sRGB averaging, 0 for linear
+    uint32_t pathLength;        // The source path follows the header (not null terminated)
+    uint32_t reserved;
+};
+
+class TextureCacheFile {
+public:
+    TextureCacheFile() : header(0) {}
+
+    // Maps the cache file of sourceFile, if it is up to date.  Returns false (with
+    //    no message) if there is no cache file or it does not match.
+    bool OpenForSource(const char* sourceFile, MipFilter mipFilter, bool sRgbAveraging);
+    void Close();
+    bool IsOpen() const { return header != 0; }
+
+    // Writes the cache file for sourceFile, from its image and mipmaps.  The file is
+    //    written under a temporary name and then renamed, so a partly written cache file
+    //    is never used.  Returns true for success.
+    static bool Write(const char* sourceFile, const BmpFileView& image, const MipChain& mips,
+                      MipFilter mipFilter, bool sRgbAveraging);
+    static std::string CacheFilename(const char* sourceFile) { return std::string(sourceFile) + ".texcache"; }
+
+    long GetNumRows() const { return (long)header->numRows; }
+    long GetNumCols() const { return (long)header->numCols; }
+    long GetNumBytesPerRow() const { return ((3 * GetNumCols() + 3) >> 2) << 2; }
+    const unsigned char* GetBaseData() const { return file.Data() + header->dataOffset; }    // Level 0, BGR
+    const unsigned char* GetPackedMips() const { return GetBaseData() + GetNumRows() * GetNumBytesPerRow(); }
+
+    void Prefault() const { file.Prefault(); }
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+    // glTexImage2D for all the levels, to the currently bound texture.
+    void TexImage2D(unsigned int target, int internalFormat) const;
+#endif
+
+private:
+    MappedFile file;
+    const TextureCacheHeader* header;
+};
+
+#endif  // TEXTURE_CACHE_FILE_H
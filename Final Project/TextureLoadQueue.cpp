@@ -0,0 +1,128 @@
+/*
+* TextureLoadQueue.cpp
+*
+* Concurrent loading of texture files.  See TextureLoadQueue.h.
+*/
+
+#include "TextureLoadQueue.h"
+#include "MathMisc.h"
+#include <exception>
+#include <stdio.h>
+
+int TextureLoadQueue::MaxLoadThreads = 8;
+bool TextureLoadQueue::UseTextureCache = true;
+
+namespace {
+    double MillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+// std::vector<BmpFileView>(count) default constructs the views in place, and never copies them.
+TextureLoadQueue::TextureLoadQueue(const char* const* filenames, int count,
+                                   bool generateMipmaps, MipFilter mipFilter)
+    : filenames(filenames), count(count), generateMipmaps(generateMipmaps), mipFilter(mipFilter),
+      images(count), mipChains(count), cacheFiles(count), decodeMilliseconds(count, 0.0),
+      startTime(std::chrono::steady_clock::now()), nextToLoad(0), numReturned(0)
+{
+    finished.reserve(count);
+    // Not limited to the number of cores: the workers spend most of their time waiting for the disk.
+    int numThreads = Max(1, Min(MaxLoadThreads, count));
+    for (int t = 0; t < numThreads; t++) {
+        workers.push_back(std::async(std::launch::async, &TextureLoadQueue::WorkerLoop, this));
+    }
+}
+
+TextureLoadQueue::~TextureLoadQueue()
+{
+    nextToLoad = count;         // Workers stop after their current file
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].wait();
+    }
+}
+
+// Each worker takes the next file not yet started, until there are none left.
+//    Each image is written by only one worker, and is only read by WaitForNext's
+//    caller after the index has been passed through the mutex.
+//    An exception (e.g., std::bad_alloc from the mipmaps) fails only that file: it is
+//    still passed to WaitForNext, unloaded, so that WaitForNext does not wait forever.
+void TextureLoadQueue::WorkerLoop()
+{
+    for (int i; (i = nextToLoad++) < count; ) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool useCache = generateMipmaps && UseTextureCache;
+        const BmpFileView& image = images[i];
+        try {
+            if (useCache && cacheFiles[i].OpenForSource(filenames[i], mipFilter, true)) {
+                cacheFiles[i].Prefault();
+            }
+            else if (images[i].Open(filenames[i])) {
+                if (generateMipmaps) {
+                    mipChains[i].Generate(image.PixelData(), image.GetNumRows(), image.GetNumCols(),
+                                          image.GetNumBytesPerRow(), mipFilter);
+                    if (useCache) {
+                        TextureCacheFile::Write(filenames[i], image, mipChains[i], mipFilter, true);
+                    }
+                }
+                else {
+                    image.Prefault();
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            fprintf(stderr, "Unable to load texture %s: %s.\n", filenames[i], e.what());
+            Release(i);
+        }
+        decodeMilliseconds[i] = MillisecondsSince(start);
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            finished.push_back(i);
+        }
+        finishedCondition.notify_one();
+    }
+}
+
+int TextureLoadQueue::WaitForNext()
+{
+    if (numReturned >= count) {
+        return -1;
+    }
+    std::unique_lock<std::mutex> lock(finishedMutex);
+    finishedCondition.wait(lock, [this] { return (int)finished.size() > numReturned; });
+    return finished[numReturned++];
+}
+
+long TextureLoadQueue::GetNumRows(int i) const
+{
+    return IsFromCache(i) ? cacheFiles[i].GetNumRows() : images[i].GetNumRows();
+}
+
+long TextureLoadQueue::GetNumCols(int i) const
+{
+    return IsFromCache(i) ? cacheFiles[i].GetNumCols() : images[i].GetNumCols();
+}
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+
+bool TextureLoadQueue::TexImage2D(int i, unsigned int target, int internalFormat) const
+{
+    if (IsFromCache(i)) {
+        cacheFiles[i].TexImage2D(target, internalFormat);
+        return true;
+    }
+    if (!images[i].TexImage2D(target, 0, internalFormat)) {
+        return false;
+    }
+    if (generateMipmaps) {
+        mipChains[i].TexImage2D(target, internalFormat, true);
+    }
+    return true;
+}
+
+#endif  // RGBIMAGE_DONT_USE_OPENGL
+
+double TextureLoadQueue::GetTotalMilliseconds() const
+{
+    return MillisecondsSince(startTime);
+}
@@ -0,0 +1,100 @@
+/*
+* TextureLoadQueue.h
+*
+* Loads a list of texture files concurrently on worker threads, and hands them
+*   to the OpenGL thread in the order they finish.
+*   A worker "decodes" a BMP file by memory mapping it and faulting in all its
+*   pages (see BmpFileView.h), so the OpenGL thread's glTexImage2D only copies
+*   from memory.  The worker also calculates the mipmap levels (see MipChain.h),
+*   unless the queue was created without mipmaps.  OpenGL itself is only used
+*   on the calling thread.
+*   With mipmaps, the textures are cached on disk (see TextureCacheFile.h): when
+*   a texture's cache file is up to date, it is mapped instead, and there is
+*   nothing to decode or filter.  Otherwise the worker writes the cache file.
+*
+* How to use:
+*     TextureLoadQueue queue(TextureFiles, NumTextures);
+*     for (int i; (i = queue.WaitForNext()) >= 0; ) {
+*         glBindTexture(GL_TEXTURE_2D, TextureNames[i]);
+*         queue.TexImage2D(i, GL_TEXTURE_2D, GL_RGB);     // With its mipmaps
+*         queue.Release(i);      // Unmaps the file
+*     }
+*/
+
+#pragma once
+#ifndef TEXTURE_LOAD_QUEUE_H
+#define TEXTURE_LOAD_QUEUE_H
+
+#include "BmpFileView.h"
+#include "MipChain.h"
+#include "TextureCacheFile.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <vector>
+
+class TextureLoadQueue {
+public:
+    // Starts loading filenames[0..count-1] at once.  The filenames must stay valid
+    //    until the queue is destroyed.
+    TextureLoadQueue(const char* const* filenames, int count,
+                     bool generateMipmaps = true, MipFilter mipFilter = MipFilterBox);
+    ~TextureLoadQueue();        // Waits for the workers to finish
+
+    // Blocks until a texture not yet returned is loaded, and returns its index.
+    //    Returns -1 once every texture has been returned.  Check IsLoaded(i) (or
+    //    GetImage(i)'s error code): a file that failed to load is still returned,
+    //    as is one whose worker threw an exception (e.g., out of memory).
+    int WaitForNext();
+
+    // The i-th texture comes either from its cache file, or from its BMP file and
+    //    calculated mipmaps.  Both are BGR.
+    bool IsLoaded(int i) const { return cacheFiles[i].IsOpen() || images[i].IsOpen(); }
+    bool IsFromCache(int i) const { return cacheFiles[i].IsOpen(); }
+    long GetNumRows(int i) const;
+    long GetNumCols(int i) const;
+    const BmpFileView& GetImage(int i) const { return images[i]; }
+    const MipChain& GetMipChain(int i) const { return mipChains[i]; }
+    const TextureCacheFile& GetCacheFile(int i) const { return cacheFiles[i]; }
+    void Release(int i) { images[i].Close(); mipChains[i].Reset(); cacheFiles[i].Close(); }
+
+#ifndef RGBIMAGE_DONT_USE_OPENGL
+    // glTexImage2D for the i-th texture and its mipmaps (if any), to the currently
+    //    bound texture.  Returns false if the file could not be loaded.
+    bool TexImage2D(int i, unsigned int target, int internalFormat) const;
+#endif
+
+    // Time taken on a worker to map and fault in the i-th file, and calculate its mipmaps.
+    double GetDecodeMilliseconds(int i) const { return decodeMilliseconds[i]; }
+    double GetTotalMilliseconds() const;    // Since the queue was started
+
+    static int MaxLoadThreads;      // Default 8. Set to 1 to load on a single worker thread.
+    static bool UseTextureCache;    // Default true. Set to false to neither read nor write cache files.
+
+private:
+    const char* const* filenames;
+    int count;
+    bool generateMipmaps;
+    MipFilter mipFilter;
+    std::vector<BmpFileView> images;
+    std::vector<MipChain> mipChains;
+    std::vector<TextureCacheFile> cacheFiles;
+    std::vector<double> decodeMilliseconds;
+    std::chrono::steady_clock::time_point startTime;
+
+    std::atomic<int> nextToLoad;    // Workers take files in order from here
+    std::vector<int> finished;      // Indices, in the order the loads finished
+    int numReturned;                // By WaitForNext
+    std::mutex finishedMutex;
+    std::condition_variable finishedCondition;
+    std::vector<std::future<void>> workers;
+
+    void WorkerLoop();
+
+    TextureLoadQueue(const TextureLoadQueue&) = delete;
+    TextureLoadQueue& operator=(const TextureLoadQueue&) = delete;
+};
+
+#endif  // TEXTURE_LOAD_QUEUE_H
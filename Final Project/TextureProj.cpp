@@ -32,6 +32,7 @@
 
 #include "LinearR3.h"		// Adjust path as needed.
 #include "LinearR4.h"		// Adjust path as needed.
+#include "LinearR4f.h"      // Adjust path as needed
 #include "EduPhong.h"
 #include "PhongData.h"
 #include "GlShaderMgr.h"
@@ -86,7 +87,9 @@ double currentDelta = 0.0;        // Current state of the animation (YOUR CODE M
 
 unsigned int shaderProgramBitmap;       // The shader program that applies a bitmapped texture map (from a file)
 unsigned int shaderProgramProc ;       // The shader program that applies a procedural texture map
+unsigned int shaderProgramBitmapInstanced;  // The bitmap texture shader program, with per-instance matrices
 unsigned int modelviewMatLocation;					// Location of the modelviewMatrix in the currently active shader program
+unsigned int normalMatLocation;						// Location of the normalMatrix in the currently active shader program
 unsigned int applyTextureLocation; 					// Location of the applyTexture bool in the currently active shader program
 unsigned int timeLoc;
 
@@ -204,6 +207,13 @@ void my_setup_SceneData() {
     phRegisterShaderProgram(shaderProgramProc);
     timeLoc = glGetUniformLocation(shaderProgramProc, "currentTime");
 
+    // The third shader program is the same as the first, but takes a per-instance matrix.
+    //    It is used for rendering many copies of a GlGeom shape with one draw call.
+    unsigned int vertexShader3 = GlShaderMgr::CompileShader("vertexShader_PhongPhongInstanced");
+    unsigned int shaderList3[2] = { vertexShader3 , fragmentShader1 };
+    shaderProgramBitmapInstanced = GlShaderMgr::LinkShaderProgram(2, shaderList3);
+    phRegisterShaderProgram(shaderProgramBitmapInstanced);
+
     mySetupGeometries();
     check_for_opengl_errors();
     SetupForTextures();   // The shader programs should be compiled and linked before setting up textures.
@@ -218,12 +228,37 @@ void my_setup_SceneData() {
 }
 
 void selectShaderProgram(unsigned int shaderProgram) {
-    assert(shaderProgram == shaderProgramBitmap || shaderProgram == shaderProgramProc);
+    assert(shaderProgram == shaderProgramBitmap || shaderProgram == shaderProgramProc
+        || shaderProgram == shaderProgramBitmapInstanced);
     glUseProgram(shaderProgram);
     modelviewMatLocation = phGetModelviewMatLoc(shaderProgram);
+    normalMatLocation = phGetNormalMatLoc(shaderProgram);
     applyTextureLocation = phGetApplyTextureLoc(shaderProgram);
 }
 
+// Load the modelview matrix (16 floats in column order) into the current shader program,
+//    together with its normal matrix.  The normal matrix is calculated here, once per
+//    object, instead of once per vertex in the vertex shader.
+void loadModelviewMatrix(const float* matEntries) {
+    float normalMatEntries[9];
+    LinearMapR4f::NormalMatrices(matEntries, normalMatEntries, 1);
+    loadModelviewMatrix(matEntries, normalMatEntries);
+}
+
+// The same, for a modelview matrix that is rigid times a uniform scaling: its normal matrix
+//    needs no inverse.
+void loadModelviewMatrixUniformScale(const float* matEntries) {
+    float normalMatEntries[9];
+    LinearMapR4f::NormalMatrices(matEntries, normalMatEntries, 1, 16, 9, LinearMapR4f::UniformScaleTransform);
+    loadModelviewMatrix(matEntries, normalMatEntries);
+}
+
+// The same, with an already calculated normal matrix (9 floats in column order).
+void loadModelviewMatrix(const float* matEntries, const float* normalMatEntries) {
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    glUniformMatrix3fv(normalMatLocation, 1, false, normalMatEntries);
+}
+
 // *******************************************************
 // Process all key press events.
 // This routine is called each time a key is pressed or released.
@@ -384,6 +419,7 @@ void setProjectionMatrix() {
                                       -windowYmax * scale, windowYmax * scale, zNear, zFar);
     float matEntries[16];
     theProjectionMatrix.DumpByColumns(matEntries);
+    GlGeomBase::SetLodProjection(matEntries, screenHeight);   // For choosing levels of detail
     if (glIsProgram(shaderProgramBitmap)) {
         check_for_opengl_errors();
         glUseProgram(shaderProgramBitmap);
@@ -393,6 +429,10 @@ void setProjectionMatrix() {
         glUseProgram(shaderProgramProc);
         glUniformMatrix4fv(phGetProjMatLoc(shaderProgramProc), 1, false, matEntries);
     }
+    if (glIsProgram(shaderProgramBitmapInstanced)) {
+        glUseProgram(shaderProgramBitmapInstanced);
+        glUniformMatrix4fv(phGetProjMatLoc(shaderProgramBitmapInstanced), 1, false, matEntries);
+    }
 
     check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
 }
@@ -43,12 +43,15 @@ extern LinearMapR4 viewMatrix;		// The current view matrix, based on viewAzimuth
 // Global variables that let program access the shader programs:
 extern unsigned int shaderProgramBitmap;     // The shader program that applies a bitmapped texture map (from a file)
 extern unsigned int shaderProgramProc;       // The shader program that applies a procedural texture map
+extern unsigned int shaderProgramBitmapInstanced;  // Same as shaderProgramBitmap, but with per-instance matrices
 extern unsigned int modelviewMatLocation;
+extern unsigned int normalMatLocation;
 extern unsigned int applyTextureLocation;
 
 constexpr unsigned int vertPos_loc = 0;         // "location = 0" in the vertex shader definition
 constexpr unsigned int vertNormal_loc = 1;      // "location = 1" in the vertex shader definition
 constexpr unsigned int vertTexCoords_loc = 2;   // "location = 2" in the vertex shader definition
+constexpr unsigned int instanceMat_loc = 9;     // "location = 9" (through 15, with the normal matrix) in the instanced vertex shader
 
 extern int clicked;
 extern double bakingTime;
@@ -68,6 +71,9 @@ void my_setup_OpenGL();
 void setProjectionMatrix();
 
 void selectShaderProgram(unsigned int shaderProgram);
+void loadModelviewMatrix(const float* matEntries);
+void loadModelviewMatrixUniformScale(const float* matEntries);
+void loadModelviewMatrix(const float* matEntries, const float* normalMatEntries);
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void window_size_callback(GLFWwindow* window, int width, int height);
@@ -61,35 +61,39 @@ double VectorR4::MaxAbs() const
 
 void Matrix4x4::operator*= (const Matrix4x4& B)	// Matrix product
 {
+	// B is copied to locals first: B may be *this, as in A *= A.  This also lets
+	//   the compiler keep the entries in registers across the stores into *this.
+	double b11 = B.m11, b21 = B.m21, b31 = B.m31, b41 = B.m41, b12 = B.m12, b22 = B.m22, b32 = B.m32, b42 = B.m42;
+	double b13 = B.m13, b23 = B.m23, b33 = B.m33, b43 = B.m43, b14 = B.m14, b24 = B.m24, b34 = B.m34, b44 = B.m44;
 	double t1, t2, t3;		// temporary values
-	t1 =  m11*B.m11 + m12*B.m21 + m13*B.m31 + m14*B.m41;
-	t2 =  m11*B.m12 + m12*B.m22 + m13*B.m32 + m14*B.m42;
-	t3 =  m11*B.m13 + m12*B.m23 + m13*B.m33 + m14*B.m43;
-	m14 = m11*B.m14 + m12*B.m24 + m13*B.m34 + m14*B.m44;
+	t1 =  m11*b11 + m12*b21 + m13*b31 + m14*b41;
+	t2 =  m11*b12 + m12*b22 + m13*b32 + m14*b42;
+	t3 =  m11*b13 + m12*b23 + m13*b33 + m14*b43;
+	m14 = m11*b14 + m12*b24 + m13*b34 + m14*b44;
 	m11 = t1;
 	m12 = t2;
 	m13 = t3;
 
-	t1 =  m21*B.m11 + m22*B.m21 + m23*B.m31 + m24*B.m41;
-	t2 =  m21*B.m12 + m22*B.m22 + m23*B.m32 + m24*B.m42;
-	t3 =  m21*B.m13 + m22*B.m23 + m23*B.m33 + m24*B.m43;
-	m24 = m21*B.m14 + m22*B.m24 + m23*B.m34 + m24*B.m44;
+	t1 =  m21*b11 + m22*b21 + m23*b31 + m24*b41;
+	t2 =  m21*b12 + m22*b22 + m23*b32 + m24*b42;
+	t3 =  m21*b13 + m22*b23 + m23*b33 + m24*b43;
+	m24 = m21*b14 + m22*b24 + m23*b34 + m24*b44;
 	m21 = t1;
 	m22 = t2;
 	m23 = t3;
 
-	t1 =  m31*B.m11 + m32*B.m21 + m33*B.m31 + m34*B.m41;
-	t2 =  m31*B.m12 + m32*B.m22 + m33*B.m32 + m34*B.m42;
-	t3 =  m31*B.m13 + m32*B.m23 + m33*B.m33 + m34*B.m43;
-	m34 = m31*B.m14 + m32*B.m24 + m33*B.m34 + m34*B.m44;
+	t1 =  m31*b11 + m32*b21 + m33*b31 + m34*b41;
+	t2 =  m31*b12 + m32*b22 + m33*b32 + m34*b42;
+	t3 =  m31*b13 + m32*b23 + m33*b33 + m34*b43;
+	m34 = m31*b14 + m32*b24 + m33*b34 + m34*b44;
 	m31 = t1;
 	m32 = t2;
 	m33 = t3;
 
-	t1 =  m41*B.m11 + m42*B.m21 + m43*B.m31 + m44*B.m41;
-	t2 =  m41*B.m12 + m42*B.m22 + m43*B.m32 + m44*B.m42;
-	t3 =  m41*B.m13 + m42*B.m23 + m43*B.m33 + m44*B.m43;
-	m44 = m41*B.m14 + m42*B.m24 + m43*B.m34 + m44*B.m44;
+	t1 =  m41*b11 + m42*b21 + m43*b31 + m44*b41;
+	t2 =  m41*b12 + m42*b22 + m43*b32 + m44*b42;
+	t3 =  m41*b13 + m42*b23 + m43*b33 + m44*b43;
+	m44 = m41*b14 + m42*b24 + m43*b34 + m44*b44;
 	m41 = t1;
 	m42 = t2;
 	m43 = t3;
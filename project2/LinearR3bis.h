@@ -0,0 +1,314 @@
+/*
+ *
+ * LinearR3bis.h
+ *
+ * Affine maps on R3, as 3x4 matrices.
+ *
+ *   Almost all modelview matrices are affine: their fourth row is (0,0,0,1).
+ *   AffineMapR3 stores only the upper 3x4 part of such a 4x4 matrix, so that
+ *   composing two affine maps takes 36 multiplications instead of the 64 of
+ *   a LinearMapR4 product, and glTranslate, glScale and glRotate operations
+ *   only touch the entries they change.
+ *   A projection is not affine: multiplying a LinearMapR4 by an AffineMapR3
+ *   gives a LinearMapR4.
+ *
+ */
+
+//
+//    AffineMapR3 - affine map, 3x4 matrix: a 3x3 linear part and a translation.
+//
+//    It has the same Set_gl* and Mult_gl* routines as LinearMapR4.
+//    DumpByColumns() gives the full 4x4 matrix for glUniformMatrix4fv.
+//
+
+#ifndef LINEAR_R3BIS_H
+#define LINEAR_R3BIS_H
+
+#include "LinearR3.h"
+#include "LinearR4.h"
+
+class AffineMapR3;
+
+// *****************************************
+// AffineMapR3 class                       *
+// * * * * * * * * * * * * * * * * * * * * *
+
+class AffineMapR3 {
+
+public:
+    // m_i_j - row-i and column-j entry, stored by columns.
+    //   The fourth column (m14, m24, m34) is the translation.
+    double m11, m21, m31, m12, m22, m32, m13, m23, m33, m14, m24, m34;
+
+public:
+    constexpr AffineMapR3()       // The identity map
+        : m11(1.0), m21(0.0), m31(0.0), m12(0.0), m22(1.0), m32(0.0),
+          m13(0.0), m23(0.0), m33(1.0), m14(0.0), m24(0.0), m34(0.0) {}
+    constexpr AffineMapR3( double, double, double, double, double, double,
+                 double, double, double, double, double, double );  // Sets by columns
+    explicit AffineMapR3( const Matrix4x4& A ) { Set(A); }      // A must be affine
+
+    AffineMapR3& SetIdentity();
+    AffineMapR3& Set( double, double, double, double, double, double,
+                      double, double, double, double, double, double );  // Sets by columns
+    AffineMapR3& Set( const Matrix4x4& A );     // A must be affine
+    AffineMapR3& Set3x3( const Matrix3x3& A );  // Set the linear part, with zero translation
+
+    LinearMapR4 ToLinearMapR4() const;          // Gives the 4x4 matrix, with last row (0,0,0,1)
+    float* DumpByColumns( float* ret ) const;   // Stores the 4x4 matrix (16 floats) in column order
+
+    // The normal matrix, the inverse transpose of the 3x3 part, as 9 floats in column order
+    //   (for glUniformMatrix3fv).  Surface normals are transformed by the normal matrix.
+    //   For a rigid map the normal matrix is the 3x3 part itself; for a rigid map times
+    //   a uniform scaling by s, it is the 3x3 part divided by s^2.  These two are faster.
+    float* DumpNormalMatrix( float* ret ) const;
+    float* DumpNormalMatrixRigid( float* ret ) const;
+    float* DumpNormalMatrixUniformScale( float* ret ) const;
+
+    AffineMapR3& operator*= ( const AffineMapR3& B );   // Composition, this = this * B
+
+    AffineMapR3 Inverse() const;            // Returns inverse
+    AffineMapR3& Invert();                  // Converts into inverse.
+    // For a rigid map (a rotation followed by a translation), the inverse
+    //   of the 3x3 part is its transpose.  The map must be rigid.
+    AffineMapR3 InverseRigid() const;
+    AffineMapR3& InvertRigid();
+
+    void AffineTransformPosition( VectorR3& dest ) const;
+    void AffineTransformDirection( VectorR3& dest ) const;
+    // Transform an array of count positions or direction vectors, in place.
+    void AffineTransformPositions( VectorR3* dest, int count ) const;
+    void AffineTransformDirections( VectorR3* dest, int count ) const;
+
+    // Reproduce OpenGL Modelview Matrix operations, as for LinearMapR4.
+    //  EXCEPT: these routines use radians, not degrees.  (!)
+    AffineMapR3& Set_glScale( double xyzScale );
+    AffineMapR3& Mult_glScale( double xyzScale );
+    AffineMapR3& Set_glScale( double xScale, double yScale, double zScale );
+    AffineMapR3& Mult_glScale( double xScale, double yScale, double zScale );
+    AffineMapR3& Set_glTranslate( double xTranslation, double yTranslation, double zTranslation );
+    AffineMapR3& Mult_glTranslate( double xTranslation, double yTranslation, double zTranslation );
+    AffineMapR3& Set_glTranslate( const VectorR3& translation );
+    AffineMapR3& Mult_glTranslate( const VectorR3& translation );
+    AffineMapR3& Set_glRotate( double radians, double x, double y, double z );
+    AffineMapR3& Mult_glRotate( double radians, double x, double y, double z );
+    AffineMapR3& Set_glRotate( double radians, const VectorR3& axis );
+    AffineMapR3& Mult_glRotate( double radians, const VectorR3& axis );
+    AffineMapR3& Set_glRotate( double costheta, double sintheta, double x, double y, double z );
+    AffineMapR3& Mult_glRotate( double costheta, double sintheta, double x, double y, double z );
+    AffineMapR3& Set_glRotate( const Quaternion& q );      // q must be a unit quaternion
+    AffineMapR3& Mult_glRotate( const Quaternion& q );
+    AffineMapR3& Set_gluLookAt( const VectorR3& eyePos, const VectorR3& lookAtPos, const VectorR3& upDir );
+
+private:
+    void MultLinearPart( double, double, double, double, double, double,
+                         double, double, double );  // this = this * (3x3 matrix, given by columns)
+};
+
+// Composition of affine maps
+inline AffineMapR3 operator* ( const AffineMapR3& A, const AffineMapR3& B );
+// Applying a projection (or any 4x4 matrix) gives a 4x4 matrix.
+LinearMapR4 operator* ( const LinearMapR4& A, const AffineMapR3& B );
+
+// *********************************************************
+// * AffineMapR3 class - inlined functions                 *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * *****
+
+inline constexpr AffineMapR3::AffineMapR3( double a11, double a21, double a31, double a12, double a22, double a32,
+                                 double a13, double a23, double a33, double a14, double a24, double a34 )
+    : m11(a11), m21(a21), m31(a31), m12(a12), m22(a22), m32(a32),
+      m13(a13), m23(a23), m33(a33), m14(a14), m24(a24), m34(a34)
+{ }
+
+inline AffineMapR3& AffineMapR3::Set( double a11, double a21, double a31, double a12, double a22, double a32,
+                                      double a13, double a23, double a33, double a14, double a24, double a34 )
+{
+    m11 = a11;      // Column 1
+    m21 = a21;
+    m31 = a31;
+    m12 = a12;      // Column 2
+    m22 = a22;
+    m32 = a32;
+    m13 = a13;      // Column 3
+    m23 = a23;
+    m33 = a33;
+    m14 = a14;      // Column 4: translation
+    m24 = a24;
+    m34 = a34;
+    return *this;
+}
+
+inline AffineMapR3& AffineMapR3::SetIdentity()
+{
+    return Set( 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0 );
+}
+
+inline AffineMapR3& AffineMapR3::Set3x3( const Matrix3x3& A )
+{
+    return Set( A.m11, A.m21, A.m31, A.m12, A.m22, A.m32, A.m13, A.m23, A.m33, 0.0, 0.0, 0.0 );
+}
+
+inline LinearMapR4 AffineMapR3::ToLinearMapR4() const
+{
+    return LinearMapR4( m11, m21, m31, 0.0, m12, m22, m32, 0.0,
+                        m13, m23, m33, 0.0, m14, m24, m34, 1.0 );
+}
+
+inline AffineMapR3& AffineMapR3::operator*= ( const AffineMapR3& B )
+{
+    // Translation first, since it uses the old linear part of *this.
+    double t1 = m11*B.m14 + m12*B.m24 + m13*B.m34 + m14;
+    double t2 = m21*B.m14 + m22*B.m24 + m23*B.m34 + m24;
+    double t3 = m31*B.m14 + m32*B.m24 + m33*B.m34 + m34;
+    MultLinearPart( B.m11, B.m21, B.m31, B.m12, B.m22, B.m32, B.m13, B.m23, B.m33 );
+    m14 = t1;
+    m24 = t2;
+    m34 = t3;
+    return *this;
+}
+
+inline AffineMapR3 operator* ( const AffineMapR3& A, const AffineMapR3& B )
+{
+    AffineMapR3 AA(A);
+    AA *= B;
+    return AA;
+}
+
+inline AffineMapR3& AffineMapR3::Invert()
+{
+    *this = Inverse();
+    return *this;
+}
+
+inline AffineMapR3& AffineMapR3::InvertRigid()
+{
+    *this = InverseRigid();
+    return *this;
+}
+
+// Multiply a VectorR3 postion by the affine transformation.
+inline void AffineMapR3::AffineTransformPosition( VectorR3& dest ) const
+{
+    double x = dest.x, y = dest.y, z = dest.z;
+    dest.x = m11*x + m12*y + m13*z + m14;
+    dest.y = m21*x + m22*y + m23*z + m24;
+    dest.z = m31*x + m32*y + m33*z + m34;
+}
+
+// Multiply a VectorR3 direction vector by the affine transformation: the translation is not applied.
+inline void AffineMapR3::AffineTransformDirection( VectorR3& dest ) const
+{
+    double x = dest.x, y = dest.y, z = dest.z;
+    dest.x = m11*x + m12*y + m13*z;
+    dest.y = m21*x + m22*y + m23*z;
+    dest.z = m31*x + m32*y + m33*z;
+}
+
+// Various scale, translation and rotation matrices,
+//   to reproduce OpenGL ModelView matrix functionality
+//   The "Mult" routines multiply on the right. (Like legacy OpenGL.)
+//   The "Set" routines replace the matrix contents.
+//   All routines return the *this matrix.
+
+inline AffineMapR3& AffineMapR3::Set_glScale( double xyzScale )
+{
+    return Set_glScale(xyzScale, xyzScale, xyzScale);
+}
+
+inline AffineMapR3& AffineMapR3::Mult_glScale( double xyzScale )
+{
+    return Mult_glScale(xyzScale, xyzScale, xyzScale);
+}
+
+inline AffineMapR3& AffineMapR3::Set_glScale( double xScale, double yScale, double zScale )
+{
+    return Set( xScale, 0.0, 0.0, 0.0, yScale, 0.0, 0.0, 0.0, zScale, 0.0, 0.0, 0.0 );
+}
+
+// Only the first three columns are scaled: 9 multiplications
+inline AffineMapR3& AffineMapR3::Mult_glScale( double xScale, double yScale, double zScale )
+{
+    m11 *= xScale;
+    m21 *= xScale;
+    m31 *= xScale;
+    m12 *= yScale;
+    m22 *= yScale;
+    m32 *= yScale;
+    m13 *= zScale;
+    m23 *= zScale;
+    m33 *= zScale;
+    return *this;
+}
+
+inline AffineMapR3& AffineMapR3::Set_glTranslate( double xTranslation, double yTranslation, double zTranslation )
+{
+    return Set( 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, xTranslation, yTranslation, zTranslation );
+}
+
+// Only the translation changes: 9 multiplications
+inline AffineMapR3& AffineMapR3::Mult_glTranslate( double xTranslation, double yTranslation, double zTranslation )
+{
+    m14 += m11*xTranslation + m12*yTranslation + m13*zTranslation;
+    m24 += m21*xTranslation + m22*yTranslation + m23*zTranslation;
+    m34 += m31*xTranslation + m32*yTranslation + m33*zTranslation;
+    return *this;
+}
+
+inline AffineMapR3& AffineMapR3::Set_glTranslate( const VectorR3& translation )
+{
+    return Set_glTranslate(translation.x, translation.y, translation.z);
+}
+
+inline AffineMapR3& AffineMapR3::Mult_glTranslate( const VectorR3& translation )
+{
+    return Mult_glTranslate(translation.x, translation.y, translation.z);
+}
+
+inline AffineMapR3& AffineMapR3::Set_glRotate( double radians, double x, double y, double z )
+{
+    return Set_glRotate(cos(radians), sin(radians), x, y, z);
+}
+
+inline AffineMapR3& AffineMapR3::Mult_glRotate( double radians, double x, double y, double z )
+{
+    return Mult_glRotate(cos(radians), sin(radians), x, y, z);
+}
+
+inline AffineMapR3& AffineMapR3::Set_glRotate( double radians, const VectorR3& axis )
+{
+    return Set_glRotate(cos(radians), sin(radians), axis.x, axis.y, axis.z);
+}
+
+inline AffineMapR3& AffineMapR3::Mult_glRotate( double radians, const VectorR3& axis )
+{
+    return Mult_glRotate(cos(radians), sin(radians), axis.x, axis.y, axis.z);
+}
+
+// Only the linear part changes: 27 multiplications
+inline AffineMapR3& AffineMapR3::Mult_glRotate( double costheta, double sintheta, double x, double y, double z )
+{
+    AffineMapR3 rotMatrix;
+    rotMatrix.Set_glRotate(costheta, sintheta, x, y, z);
+    MultLinearPart( rotMatrix.m11, rotMatrix.m21, rotMatrix.m31, rotMatrix.m12, rotMatrix.m22, rotMatrix.m32,
+                    rotMatrix.m13, rotMatrix.m23, rotMatrix.m33 );
+    return *this;
+}
+
+inline void AffineMapR3::MultLinearPart( double b11, double b21, double b31, double b12, double b22, double b32,
+                                         double b13, double b23, double b33 )
+{
+    double a1 = m11, a2 = m12, a3 = m13;        // Row 1
+    m11 = a1*b11 + a2*b21 + a3*b31;
+    m12 = a1*b12 + a2*b22 + a3*b32;
+    m13 = a1*b13 + a2*b23 + a3*b33;
+    a1 = m21; a2 = m22; a3 = m23;               // Row 2
+    m21 = a1*b11 + a2*b21 + a3*b31;
+    m22 = a1*b12 + a2*b22 + a3*b32;
+    m23 = a1*b13 + a2*b23 + a3*b33;
+    a1 = m31; a2 = m32; a3 = m33;               // Row 3
+    m31 = a1*b11 + a2*b21 + a3*b31;
+    m32 = a1*b12 + a2*b22 + a3*b32;
+    m33 = a1*b13 + a2*b23 + a3*b33;
+}
+
+#endif  // LINEAR_R3BIS_H
@@ -0,0 +1,72 @@
+/*
+* SceneGraph.cpp
+*
+* A hierarchy of transformations, with cached world transforms.  See SceneGraph.h.
+*/
+
+#include "SceneGraph.h"
+#include <string.h>
+#include "assert.h"
+
+int SceneGraph::AddNode(int parent)
+{
+    return AddNode(parent, AffineMapR3());
+}
+
+int SceneGraph::AddNode(int parent, const AffineMapR3& local)
+{
+    assert(parent >= -1 && parent < GetNumNodes());
+    int node = GetNumNodes();
+    parents.push_back(parent);
+    locals.push_back(local);
+    worlds.push_back(AffineMapR3());
+    worldFloats.resize(worldFloats.size() + 16);
+    normalFloats.resize(normalFloats.size() + 9);
+    dirty.push_back(0);
+    MarkDirty(node);
+    return node;
+}
+
+void SceneGraph::SetLocal(int node, const AffineMapR3& local)
+{
+    if (memcmp(&locals[node], &local, sizeof(AffineMapR3)) == 0) {
+        return;         // Unchanged: for instance, the view matrix when the camera has not moved.
+    }
+    locals[node] = local;
+    MarkDirty(node);
+}
+
+void SceneGraph::MarkDirty(int node)
+{
+    dirty[node] = 1;
+    if (node < firstDirty) {
+        firstDirty = node;
+    }
+}
+
+// Parents come before their children, so a single pass in node order suffices:
+//    a node is recalculated if it is dirty or its parent was recalculated.
+//    The nodes before firstDirty are not looked at.
+void SceneGraph::Update()
+{
+    int numNodes = GetNumNodes();
+    for (int i = firstDirty; i < numNodes; i++) {
+        int parent = parents[i];
+        if (!dirty[i] && (parent < firstDirty || !dirty[parent])) {
+            continue;
+        }
+        dirty[i] = 1;       // So its children are recalculated too
+        if (parent < 0) {
+            worlds[i] = locals[i];
+        }
+        else {
+            worlds[i] = worlds[parent] * locals[i];
+        }
+        worlds[i].DumpByColumns(worldFloats.data() + 16 * (size_t)i);
+        worlds[i].DumpNormalMatrix(normalFloats.data() + 9 * (size_t)i);
+    }
+    for (int i = firstDirty; i < numNodes; i++) {
+        dirty[i] = 0;
+    }
+    firstDirty = numNodes;
+}
@@ -0,0 +1,75 @@
+/*
+* SceneGraph.h
+*
+* A hierarchy of transformations, with cached world transforms.
+*
+*   Each node has a parent (or none) and a local transform; its world transform is
+*      world(parent) * local.
+*   The world transforms are kept in one flat array, in node order, together with
+*   a copy as floats (16 per node, column order) ready for glUniformMatrix4fv,
+*   and their normal matrices (9 floats per node) ready for glUniformMatrix3fv.
+*   Update() recalculates only the nodes whose local transform changed, and their
+*   descendants: when nothing has changed it does no work at all.
+*
+*   The transforms are AffineMapR3's: modelview transforms are affine, and
+*   LinearMapR4 products would do a third more work.  A LinearMapR4 local
+*   transform can be given if it is affine.
+*
+* How to use:
+*     SceneGraph scene;
+*     int viewNode = scene.AddNode();                  // A root
+*     int doorNode = scene.AddNode(viewNode);
+*     int frameNode = scene.AddNode(doorNode, frameLocal);
+*     ...
+*     // Each frame:
+*     scene.SetLocal(viewNode, viewMatrix);    // No change if viewMatrix has not changed
+*     scene.SetLocal(doorNode, doorRotation);
+*     scene.Update();
+*     glUniformMatrix4fv(modelviewMatLocation, 1, false, scene.GetWorldFloats(frameNode));
+*/
+
+#pragma once
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include "LinearR3bis.h"
+#include <vector>
+
+class SceneGraph {
+public:
+    SceneGraph() : firstDirty(0) {}
+
+    // Adds a node, and returns its index. The parent must already exist (or be -1 for a root).
+    //    So a parent always comes before its children in the node order.
+    int AddNode(int parent = -1);
+    int AddNode(int parent, const AffineMapR3& local);
+    int GetNumNodes() const { return (int)parents.size(); }
+    int GetParent(int node) const { return parents[node]; }
+
+    // Setting a local transform marks the node dirty, unless the transform is unchanged.
+    void SetLocal(int node, const AffineMapR3& local);
+    void SetLocal(int node, const LinearMapR4& local) { SetLocal(node, AffineMapR3(local)); }
+    const AffineMapR3& GetLocal(int node) const { return locals[node]; }
+
+    // Recalculates the world transforms of the dirty nodes and their descendants.
+    void Update();
+    bool IsUpdated() const { return firstDirty >= GetNumNodes(); }
+
+    // The world transforms are valid after Update().
+    const AffineMapR3& GetWorld(int node) const { return worlds[node]; }
+    const float* GetWorldFloats(int node) const { return worldFloats.data() + 16 * (size_t)node; }
+    const float* GetNormalFloats(int node) const { return normalFloats.data() + 9 * (size_t)node; }
+
+private:
+    std::vector<int> parents;
+    std::vector<AffineMapR3> locals;
+    std::vector<AffineMapR3> worlds;
+    std::vector<float> worldFloats;         // 16 floats per node, column order
+    std::vector<float> normalFloats;        // 9 floats per node: the normal matrix of the world transform
+    std::vector<unsigned char> dirty;       // The node's world transform must be recalculated
+    int firstDirty;                         // No node before this one is dirty
+
+    void MarkDirty(int node);
+};
+
+#endif  // SCENE_GRAPH_H
@@ -45,6 +45,8 @@
 #include "MathMisc.h"
 #include "LinearR3.h"
 #include "LinearR4.h"		
+#include "Quaternion.h"
+#include "SceneGraph.h"
 #include "GlGeomSphere.h"
 #include "ShaderMgrSLR.h"
 bool check_for_opengl_errors();     // Function prototype (should really go in a header file)
@@ -105,6 +107,12 @@ LinearMapR4 theProjectionMatrix;		//  The Projection matrix: Controls the "camer
 // The array matEntries holds the matrix values as floats to be loaded into the shader program. 
 float matEntries[16];		// Holds 16 floats (since cannot load doubles into a shader that uses floats)
 
+// The objects' ModelView matrices are kept in a scene graph, following the hierarchy
+//     view -> earth's position -> earth, moon and SD, and moon -> submoon.
+// Each node's matrix is recalculated only when its local transform, or its parent's, changes.
+SceneGraph solarScene;
+int viewNode, sun1Node, sun2Node, earthPosNode, earthNode, moonNode, sdNode, planetXNode, subMoonNode;
+
 // *****************************
 // These variables set the dimensions of the perspective region we wish to view.
 // They are used to help form the projection matrix and the view matrix
@@ -143,6 +151,17 @@ void mySetupGeometries() {
 	viewMatrix.Set_glTranslate(0.0, 0.0, -CameraDistance);        // Translate to be in front of the camera
     viewMatrix.Mult_glRotate(viewAzimuth, 1.0, 0.0, 0.0);         // Rotate to view from slightly above   
 
+    // The scene graph nodes.  Their local transforms are set as the animation runs.
+    viewNode = solarScene.AddNode(-1, AffineMapR3(viewMatrix));
+    sun1Node = solarScene.AddNode(viewNode);
+    sun2Node = solarScene.AddNode(viewNode);
+    earthPosNode = solarScene.AddNode(viewNode);
+    earthNode = solarScene.AddNode(earthPosNode);
+    moonNode = solarScene.AddNode(earthPosNode);
+    sdNode = solarScene.AddNode(earthPosNode);
+    subMoonNode = solarScene.AddNode(moonNode);
+    planetXNode = solarScene.AddNode(viewNode);
+
 	check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
 }
 // *************************************
@@ -187,87 +206,85 @@ void myRenderScene() {
 
     
 
-	LinearMapR4 Sun1PosMatrix = viewMatrix;				// Place Sun at center of the scene
-	// SunPosMatrix.Mult_glScale(1.0);						// Scaling by (1, 1, 1) has no effect
-    double SunRotateAngle = 2*(DayOfYear/365)*PI2;      
-    
-    Sun1PosMatrix.Mult_glRotate(SunRotateAngle, 0.0, 1.0, 0.0);
-    Sun1PosMatrix.Mult_glTranslate(0.0, 0.0, 1.2);
-
-    Sun1PosMatrix.DumpByColumns(matEntries);           // These two lines load the matrix into the shader
-	glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-	glVertexAttrib3f(vertColor_loc, 1.0f, 1.0f, 0.0f);     // Make the sun yellow
-	Sun.Render();
-
-    LinearMapR4 Sun2PosMatrix = viewMatrix;
-  
-    Sun2PosMatrix.Mult_glRotate(SunRotateAngle, 0.0, 1.0, 0.0);
-    Sun2PosMatrix.Mult_glTranslate(0.0, 0.0, -1.2);
-
-    Sun2PosMatrix.DumpByColumns(matEntries);           // These two lines load the matrix into the shader
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glVertexAttrib3f(vertColor_loc, 1.0f, 1.0f, 0.0f);     // Make the sun yellow
-
-    Sun.Render();
-    
-    // EarthPosMatrix - specifies position of the earth
-    // EarthMatrix - specifies the size of the earth and its rotation on its axis
-	LinearMapR4 EarthPosMatrix = viewMatrix;
+    // Set the local transforms of the nodes.  A node whose transform has not changed
+    //    (e.g., when the animation is paused) is not recalculated.
+    AffineMapR3 local;
+    double SunRotateAngle = 2*(DayOfYear/365)*PI2;
+    local.Set_glRotate(SunRotateAngle, 0.0, 1.0, 0.0);
+    local.Mult_glTranslate(0.0, 0.0, 1.2);
+    solarScene.SetLocal(sun1Node, local);
+    local.Set_glRotate(SunRotateAngle, 0.0, 1.0, 0.0);
+    local.Mult_glTranslate(0.0, 0.0, -1.2);
+    solarScene.SetLocal(sun2Node, local);
+
+    // earthPosNode - specifies position of the earth
+    // earthNode - specifies the size of the earth and its rotation on its axis
     double revolveAngle = (DayOfYear / 365.0)*PI2;
     double tilt = -(24.0 / 360.0) * PI2;
-    EarthPosMatrix.Mult_glRotate(tilt, 0.0, 0.0, 1.0);
-    EarthPosMatrix.Mult_glRotate(revolveAngle, 0.0, 1.0, 0.0);   // Revolve the earth around the sun
-	EarthPosMatrix.Mult_glTranslate(0.0, -6* sin(revolveAngle) * sin(tilt), 6.0);		// Place the earth five units away from the sun
-    
+    // The tilt of the orbit and the revolution around the sun are composed as quaternions,
+    //    so only one rotation matrix is formed and multiplied in.
+    Quaternion orbitRotation, revolveRotation;
+    orbitRotation.SetRotate(tilt, 0.0, 0.0, 1.0);
+    orbitRotation *= revolveRotation.SetRotate(revolveAngle, 0.0, 1.0, 0.0);   // Revolve the earth around the sun
+    local.Set_glRotate(orbitRotation);
+    local.Mult_glTranslate(0.0, -6* sin(revolveAngle) * sin(tilt), 6.0);		// Place the earth six units away from the sun
+    solarScene.SetLocal(earthPosNode, local);
 
-	LinearMapR4 EarthMatrix = EarthPosMatrix;
     double earthRotationAngle = (HourOfDay / 24.0)*PI2;
-    EarthMatrix.Mult_glRotate(earthRotationAngle, 0.0, 1.0, 0.0);   // Rotate earth on y-axis
-    
-	EarthMatrix.Mult_glScale(0.7);                                  // Make radius 0.5.
-	EarthMatrix.DumpByColumns(matEntries);
-	glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-	glVertexAttrib3f(vertColor_loc, 0.2f, 0.4f, 1.0f);     // Make the earth bright cyan-blue
-	Earth.Render();
-
-    // MoonMatrix - control placement, and size of the moon.
- 	LinearMapR4 MoonMatrix = EarthPosMatrix;        // Base the moon's matrix off the earth's *POS* matrix (EarthPosMatrix)
+    local.Set_glRotate(earthRotationAngle, 0.0, 1.0, 0.0);   // Rotate earth on y-axis
+    local.Mult_glScale(0.7);                                // Make radius 0.7
+    solarScene.SetLocal(earthNode, local);
+
+    // moonNode - control placement, and size of the moon.  It is a child of the earth's *POS* node.
     double moonRotationAngle = (DayOfYear*12.0 / 365.0)*PI2;
-    MoonMatrix.Mult_glRotate(moonRotationAngle, 0.0, 1.0, 0.0);  // Revolving around the earth twelve times per year
-	MoonMatrix.Mult_glTranslate(0.0, 0.0, 2.0);	    // Place the Moon one unit away from the earth
-    MoonMatrix.Mult_glScale(0.4);                   // Moon has radius 0.2
-    MoonMatrix.DumpByColumns(matEntries);
-	glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-	glVertexAttrib3f(vertColor_loc, 0.9f, 0.9f, 0.9f);     // Make the moon bright gray
-	Moon1.Render();
-
-    LinearMapR4 SDPosMatrix = EarthPosMatrix;
+    local.Set_glRotate(moonRotationAngle, 0.0, 1.0, 0.0);  // Revolving around the earth twelve times per year
+    local.Mult_glTranslate(0.0, 0.0, 2.0);          // Place the Moon two units away from the earth
+    local.Mult_glScale(0.4);                        // Moon has radius 0.4
+    solarScene.SetLocal(moonNode, local);
+
     double SDangle = (33.0 / 180.0) * PI;     //33 degreee in radian     //need discussion
-    SDPosMatrix.Mult_glRotate(earthRotationAngle, 0.0, 1.0, 0.0);
-    SDPosMatrix.Mult_glTranslate(0.0, 0.7 * sin(SDangle), 0.7); 
-    SDPosMatrix.Mult_glScale(0.05);
-    SDPosMatrix.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    local.Set_glRotate(earthRotationAngle, 0.0, 1.0, 0.0);
+    local.Mult_glTranslate(0.0, 0.7 * sin(SDangle), 0.7);
+    local.Mult_glScale(0.05);
+    solarScene.SetLocal(sdNode, local);
+
+    double planetXRotateAngle = -(PlanetXYear / 500) * PI2;
+    local.Set_glRotate(planetXRotateAngle, 0.0, 1.0, 0.0);
+    local.Mult_glTranslate(0.0, 0.0, 8.0);
+    solarScene.SetLocal(planetXNode, local);
+
+    double subMoonRotateAngle = (DayOfYear * 36 / 365) * PI2;
+    local.Set_glRotate(subMoonRotateAngle, 0.0, 1.0, 0.0);
+    local.Mult_glTranslate(0.0, 0.0, 2.5);
+    local.Mult_glScale(0.3);
+    solarScene.SetLocal(subMoonNode, local);
+
+    solarScene.Update();
+
+    // Render the objects, loading each one's ModelView matrix into the shader
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, solarScene.GetWorldFloats(sun1Node));
+    glVertexAttrib3f(vertColor_loc, 1.0f, 1.0f, 0.0f);     // Make the sun yellow
+    Sun.Render();
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, solarScene.GetWorldFloats(sun2Node));
+    Sun.Render();
+
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, solarScene.GetWorldFloats(earthNode));
+    glVertexAttrib3f(vertColor_loc, 0.2f, 0.4f, 1.0f);     // Make the earth bright cyan-blue
+    Earth.Render();
+
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, solarScene.GetWorldFloats(moonNode));
+    glVertexAttrib3f(vertColor_loc, 0.9f, 0.9f, 0.9f);     // Make the moon bright gray
+    Moon1.Render();
+
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, solarScene.GetWorldFloats(sdNode));
     glVertexAttrib3f(vertColor_loc, 1.0f, 1.0f, 0.0f);     // Make SD yellow
     Moon1.Render();
-    
 
-    LinearMapR4 PlanetXPosMatrix = viewMatrix;
-    double planetXRotateAngle = -(PlanetXYear / 500) * PI2;
-    PlanetXPosMatrix.Mult_glRotate(planetXRotateAngle, 0.0, 1.0, 0.0);
-    PlanetXPosMatrix.Mult_glTranslate(0.0, 0.0, 8.0);
-    PlanetXPosMatrix.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, solarScene.GetWorldFloats(planetXNode));
     glVertexAttrib3f(vertColor_loc, 0.9f, 0.0f, 0.9f);     // Make planetX magnetta
     PlanetX.Render();
 
-    LinearMapR4 SubMoonPosMatrix = MoonMatrix;
-    double subMoonRotateAngle = (DayOfYear * 36 / 365) * PI2;
-    SubMoonPosMatrix.Mult_glRotate(subMoonRotateAngle, 0.0, 1.0, 0.0);
-    SubMoonPosMatrix.Mult_glTranslate(0.0, 0.0, 2.5);
-    SubMoonPosMatrix.Mult_glScale(0.3);
-    SubMoonPosMatrix.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, solarScene.GetWorldFloats(subMoonNode));
     glVertexAttrib3f(vertColor_loc, 0.0f, 0.9f, 0.0f);     // Make the submoon green
     Moon1.Render();
 
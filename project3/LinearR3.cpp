@@ -150,22 +150,25 @@ Matrix3x3& Matrix3x3::ReNormalize()	// Re-normalizes nearly orthonormal matrix
 
 void Matrix3x3::OperatorTimesEquals(const Matrix3x3& B)	 // Matrix product
 {
+	// B is copied to locals first: B may be *this, as in A *= A.  This also lets
+	//   the compiler keep the entries in registers across the stores into *this.
+	double b11 = B.m11, b21 = B.m21, b31 = B.m31, b12 = B.m12, b22 = B.m22, b32 = B.m32, b13 = B.m13, b23 = B.m23, b33 = B.m33;
 	double t1, t2;		// temporary values
-	t1 =  m11*B.m11 + m12*B.m21 + m13*B.m31;
-	t2 =  m11*B.m12 + m12*B.m22 + m13*B.m32;
-	m13 = m11*B.m13 + m12*B.m23 + m13*B.m33;
+	t1 =  m11*b11 + m12*b21 + m13*b31;
+	t2 =  m11*b12 + m12*b22 + m13*b32;
+	m13 = m11*b13 + m12*b23 + m13*b33;
 	m11 = t1;
 	m12 = t2;
 
-	t1 =  m21*B.m11 + m22*B.m21 + m23*B.m31;
-	t2 =  m21*B.m12 + m22*B.m22 + m23*B.m32;
-	m23 = m21*B.m13 + m22*B.m23 + m23*B.m33;
+	t1 =  m21*b11 + m22*b21 + m23*b31;
+	t2 =  m21*b12 + m22*b22 + m23*b32;
+	m23 = m21*b13 + m22*b23 + m23*b33;
 	m21 = t1;
 	m22 = t2;
 
-	t1 =  m31*B.m11 + m32*B.m21 + m33*B.m31;
-	t2 =  m31*B.m12 + m32*B.m22 + m33*B.m32;
-	m33 = m31*B.m13 + m32*B.m23 + m33*B.m33;
+	t1 =  m31*b11 + m32*b21 + m33*b31;
+	t2 =  m31*b12 + m32*b22 + m33*b32;
+	m33 = m31*b13 + m32*b23 + m33*b33;
 	m31 = t1;
 	m32 = t2;
 	return;
@@ -174,22 +177,24 @@ void Matrix3x3::OperatorTimesEquals(const Matrix3x3& B)	 // Matrix product
 // Set  this = this * B^T
 void Matrix3x3::RightMultiplyByTranspose(const Matrix3x3& B)	 // Matrix product
 {
+	// Copied to locals, as in OperatorTimesEquals, so that B may be *this.
+	double b11 = B.m11, b21 = B.m21, b31 = B.m31, b12 = B.m12, b22 = B.m22, b32 = B.m32, b13 = B.m13, b23 = B.m23, b33 = B.m33;
 	double t1, t2;		// temporary values
-	t1 =  m11*B.m11 + m12*B.m12 + m13*B.m13;	// New m11 value
-	t2 =  m11*B.m21 + m12*B.m22 + m13*B.m23;	// New m12 value
-	m13 = m11*B.m31 + m12*B.m32 + m13*B.m33;	// New m13 value
+	t1 =  m11*b11 + m12*b12 + m13*b13;	// New m11 value
+	t2 =  m11*b21 + m12*b22 + m13*b23;	// New m12 value
+	m13 = m11*b31 + m12*b32 + m13*b33;	// New m13 value
 	m11 = t1;
 	m12 = t2;
 
-	t1 =  m21*B.m11 + m22*B.m12 + m23*B.m13;	// New m21 value
-	t2 =  m21*B.m21 + m22*B.m22 + m23*B.m23;	// New m22 value
-	m23 = m21*B.m31 + m22*B.m32 + m23*B.m33;	// New m23 value
+	t1 =  m21*b11 + m22*b12 + m23*b13;	// New m21 value
+	t2 =  m21*b21 + m22*b22 + m23*b23;	// New m22 value
+	m23 = m21*b31 + m22*b32 + m23*b33;	// New m23 value
 	m21 = t1;
 	m22 = t2;
 
-	t1 =  m31*B.m11 + m32*B.m12 + m33*B.m13;	// New m31 value
-	t2 =  m31*B.m21 + m32*B.m22 + m33*B.m23;	// New m32 value
-	m33 = m31*B.m31 + m32*B.m32 + m33*B.m33;	// New m33 value
+	t1 =  m31*b11 + m32*b12 + m33*b13;	// New m31 value
+	t2 =  m31*b21 + m32*b22 + m33*b23;	// New m32 value
+	m33 = m31*b31 + m32*b32 + m33*b33;	// New m33 value
 	m31 = t1;
 	m32 = t2;
 	return;
@@ -0,0 +1,289 @@
+/*
+ *
+ * MathMisc.cpp
+ *
+ * Fast single precision approximations of sin, cos, exp and atan2,
+ *   and sines and cosines of evenly spaced angles.  See MathMisc.h.
+ *
+ */
+
+#include "MathMisc.h"
+#include <string.h>
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// ******************************************************
+// * Constants for the approximations                   *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+namespace {
+    // sin and cos: x = q*(pi/2) + r, with |r| <= pi/4.  pi/2 is split into three parts
+    //    (Cody-Waite): q*PiHalves1 and q*PiHalves2 are exact for |q| < 2^12.
+    const float TwoOverPi = 0.636619772367581343f;
+    const float PiHalves1 = 1.5703125f;
+    const float PiHalves2 = 4.837512969970703125e-4f;
+    const float PiHalves3 = 7.54978995489188216e-8f;
+    // Minimax polynomials on [-pi/4, pi/4] (from the Cephes library)
+    const float SinC1 = -1.6666654611e-1f;
+    const float SinC2 = 8.3321608736e-3f;
+    const float SinC3 = -1.9515295891e-4f;
+    const float CosC1 = 4.166664568298827e-2f;
+    const float CosC2 = -1.388731625493765e-3f;
+    const float CosC3 = 2.443315711809948e-5f;
+
+    // exp: x = n*ln(2) + r, with |r| <= ln(2)/2.  ln(2) is split in two parts.
+    const float ExpMax = 88.3762626647949f;     // exp(ExpMax) < FLT_MAX, with n <= 127
+    const float ExpMin = -87.3365447505531f;    // exp(ExpMin) = FLT_MIN, with n >= -126
+    const float Log2E = 1.44269504088896341f;
+    const float Ln2Part1 = 0.693359375f;
+    const float Ln2Part2 = -2.12194440e-4f;
+    const float ExpC0 = 5.0000001201e-1f;
+    const float ExpC1 = 1.6666665459e-1f;
+    const float ExpC2 = 4.1665795894e-2f;
+    const float ExpC3 = 8.3334519073e-3f;
+    const float ExpC4 = 1.3981999507e-3f;
+    const float ExpC5 = 1.9875691500e-4f;
+
+    // atan: reduced to [0, tan(pi/8)] (from the Cephes library)
+    const float TanPiEighths = 0.414213562373095f;
+    const float AtanC1 = -3.33329491539e-1f;
+    const float AtanC2 = 1.99777106478e-1f;
+    const float AtanC3 = -1.38776856032e-1f;
+    const float AtanC4 = 8.05374449538e-2f;
+
+    // Rounds to the nearest integer.  With SSE2 this is one instruction, and rounds halves
+    //    to even, as the array versions do; floorf is a library call without SSE4.1.
+    inline int RoundToInt( float x )
+    {
+#ifdef USE_SSE2
+        return _mm_cvtss_si32( _mm_set_ss( x ) );
+#else
+        return (int)floorf( x + 0.5f );
+#endif
+    }
+
+    // Flips the sign of x if signBit is 0x80000000.  Used instead of branches on the quadrant,
+    //    which are unpredictable.
+    inline float XorSign( float x, unsigned int signBit )
+    {
+        unsigned int bits;
+        memcpy( &bits, &x, sizeof(float) );
+        bits ^= signBit;
+        memcpy( &x, &bits, sizeof(float) );
+        return x;
+    }
+}
+
+// ******************************************************
+// * Scalar versions                                    *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+void SinCosApprox( float x, float* sinx, float* cosx )
+{
+    int qi = RoundToInt( x*TwoOverPi );
+    float q = (float)qi;
+    float r = ((x - q*PiHalves1) - q*PiHalves2) - q*PiHalves3;
+    float z = r*r;
+    float s = ((SinC3*z + SinC2)*z + SinC1)*z*r + r;
+    float c = ((CosC3*z + CosC2)*z + CosC1)*z*z - 0.5f*z + 1.0f;
+    // Odd quadrants swap sin and cos.  sin is negated in quadrants 2 and 3, cos in 1 and 2.
+    bool swap = (qi & 1) != 0;
+    *sinx = XorSign( swap ? c : s, ((unsigned int)qi & 2) << 30 );
+    *cosx = XorSign( swap ? s : c, ((unsigned int)(qi + 1) & 2) << 30 );
+}
+
+float ExpApprox( float x )
+{
+    if ( x != x ) {
+        return x;                   // NaN
+    }
+    if ( x < ExpMin ) {
+        return 0.0f;
+    }
+    x = Min( x, ExpMax );
+    int ni = RoundToInt( x*Log2E );
+    float n = (float)ni;
+    float r = (x - n*Ln2Part1) - n*Ln2Part2;
+    float y = (((((ExpC5*r + ExpC4)*r + ExpC3)*r + ExpC2)*r + ExpC1)*r + ExpC0)*r*r + r + 1.0f;
+    int pow2Bits = (ni + 127) << 23;         // The float 2^n
+    float pow2;
+    memcpy( &pow2, &pow2Bits, sizeof(float) );
+    return y*pow2;
+}
+
+float Atan2Approx( float y, float x )
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float num = Min( ax, ay );
+    float den = Max( ax, ay );
+    float a = (den == 0.0f) ? 0.0f : num/den;     // In [0,1]
+    float base = 0.0f;
+    if ( a > TanPiEighths ) {
+        a = (a - 1.0f)/(a + 1.0f);
+        base = (float)PIfourths;
+    }
+    float z = a*a;
+    float r = (((AtanC4*z + AtanC3)*z + AtanC2)*z + AtanC1)*z*a + a + base;
+    if ( ay > ax ) {
+        r = (float)PIhalves - r;
+    }
+    if ( signbit(x) ) {                 // The sign bits, so signed zeros are handled as by atan2
+        r = (float)PI - r;
+    }
+    return signbit(y) ? -r : r;
+}
+
+// ******************************************************
+// * Array versions                                     *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+// The SSE2 code follows the scalar code line by line, four values at a time.
+//   The branches become masks; the quadrant's sign changes are done with XOR's
+//   of the sign bits.  The remaining (count mod 4) values use the scalar code.
+
+void SinCosApprox( const float* x, float* sinx, float* cosx, int count )
+{
+    int i = 0;
+#ifdef USE_SSE2
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    for ( ; i + 4 <= count; i += 4 ) {
+        __m128 xx = _mm_loadu_ps( x + i );
+        __m128i qi = _mm_cvtps_epi32( _mm_mul_ps( xx, _mm_set1_ps(TwoOverPi) ) );   // Rounds to nearest
+        __m128 q = _mm_cvtepi32_ps( qi );
+        __m128 r = _mm_sub_ps( xx, _mm_mul_ps( q, _mm_set1_ps(PiHalves1) ) );
+        r = _mm_sub_ps( r, _mm_mul_ps( q, _mm_set1_ps(PiHalves2) ) );
+        r = _mm_sub_ps( r, _mm_mul_ps( q, _mm_set1_ps(PiHalves3) ) );
+        __m128 z = _mm_mul_ps( r, r );
+        __m128 s = _mm_add_ps( _mm_mul_ps( _mm_set1_ps(SinC3), z ), _mm_set1_ps(SinC2) );
+        s = _mm_add_ps( _mm_mul_ps( s, z ), _mm_set1_ps(SinC1) );
+        s = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( s, z ), r ), r );
+        __m128 c = _mm_add_ps( _mm_mul_ps( _mm_set1_ps(CosC3), z ), _mm_set1_ps(CosC2) );
+        c = _mm_add_ps( _mm_mul_ps( c, z ), _mm_set1_ps(CosC1) );
+        c = _mm_mul_ps( _mm_mul_ps( c, z ), z );
+        c = _mm_add_ps( _mm_sub_ps( c, _mm_mul_ps( _mm_set1_ps(0.5f), z ) ), _mm_set1_ps(1.0f) );
+        // Odd quadrants swap sin and cos.  sin is negated in quadrants 2 and 3, cos in 1 and 2.
+        __m128 swap = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( qi, one ), one ) );
+        __m128 sinSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( qi, two ), 30 ) );
+        __m128 cosSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( _mm_add_epi32( qi, one ), two ), 30 ) );
+        __m128 sinVal = _mm_or_ps( _mm_and_ps( swap, c ), _mm_andnot_ps( swap, s ) );
+        __m128 cosVal = _mm_or_ps( _mm_and_ps( swap, s ), _mm_andnot_ps( swap, c ) );
+        _mm_storeu_ps( sinx + i, _mm_xor_ps( sinVal, sinSign ) );
+        _mm_storeu_ps( cosx + i, _mm_xor_ps( cosVal, cosSign ) );
+    }
+#endif
+    for ( ; i < count; i++ ) {
+        SinCosApprox( x[i], sinx + i, cosx + i );
+    }
+}
+
+void ExpApprox( const float* x, float* dest, int count )
+{
+    int i = 0;
+#ifdef USE_SSE2
+    for ( ; i + 4 <= count; i += 4 ) {
+        __m128 xx = _mm_loadu_ps( x + i );
+        __m128 isNaN = _mm_cmpunord_ps( xx, xx );
+        __m128 nanValues = _mm_and_ps( isNaN, xx );
+        __m128 tooSmall = _mm_cmplt_ps( xx, _mm_set1_ps(ExpMin) );
+        xx = _mm_min_ps( _mm_max_ps( xx, _mm_set1_ps(ExpMin) ), _mm_set1_ps(ExpMax) );
+        __m128i ni = _mm_cvtps_epi32( _mm_mul_ps( xx, _mm_set1_ps(Log2E) ) );
+        __m128 n = _mm_cvtepi32_ps( ni );
+        __m128 r = _mm_sub_ps( xx, _mm_mul_ps( n, _mm_set1_ps(Ln2Part1) ) );
+        r = _mm_sub_ps( r, _mm_mul_ps( n, _mm_set1_ps(Ln2Part2) ) );
+        __m128 y = _mm_add_ps( _mm_mul_ps( _mm_set1_ps(ExpC5), r ), _mm_set1_ps(ExpC4) );
+        y = _mm_add_ps( _mm_mul_ps( y, r ), _mm_set1_ps(ExpC3) );
+        y = _mm_add_ps( _mm_mul_ps( y, r ), _mm_set1_ps(ExpC2) );
+        y = _mm_add_ps( _mm_mul_ps( y, r ), _mm_set1_ps(ExpC1) );
+        y = _mm_add_ps( _mm_mul_ps( y, r ), _mm_set1_ps(ExpC0) );
+        y = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_mul_ps( y, r ), r ), r ), _mm_set1_ps(1.0f) );
+        __m128 pow2 = _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( ni, _mm_set1_epi32(127) ), 23 ) );
+        y = _mm_andnot_ps( _mm_or_ps( tooSmall, isNaN ), _mm_mul_ps( y, pow2 ) );
+        _mm_storeu_ps( dest + i, _mm_or_ps( y, nanValues ) );
+    }
+#endif
+    for ( ; i < count; i++ ) {
+        dest[i] = ExpApprox( x[i] );
+    }
+}
+
+void Atan2Approx( const float* y, const float* x, float* dest, int count )
+{
+    int i = 0;
+#ifdef USE_SSE2
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    for ( ; i + 4 <= count; i += 4 ) {
+        __m128 xx = _mm_loadu_ps( x + i );
+        __m128 yy = _mm_loadu_ps( y + i );
+        __m128 ax = _mm_andnot_ps( signBit, xx );
+        __m128 ay = _mm_andnot_ps( signBit, yy );
+        __m128 num = _mm_min_ps( ax, ay );
+        __m128 den = _mm_max_ps( ax, ay );
+        __m128 denZero = _mm_cmpeq_ps( den, zero );
+        __m128 a = _mm_andnot_ps( denZero, _mm_div_ps( num, _mm_or_ps( den, denZero ) ) );
+        __m128 big = _mm_cmpgt_ps( a, _mm_set1_ps(TanPiEighths) );
+        __m128 aBig = _mm_div_ps( _mm_sub_ps( a, _mm_set1_ps(1.0f) ), _mm_add_ps( a, _mm_set1_ps(1.0f) ) );
+        a = _mm_or_ps( _mm_and_ps( big, aBig ), _mm_andnot_ps( big, a ) );
+        __m128 base = _mm_and_ps( big, _mm_set1_ps((float)PIfourths) );
+        __m128 z = _mm_mul_ps( a, a );
+        __m128 r = _mm_add_ps( _mm_mul_ps( _mm_set1_ps(AtanC4), z ), _mm_set1_ps(AtanC3) );
+        r = _mm_add_ps( _mm_mul_ps( r, z ), _mm_set1_ps(AtanC2) );
+        r = _mm_add_ps( _mm_mul_ps( r, z ), _mm_set1_ps(AtanC1) );
+        r = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_mul_ps( r, z ), a ), a ), base );
+        __m128 steep = _mm_cmpgt_ps( ay, ax );
+        r = _mm_or_ps( _mm_and_ps( steep, _mm_sub_ps( _mm_set1_ps((float)PIhalves), r ) ), _mm_andnot_ps( steep, r ) );
+        __m128 xNeg = _mm_castsi128_ps( _mm_srai_epi32( _mm_castps_si128( xx ), 31 ) );   // All ones if the sign bit is set
+        r = _mm_or_ps( _mm_and_ps( xNeg, _mm_sub_ps( _mm_set1_ps((float)PI), r ) ), _mm_andnot_ps( xNeg, r ) );
+        _mm_storeu_ps( dest + i, _mm_xor_ps( r, _mm_and_ps( yy, signBit ) ) );
+    }
+#endif
+    for ( ; i < count; i++ ) {
+        dest[i] = Atan2Approx( y[i], x[i] );
+    }
+}
+
+// ******************************************************
+// * Evenly spaced angles                               *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+// (c,s) = (cos(theta), sin(theta)) is rotated by delta at each step:
+//     cos(theta+delta) = c*cos(delta) - s*sin(delta)
+//     sin(theta+delta) = s*cos(delta) + c*sin(delta)
+// Every 256 steps, the values are recalculated with sin and cos, so the error cannot build up.
+template<class T> static void SinCosSequenceT( double start, double delta, int count, T* sinx, T* cosx )
+{
+    double cosDelta = cos(delta);
+    double sinDelta = sin(delta);
+    double c = 0.0, s = 0.0;
+    for ( int i = 0; i < count; i++ ) {
+        if ( (i & 0xff) == 0 ) {
+            double theta = start + i*delta;
+            c = cos(theta);
+            s = sin(theta);
+        }
+        else {
+            double cNew = c*cosDelta - s*sinDelta;
+            s = s*cosDelta + c*sinDelta;
+            c = cNew;
+        }
+        if ( sinx ) {
+            sinx[i] = (T)s;
+        }
+        if ( cosx ) {
+            cosx[i] = (T)c;
+        }
+    }
+}
+
+void SinCosSequence( double start, double delta, int count, float* sinx, float* cosx )
+{
+    SinCosSequenceT( start, delta, count, sinx, cosx );
+}
+
+void SinCosSequence( double start, double delta, int count, double* sinx, double* cosx )
+{
+    SinCosSequenceT( start, delta, count, sinx, cosx );
+}
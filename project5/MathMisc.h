@@ -26,6 +26,15 @@
 #include <float.h>
 #include <assert.h>
 
+//
+// SIMD: USE_SSE2 is defined when the SSE2 intrinsics (<emmintrin.h>) can be used.
+//    This is always true for x64 builds, and for x86 builds with /arch:SSE2 or -msse2.
+//    Define NO_SSE2 to use only the plain C++ versions of routines.
+//
+#if !defined(NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define USE_SSE2 1
+#endif
+
 //
 // Commonly used constants
 //
@@ -451,6 +460,41 @@ inline double SafeAcos( double x ) {
 }
 
 
+// **********************************************************
+// Fast single precision approximations (in MathMisc.cpp)	*
+// **********************************************************
+
+// These use polynomial approximations, and the array versions compute four 
+//   values at a time with SSE2 (when USE_SSE2 is defined).  They are accurate enough
+//   for vertex data and animation.  The speed gain is in the array versions: the scalar
+//   versions are about as fast as the library functions, and ExpApprox is slower than expf.
+//   The maximum errors were measured against the double precision libm functions; the
+//   speeds are relative to a loop calling sinf and cosf, expf or atan2f (x64, gcc -O2,
+//   glibc; see BenchApprox.cpp).  Without SSE2, the array versions are no faster.
+// SinCosApprox:  absolute error at most 8.0e-8 for |x| <= 8192.  (Larger |x| lose accuracy.)
+//     Speed: array 7x, scalar 1.1x.
+// ExpApprox:  relative error at most 1.0e-7.  Returns 0 for x < -87.336 (no denormals),
+//     x > 88.376 is treated as 88.376 (giving 2.4e38, not infinity), and NaN returns NaN.
+//     Speed: array 2.5x, scalar 0.6x.
+// Atan2Approx:  absolute error at most 2.8e-7.  The result is in [-pi, pi].
+//     Signed zeros are handled as by atan2: e.g., Atan2Approx(0,0) is 0 and Atan2Approx(0,-1) is pi.
+//     Speed: array 15x, scalar 1.3x.
+void SinCosApprox( float x, float* sinx, float* cosx );
+float ExpApprox( float x );
+float Atan2Approx( float y, float x );
+// The same, for arrays of count values.  The destination arrays may equal the source arrays.
+void SinCosApprox( const float* x, float* sinx, float* cosx, int count );
+void ExpApprox( const float* x, float* dest, int count );
+void Atan2Approx( const float* y, const float* x, float* dest, int count );
+
+// Sines and cosines of evenly spaced angles, start + i*delta for 0 <= i < count,
+//   by repeated rotation: each step is a 2x2 rotation, with no call to sin or cos.
+//   The recurrence is done in double precision, and restarted every 256 steps, so the
+//   error is far below float precision.  Either of sinx or cosx may be null.
+void SinCosSequence( double start, double delta, int count, float* sinx, float* cosx );
+void SinCosSequence( double start, double delta, int count, double* sinx, double* cosx );
+
+
 // **********************************************************************
 // Roots and powers														*
 // **********************************************************************
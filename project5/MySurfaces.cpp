@@ -35,6 +35,12 @@ unsigned int myVBO[NumObjects];  // a Vertex Buffer Object holds an array of dat
 unsigned int myVAO[NumObjects];  // a Vertex Array Object - holds info about an array of vertex data;
 unsigned int myEBO[NumObjects];  // a Element Array Buffer Object - holds an array of elements (vertex indices)
 
+// The floor and the circular surface are loaded as triangle strips, each followed by
+//    the primitive restart index, so that each is drawn with a single glDrawElements.
+const unsigned int RestartIndex = 0xFFFFFFFF;
+int numFloorElements = 0;       // Number of elements in myEBO[iFloor], set by MyRemeshFloor
+int numCircularElements = 0;    // Number of elements in myEBO[iCircularSurf], set by MyRemeshCircularSurf
+
 // **********************
 // This sets up geometries needed for the "Initial" (the 3-D alphabet letter)
 //  It is called only once.
@@ -241,8 +247,9 @@ void MyRemeshFloor()
     // Floor vertices.
     int numFloorVerts = (meshRes + 1)*(meshRes + 1);
     float* floorVerts = new float[3 * numFloorVerts];
-    // Floor elements (indices to vertices in a triangle strip)
-    int numFloorElts = meshRes * 2 * (meshRes + 1);    
+    // Floor elements (indices to vertices in triangle strips, one strip per row,
+    //    each followed by the restart index)
+    int numFloorElts = meshRes * (2 * (meshRes + 1) + 1);
     unsigned int* floorElements = new unsigned int[numFloorElts];
 
     // YOU CAN NOW ACCESS floorVerts AND floorElements WITH THE SAME
@@ -259,13 +266,13 @@ void MyRemeshFloor()
         }
 
     }
-    for (int i = 0; i < numFloorElts; i++) {
-        if (i % 2 == 0) {
-            floorElements[i] = i / 2;
-        }
-        else {
-            floorElements[i] = i / 2 + meshRes + 1;
+    unsigned int* toElt = floorElements;
+    for (int i = 0; i < meshRes; i++) {
+        for (int j = 0; j < meshRes + 1; j++) {
+            *(toElt++) = i * (meshRes + 1) + j;
+            *(toElt++) = (i + 1) * (meshRes + 1) + j;
         }
+        *(toElt++) = RestartIndex;
     }
 
     
@@ -287,7 +294,8 @@ void MyRemeshFloor()
     glBindBuffer(GL_ARRAY_BUFFER, myVBO[iFloor]);
     glBufferData(GL_ARRAY_BUFFER, numFloorVerts * 3 * sizeof(float), floorVerts, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iFloor]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numFloorElts * 3 * sizeof(float), floorElements, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numFloorElts * sizeof(unsigned int), floorElements, GL_STATIC_DRAW);
+    numFloorElements = numFloorElts;
     // The array should have been copied into the GPU buffers now.
     // If you use "new" above, you MUST delete the arrays here to avoid a memory leak.
     delete[] floorVerts;
@@ -316,28 +324,52 @@ void MyRemeshCircularSurf()
   
     float rotation = PI2 / (float)meshRes;
     float dist =( 4.0f * PI) / (float)meshRes;
-    float r = 0;
+    // The sines and cosines of the slice angles, d*rotation, and of the ring radii, (i+1)*dist,
+    //    are evenly spaced, so they are tabulated once with SinCosSequence,
+    //    instead of calling sin and cos for every vertex.
+    double* sinSlice = new double[meshRes];
+    double* cosSlice = new double[meshRes];
+    double* sinRing = new double[meshRes];
+    double* cosRing = new double[meshRes];
+    SinCosSequence(0.0, rotation, meshRes, sinSlice, cosSlice);
+    SinCosSequence(dist, dist, meshRes, sinRing, cosRing);
+    // Each vertex is at distance r from the center, in the direction (cos, 0, -sin) of
+    //    the slice's angle, and at the given height.  The normal is (-slope*cos, 1, slope*sin).
+    float* vertPtr = circularVerts + 6;         // The first vertex is the center
     for (int d = 0; d < meshRes; d++) {
-        for (int i = 0; i < meshRes*6; i+=6) {
-            r = dist * (i/6+1);
-            circularVerts[d * meshRes * 6 + i + 6] =  r * (float)cos(d * rotation);
-            circularVerts[d * meshRes * 6 + i + 7] = (1 + 0.08 * (r * r)) * sin(r) / r;
-            circularVerts[d * meshRes * 6 + i + 8] = -r * (float)sin(d * rotation);
-            circularVerts[d * meshRes * 6 + i + 9] = -(0.16 * sin(r) + ((r * cos(r) - sin(r)) * (1 + 0.08 * r * r)) / r / r)* (float)cos(d * rotation);
-            circularVerts[d * meshRes * 6 + i + 10] = 1.0f;
-            circularVerts[d * meshRes * 6 + i + 11] = (0.16 * sin(r) + ((r * cos(r) - sin(r)) * (1 + 0.08 * r * r)) / r / r) * (float)sin(d * rotation);
+        for (int i = 0; i < meshRes; i++) {
+            double r = dist * (i + 1.0);    // In double, matching the radii in sinRing and cosRing
+            double sinR = sinRing[i];
+            double cosR = cosRing[i];
+            double height = (1 + 0.08 * (r * r)) * sinR / r;
+            double slope = 0.16 * sinR + ((r * cosR - sinR) * (1 + 0.08 * r * r)) / r / r;
+            vertPtr[0] = (float)(r * cosSlice[d]);
+            vertPtr[1] = (float)height;
+            vertPtr[2] = (float)(-r * sinSlice[d]);
+            vertPtr[3] = (float)(-slope * cosSlice[d]);
+            vertPtr[4] = 1.0f;
+            vertPtr[5] = (float)(slope * sinSlice[d]);
+            vertPtr += 6;
         }
     }
-
-    int numCircularElms = meshRes * (2 * meshRes + 1);
-    unsigned int* circularElements = new  unsigned int[3 * numCircularElms];
+    delete[] sinSlice;
+    delete[] cosSlice;
+    delete[] sinRing;
+    delete[] cosRing;
+
+    // One triangle strip per slice, starting at the center, each followed by the restart index.
+    int stripLen = 2 * meshRes + 1;
+    int numCircularElms = meshRes * (stripLen + 1);
+    unsigned int* circularElements = new  unsigned int[numCircularElms];
     int row, col;
     for (int i = 0; i < numCircularElms; i++) {
-        if (i % (meshRes*2+1)==0) {
+        row = i / (stripLen + 1);
+        col = i % (stripLen + 1);
+        if (col == stripLen) {
+            circularElements[i] = RestartIndex;
+        }else if (col == 0) {
             circularElements[i] = 0;
         }else{
-            row = i / (meshRes * 2 + 1);
-            col = i % (meshRes * 2 + 1);
             if (col % 2 == 1) {
                 circularElements[i] = (col+1)/2 + row * meshRes;
             }
@@ -365,7 +397,8 @@ void MyRemeshCircularSurf()
     glBindBuffer(GL_ARRAY_BUFFER, myVBO[iCircularSurf]);
     glBufferData(GL_ARRAY_BUFFER, numCircularVerts*sizeof(float)*3, circularVerts, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iCircularSurf]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numCircularElms*sizeof(float)*3, circularElements, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numCircularElms*sizeof(unsigned int), circularElements, GL_STATIC_DRAW);
+    numCircularElements = numCircularElms;
 
     delete[] circularVerts;
     delete[] circularElements;
@@ -373,7 +406,7 @@ void MyRemeshCircularSurf()
 
 // ****
 // MyRenderFloor: To be written for Project 4. Renders the square ground plane.
-//    This will loop, giving glDrawElements(...) commands. (Compare to RenderFloorDemo above.)
+//    The strips are drawn with one glDrawElements(...) command. (Compare to RenderFloorDemo above.)
 // ****
 void MyRenderFloor()
 {
@@ -385,16 +418,18 @@ void MyRenderFloor()
     viewMatrix.DumpByColumns(matEntries);
     glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
 
-    for (int i = 0; i < meshRes; i++) {
-        glDrawElements(GL_TRIANGLE_STRIP, 2*(meshRes+1), GL_UNSIGNED_INT, (void*)(i*2*(meshRes+1)*sizeof(unsigned int)));                              
-    }
+    // All the strips are drawn at once: the restart index separates them.
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(RestartIndex);
+    glDrawElements(GL_TRIANGLE_STRIP, numFloorElements, GL_UNSIGNED_INT, (void*)0);
+    glDisable(GL_PRIMITIVE_RESTART);
     
  
 }
 
 // ****
 // MyRenderCircularSurf: To be written for Project 4. Renders the circular surface.
-//    This will loop, giving glDrawElements(...) commands. (Compare to RenderCircularDemo above.)
+//    The strips are drawn with one glDrawElements(...) command. (Compare to RenderCircularDemo above.)
 // ****
 void MyRenderCircularSurf()
 {
@@ -411,8 +446,10 @@ void MyRenderCircularSurf()
     matDemo.DumpByColumns(matEntries);
     glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
 
-    for (int i = 0; i < meshRes; i++) {
-        glDrawElements(GL_TRIANGLE_STRIP, meshRes*2+1, GL_UNSIGNED_INT, (void*)((i*(meshRes*2+1))*sizeof(unsigned int)));
-    }
+    // All the strips are drawn at once: the restart index separates them.
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(RestartIndex);
+    glDrawElements(GL_TRIANGLE_STRIP, numCircularElements, GL_UNSIGNED_INT, (void*)0);
+    glDisable(GL_PRIMITIVE_RESTART);
 }
 